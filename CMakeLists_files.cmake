@@ -66,6 +66,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoildispersionmodule.hh
              opm/models/blackoil/blackoilextensivequantities.hh
              opm/models/blackoil/blackoilintensivequantities.hh
+             opm/models/blackoil/blackoilintensivequantitymirror.hh
              opm/models/blackoil/blackoildarcyfluxmodule.hh
              opm/models/blackoil/blackoilratevector.hh
              opm/models/blackoil/blackoilbrinemodules.hh
@@ -140,6 +141,8 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseproblem.hh
              opm/models/discretization/common/fvbaseprimaryvariables.hh
              opm/models/discretization/common/linearizationtype.hh
+             opm/models/discretization/common/dofordering.hh
+             opm/models/discretization/common/reorderedelementmapper.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
@@ -170,6 +173,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/io/restart.hh
              opm/models/io/cubegridvanguard.hh
              opm/models/io/baseoutputwriter.hh
+             opm/models/io/vtkbinarywriter.hh
              opm/models/io/vtkmultiwriter.hh
              opm/models/io/vtkmultiphasemodule.hh
              opm/models/io/vtkdiscretefracturemodule.hh
@@ -242,6 +246,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/utils/timer.hh
              opm/models/utils/signum.hh
              opm/models/utils/genericguard.hh
+             opm/models/utils/instrumentation.hh
              opm/models/utils/basicparameters.hh
              opm/models/utils/basicproperties.hh
              opm/simulators/linalg/ilufirstelement.hh
@@ -251,6 +256,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/linalgproperties.hh
              opm/simulators/linalg/linearsolverreport.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
+             opm/simulators/linalg/sparsitypattern.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
@@ -266,6 +272,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/globalindices.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
+             opm/simulators/linalg/mixedprecisionpreconditioner.hh
              opm/simulators/linalg/istlsolverwrappers.hh
              opm/simulators/linalg/overlaptypes.hh
              opm/simulators/linalg/overlappingpreconditioner.hh
@@ -12,7 +12,7 @@ usage() {
     echo "Usage:"
     echo
     echo "runTest.sh TEST_TYPE -e binary -- [TEST_ARGS]"
-    echo "where TEST_TYPE can either be --plain, --simulation, --spe1 or --parallel-simulation=\$NUM_CORES (is '$TEST_TYPE')."
+    echo "where TEST_TYPE can either be --plain, --simulation, --spe1, --vcfv-geometry-cache or --parallel-simulation=\$NUM_CORES (is '$TEST_TYPE')."
 };
 
 # this function clips the help message printed by an ewoms simulation
@@ -188,6 +188,38 @@ case "$TEST_TYPE" in
         exit 0
         ;;
 
+    "--vcfv-geometry-cache")
+        # run the simulation with and without caching the stencil geometry of the
+        # vertex centered finite volume discretization. the results must be identical.
+        for CACHE in false true; do
+            OUTPUT_DIR="geometry-cache-$CACHE-$RND"
+            mkdir -p "$OUTPUT_DIR"
+            echo "executing \"$TEST_BINARY $TEST_ARGS --enable-vcfv-geometry-cache=$CACHE --output-dir=$OUTPUT_DIR\""
+            if ! "$TEST_BINARY" $TEST_ARGS --enable-vcfv-geometry-cache="$CACHE" --output-dir="$OUTPUT_DIR"; then
+                echo "Executing the binary failed!"
+                rm -rf "geometry-cache-false-$RND" "geometry-cache-true-$RND"
+                exit 1
+            fi
+        done
+
+        RET=0
+        NUM_FILES=0
+        for FILE in "geometry-cache-false-$RND"/*.vtu; do
+            NUM_FILES=$(( NUM_FILES + 1 ))
+            if ! cmp -s "$FILE" "geometry-cache-true-$RND/$(basename "$FILE")"; then
+                echo "The results for $(basename "$FILE") differ if the geometry cache is used"
+                RET=1
+            fi
+        done
+        rm -rf "geometry-cache-false-$RND" "geometry-cache-true-$RND"
+
+        if test "$NUM_FILES" = "0"; then
+            echo "The simulation did not produce any VTU files"
+            exit 1
+        fi
+        exit $RET
+        ;;
+
     "--restart")
         echo "executing \"$TEST_BINARY $TEST_ARGS\""
         "$TEST_BINARY" $TEST_ARGS | tee "test-$RND.log"
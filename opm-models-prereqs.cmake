@@ -15,6 +15,7 @@ set (opm-models_CONFIG_VAR
   HAVE_ECL_INPUT
   HAVE_ECL_OUTPUT
   HAVE_OPM_GRID
+  HAVE_ZLIB
   DUNE_AVOID_CAPABILITIES_IS_PARALLEL_DEPRECATION_WARNING
   )
 
@@ -37,6 +38,8 @@ set (opm-models_DEPS
   "Valgrind"
   # quadruple precision floating point calculations
   "QuadMath"
+  # compressed binary VTK output
+  "ZLIB"
   )
 
 find_package_deps(opm-models)
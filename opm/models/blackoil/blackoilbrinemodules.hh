@@ -270,15 +270,32 @@ public:
             const unsigned inIdx = extQuants.interiorIndex();
             const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
 
-            if (upIdx == inIdx) {
+            computeFlux(flux, up, upIdx == inIdx, extQuants.volumeFlux(waterPhaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Compute the salt flux over a face from the intensive quantities of the
+     *        upstream DOF of the water phase and the water volume flux.
+     *
+     * If the upstream DOF is not the interior one, only the derivatives of the volume
+     * flux are considered.
+     */
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior,
+                            [[maybe_unused]] const Evaluation& waterVolumeFlux)
+    {
+        if constexpr (enableBrine) {
+            if (upIsInterior) {
                 flux[contiBrineEqIdx] =
-                        extQuants.volumeFlux(waterPhaseIdx)
+                        waterVolumeFlux
                         *up.fluidState().invB(waterPhaseIdx)
                         *up.fluidState().saltConcentration();
             }
             else {
                 flux[contiBrineEqIdx] =
-                        extQuants.volumeFlux(waterPhaseIdx)
+                        waterVolumeFlux
                         *decay<Scalar>(up.fluidState().invB(waterPhaseIdx))
                         *decay<Scalar>(up.fluidState().saltConcentration());
             }
@@ -359,39 +359,66 @@ public:
     {
         if constexpr (enableExtbo) {
             const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
+            const unsigned inIdx = extQuants.interiorIndex();
+
+            const unsigned upIdxGas = static_cast<unsigned>(extQuants.upstreamIndex(gasPhaseIdx));
+            // the oil phase only matters if gas can be dissolved in it
+            const unsigned upIdxOil = FluidSystem::enableDissolvedGas()
+                ? static_cast<unsigned>(extQuants.upstreamIndex(oilPhaseIdx))
+                : upIdxGas;
+            computeFlux(flux,
+                        elemCtx.intensiveQuantities(upIdxGas, timeIdx),
+                        upIdxGas == inIdx,
+                        extQuants.volumeFlux(gasPhaseIdx),
+                        elemCtx.intensiveQuantities(upIdxOil, timeIdx),
+                        upIdxOil == inIdx,
+                        extQuants.volumeFlux(oilPhaseIdx));
+        }
+    }
 
+    /*!
+     * \brief Compute the flux of the extended component over a face from the
+     *        intensive quantities of the upstream DOFs of the gas and oil phases and
+     *        the volume fluxes of these phases.
+     *
+     * If an upstream DOF is not the interior one, only the derivatives of the
+     * respective volume flux are considered.
+     */
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const IntensiveQuantities& upGas,
+                            [[maybe_unused]] bool gasUpIsInterior,
+                            [[maybe_unused]] const Evaluation& gasVolumeFlux,
+                            [[maybe_unused]] const IntensiveQuantities& upOil,
+                            [[maybe_unused]] bool oilUpIsInterior,
+                            [[maybe_unused]] const Evaluation& oilVolumeFlux)
+    {
+        if constexpr (enableExtbo) {
             if constexpr (blackoilConserveSurfaceVolume) {
-                unsigned inIdx = extQuants.interiorIndex();
-
-                unsigned upIdxGas = static_cast<unsigned>(extQuants.upstreamIndex(gasPhaseIdx));
-                const auto& upGas = elemCtx.intensiveQuantities(upIdxGas, timeIdx);
                 const auto& fsGas = upGas.fluidState();
-                if (upIdxGas == inIdx) {
+                if (gasUpIsInterior) {
                     flux[contiZfracEqIdx] =
-                        extQuants.volumeFlux(gasPhaseIdx)
+                        gasVolumeFlux
                         * (upGas.yVolume())
                         * fsGas.invB(gasPhaseIdx);
                 }
                 else {
                     flux[contiZfracEqIdx] =
-                            extQuants.volumeFlux(gasPhaseIdx)
+                            gasVolumeFlux
                             * (decay<Scalar>(upGas.yVolume()))
                             * decay<Scalar>(fsGas.invB(gasPhaseIdx));
                 }
                 if (FluidSystem::enableDissolvedGas()) { // account for dissolved z in oil phase
-                    unsigned upIdxOil = static_cast<unsigned>(extQuants.upstreamIndex(oilPhaseIdx));
-                    const auto& upOil = elemCtx.intensiveQuantities(upIdxOil, timeIdx);
                     const auto& fsOil = upOil.fluidState();
-                    if (upIdxOil == inIdx) {
+                    if (oilUpIsInterior) {
                         flux[contiZfracEqIdx] +=
-                            extQuants.volumeFlux(oilPhaseIdx)
+                            oilVolumeFlux
                             * upOil.xVolume()
                             * fsOil.Rs()
                             * fsOil.invB(oilPhaseIdx);
                     }
                     else {
                         flux[contiZfracEqIdx] +=
-                            extQuants.volumeFlux(oilPhaseIdx)
+                            oilVolumeFlux
                             * decay<Scalar>(upOil.xVolume())
                             * decay<Scalar>(fsOil.Rs())
                             * decay<Scalar>(fsOil.invB(oilPhaseIdx));
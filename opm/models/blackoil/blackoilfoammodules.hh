@@ -294,37 +294,76 @@ public:
             const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
             const unsigned inIdx = extQuants.interiorIndex();
 
+            switch (transportPhase()) {
+                case Phase::WATER: {
+                    const unsigned upIdx = extQuants.upstreamIndex(waterPhaseIdx);
+                    const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+                    computeFlux(flux, up, upIdx == inIdx, extQuants.volumeFlux(waterPhaseIdx));
+                    break;
+                }
+                case Phase::GAS: {
+                    const unsigned upIdx = extQuants.upstreamIndex(gasPhaseIdx);
+                    const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+                    computeFlux(flux, up, upIdx == inIdx, extQuants.volumeFlux(gasPhaseIdx));
+                    break;
+                }
+                case Phase::SOLVENT: {
+                    if constexpr (enableSolvent) {
+                        const unsigned upIdx = extQuants.solventUpstreamIndex();
+                        const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+                        computeFlux(flux, up, upIdx == inIdx, extQuants.solventVolumeFlux());
+                    } else {
+                        throw std::runtime_error("Foam transport phase is SOLVENT but SOLVENT is not activated.");
+                    }
+                    break;
+                }
+                default: {
+                    throw std::runtime_error("Foam transport phase must be GAS/WATER/SOLVENT.");
+                }
+            }
+        }
+    }
+
+    /*!
+     * \brief Compute the foam flux over a face from the intensive quantities of the
+     *        upstream DOF of the transport phase and the volume flux of this phase.
+     *
+     * If the upstream DOF is not the interior one, only the derivatives of the volume
+     * flux are considered.
+     */
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior,
+                            [[maybe_unused]] const Evaluation& volumeFlux)
+    {
+        if constexpr (enableFoam) {
             // The effect of the mobility reduction factor is
             // incorporated in the mobility for the relevant phase,
             // so fluxes do not need modification here.
             switch (transportPhase()) {
                 case Phase::WATER: {
-                    const unsigned upIdx = extQuants.upstreamIndex(waterPhaseIdx);
-                    const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
-                    if (upIdx == inIdx) {
+                    if (upIsInterior) {
                         flux[contiFoamEqIdx] =
-                            extQuants.volumeFlux(waterPhaseIdx)
+                            volumeFlux
                             *up.fluidState().invB(waterPhaseIdx)
                             *up.foamConcentration();
                     } else {
                         flux[contiFoamEqIdx] =
-                            extQuants.volumeFlux(waterPhaseIdx)
+                            volumeFlux
                             *decay<Scalar>(up.fluidState().invB(waterPhaseIdx))
                             *decay<Scalar>(up.foamConcentration());
                     }
                     break;
                 }
                 case Phase::GAS: {
-                    const unsigned upIdx = extQuants.upstreamIndex(gasPhaseIdx);
-                    const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
-                    if (upIdx == inIdx) {
+                    if (upIsInterior) {
                         flux[contiFoamEqIdx] =
-                            extQuants.volumeFlux(gasPhaseIdx)
+                            volumeFlux
                             *up.fluidState().invB(gasPhaseIdx)
                             *up.foamConcentration();
                     } else {
                         flux[contiFoamEqIdx] =
-                            extQuants.volumeFlux(gasPhaseIdx)
+                            volumeFlux
                             *decay<Scalar>(up.fluidState().invB(gasPhaseIdx))
                             *decay<Scalar>(up.foamConcentration());
                     }
@@ -332,16 +371,14 @@ public:
                 }
                 case Phase::SOLVENT: {
                     if constexpr (enableSolvent) {
-                        const unsigned upIdx = extQuants.solventUpstreamIndex();
-                        const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
-                        if (upIdx == inIdx) {
+                        if (upIsInterior) {
                             flux[contiFoamEqIdx] =
-                                extQuants.solventVolumeFlux()
+                                volumeFlux
                                 *up.solventInverseFormationVolumeFactor()
                                 *up.foamConcentration();
                         } else {
                             flux[contiFoamEqIdx] =
-                                extQuants.solventVolumeFlux()
+                                volumeFlux
                                 *decay<Scalar>(up.solventInverseFormationVolumeFactor())
                                 *decay<Scalar>(up.foamConcentration());
                         }
@@ -0,0 +1,241 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilIntensiveQuantityMirror
+ */
+#ifndef EWOMS_BLACK_OIL_INTENSIVE_QUANTITY_MIRROR_HH
+#define EWOMS_BLACK_OIL_INTENSIVE_QUANTITY_MIRROR_HH
+
+#include "blackoilproperties.hh"
+
+#include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief A compact structure-of-arrays copy of the intensive quantities which are
+ *        needed to compute the advective fluxes of the TPFA discretization.
+ *
+ * The full intensive quantities of the black-oil model are large objects, so
+ * reading the few values required by the flux of a face from them touches much more
+ * memory than necessary. This class stores the phase pressures, densities,
+ * mobilities and inverse formation volume factors, the transmissibility multiplier
+ * due to rock compressibility, the PVT region index and the enabled dissolution and
+ * vaporization factors of all degrees of freedom in separate contiguous arrays.
+ *
+ * Directional mobilities are not mirrored. If they are used, the mirror reports this
+ * via hasDirectionalMobilities() and the flux must be computed from the full
+ * intensive quantities.
+ */
+template <class TypeTag>
+class BlackOilIntensiveQuantityMirror
+{
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using FluidState = typename IntensiveQuantities::FluidState;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+
+public:
+    /*!
+     * \brief Provides the dissolution and vaporization factors of a mirrored degree of
+     *        freedom with the interface of a fluid state.
+     *
+     * Only the factors which are enabled by the fluid system may be accessed.
+     */
+    class DissolutionFactors
+    {
+    public:
+        DissolutionFactors(const BlackOilIntensiveQuantityMirror& mirror, unsigned globalIdx)
+            : mirror_(mirror)
+            , globalIdx_(globalIdx)
+        {}
+
+        const Evaluation& Rs() const
+        { return mirror_.Rs_[globalIdx_]; }
+
+        const Evaluation& Rsw() const
+        { return mirror_.Rsw_[globalIdx_]; }
+
+        const Evaluation& Rv() const
+        { return mirror_.Rv_[globalIdx_]; }
+
+        const Evaluation& Rvw() const
+        { return mirror_.Rvw_[globalIdx_]; }
+
+    private:
+        const BlackOilIntensiveQuantityMirror& mirror_;
+        unsigned globalIdx_;
+    };
+
+    BlackOilIntensiveQuantityMirror()
+        : hasDirectionalMobilities_(false)
+    {}
+
+    /*!
+     * \brief Allocate the arrays for a given number of degrees of freedom.
+     */
+    void resize(std::size_t numDof)
+    {
+        pressure_.resize(numDof*numPhases);
+        density_.resize(numDof*numPhases);
+        mobility_.resize(numDof*numPhases);
+        invB_.resize(numDof*numPhases);
+        rockCompTransMultiplier_.resize(numDof);
+        pvtRegionIdx_.resize(numDof);
+
+        // only allocate the factors which are used
+        Rs_.resize(FluidSystem::enableDissolvedGas() ? numDof : 0);
+        Rsw_.resize(FluidSystem::enableDissolvedGasInWater() ? numDof : 0);
+        Rv_.resize(FluidSystem::enableVaporizedOil() ? numDof : 0);
+        Rvw_.resize(FluidSystem::enableVaporizedWater() ? numDof : 0);
+    }
+
+    /*!
+     * \brief Prepare the mirror before the quantities of all degrees of freedom are
+     *        updated.
+     *
+     * This allocates the arrays if needed and forgets whether directional
+     * mobilities were used previously.
+     */
+    void prepare(std::size_t numDof)
+    {
+        if (size() != numDof)
+            resize(numDof);
+
+        hasDirectionalMobilities_.store(false, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Returns the number of degrees of freedom which are mirrored.
+     */
+    std::size_t size() const
+    { return rockCompTransMultiplier_.size(); }
+
+    /*!
+     * \brief Copy the relevant quantities of a degree of freedom.
+     *
+     * This method may be called concurrently for different degrees of freedom.
+     */
+    void update(unsigned globalIdx, const IntensiveQuantities& intQuants)
+    {
+        const auto& fs = intQuants.fluidState();
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            const std::size_t idx = index_(globalIdx, phaseIdx);
+            pressure_[idx] = fs.pressure(phaseIdx);
+            density_[idx] = fs.density(phaseIdx);
+            mobility_[idx] = intQuants.mobility(phaseIdx);
+            invB_[idx] = fs.invB(phaseIdx);
+
+            // directional mobilities are stored in a separate object by the intensive
+            // quantities, i.e., the references differ if they are used
+            if (&intQuants.mobility(phaseIdx, FaceDir::XPlus) != &intQuants.mobility(phaseIdx))
+                hasDirectionalMobilities_.store(true, std::memory_order_relaxed);
+        }
+        rockCompTransMultiplier_[globalIdx] = intQuants.rockCompTransMultiplier();
+
+        const unsigned pvtRegionIdx = intQuants.pvtRegionIndex();
+        pvtRegionIdx_[globalIdx] = static_cast<unsigned short>(pvtRegionIdx);
+        if (FluidSystem::enableDissolvedGas())
+            Rs_[globalIdx] = BlackOil::getRs_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+        if (FluidSystem::enableDissolvedGasInWater())
+            Rsw_[globalIdx] = BlackOil::getRsw_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+        if (FluidSystem::enableVaporizedOil())
+            Rv_[globalIdx] = BlackOil::getRv_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+        if (FluidSystem::enableVaporizedWater())
+            Rvw_[globalIdx] = BlackOil::getRvw_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+    }
+
+    /*!
+     * \brief Returns true if any of the mirrored degrees of freedom uses directional
+     *        mobilities.
+     */
+    bool hasDirectionalMobilities() const
+    { return hasDirectionalMobilities_.load(std::memory_order_relaxed); }
+
+    const Evaluation& pressure(unsigned globalIdx, unsigned phaseIdx) const
+    { return pressure_[index_(globalIdx, phaseIdx)]; }
+
+    const Evaluation& density(unsigned globalIdx, unsigned phaseIdx) const
+    { return density_[index_(globalIdx, phaseIdx)]; }
+
+    const Evaluation& mobility(unsigned globalIdx, unsigned phaseIdx) const
+    { return mobility_[index_(globalIdx, phaseIdx)]; }
+
+    const Evaluation& invB(unsigned globalIdx, unsigned phaseIdx) const
+    { return invB_[index_(globalIdx, phaseIdx)]; }
+
+    const Evaluation& rockCompTransMultiplier(unsigned globalIdx) const
+    { return rockCompTransMultiplier_[globalIdx]; }
+
+    unsigned pvtRegionIndex(unsigned globalIdx) const
+    { return pvtRegionIdx_[globalIdx]; }
+
+    DissolutionFactors dissolutionFactors(unsigned globalIdx) const
+    { return DissolutionFactors(*this, globalIdx); }
+
+    /*!
+     * \brief Returns the number of bytes occupied by the mirrored quantities.
+     */
+    std::size_t memoryUsage() const
+    {
+        return
+            (4*numPhases + 1)*size()*sizeof(Evaluation)
+            + (Rs_.size() + Rsw_.size() + Rv_.size() + Rvw_.size())*sizeof(Evaluation)
+            + pvtRegionIdx_.size()*sizeof(unsigned short);
+    }
+
+private:
+    static std::size_t index_(unsigned globalIdx, unsigned phaseIdx)
+    { return static_cast<std::size_t>(globalIdx)*numPhases + phaseIdx; }
+
+    std::vector<Evaluation> pressure_;
+    std::vector<Evaluation> density_;
+    std::vector<Evaluation> mobility_;
+    std::vector<Evaluation> invB_;
+    std::vector<Evaluation> rockCompTransMultiplier_;
+    std::vector<Evaluation> Rs_;
+    std::vector<Evaluation> Rsw_;
+    std::vector<Evaluation> Rv_;
+    std::vector<Evaluation> Rvw_;
+    std::vector<unsigned short> pvtRegionIdx_;
+
+    std::atomic<bool> hasDirectionalMobilities_;
+};
+
+} // namespace Opm
+
+#endif
@@ -38,6 +38,7 @@
 #include "blackoildiffusionmodule.hh"
 #include "blackoildispersionmodule.hh"
 #include "blackoilmicpmodules.hh"
+#include "blackoilintensivequantitymirror.hh"
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
@@ -63,6 +64,8 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Problem = GetPropType<TypeTag, Properties::Problem>;
     using FluidState = typename IntensiveQuantities::FluidState;
+    using IntensiveQuantityMirror = BlackOilIntensiveQuantityMirror<TypeTag>;
+    using DissolutionFactors = typename IntensiveQuantityMirror::DissolutionFactors;
 
     enum { conti0EqIdx = Indices::conti0EqIdx };
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
@@ -123,6 +126,7 @@ public:
         double outAlpha;
         double diffusivity;
         double dispersivity;
+        double dist;
     };
     /*!
      * \copydoc FvBaseLocalResidual::computeStorage
@@ -242,6 +246,40 @@ public:
                          nbInfo);
     }
 
+    /*!
+     * \brief Compute the flux like the method above, but read the phase pressures,
+     *        densities, mobilities and inverse formation volume factors from a compact
+     *        copy of the intensive quantities.
+     *
+     * If the mirror is not available or it cannot represent the mobilities, the full
+     * intensive quantities are used.
+     */
+    static void computeFlux(RateVector& flux,
+                            RateVector& darcy,
+                            const unsigned globalIndexIn,
+                            const unsigned globalIndexEx,
+                            const IntensiveQuantities& intQuantsIn,
+                            const IntensiveQuantities& intQuantsEx,
+                            const ResidualNBInfo& nbInfo,
+                            const IntensiveQuantityMirror* mirror)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFlux);
+        flux = 0.0;
+        darcy = 0.0;
+
+        if (mirror && mirror->hasDirectionalMobilities())
+            mirror = nullptr;
+
+        calculateFluxes_(flux,
+                         darcy,
+                         intQuantsIn,
+                         intQuantsEx,
+                         globalIndexIn,
+                         globalIndexEx,
+                         nbInfo,
+                         mirror);
+    }
+
     // This function demonstrates compatibility with the ElementContext-based interface.
     // Actually using it will lead to double work since the element context already contains
     // fluxes through its stored ExtensiveQuantities.
@@ -297,8 +335,9 @@ public:
         const Scalar outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
         const Scalar diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
         const Scalar dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
+        const Scalar dist = (elemCtx.pos(interiorDofIdx, timeIdx) - elemCtx.pos(exteriorDofIdx, timeIdx)).two_norm();
 
-        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
+        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity, dist};
 
         calculateFluxes_(flux,
                          darcy,
@@ -315,7 +354,8 @@ public:
                                  const IntensiveQuantities& intQuantsEx,
                                  const unsigned& globalIndexIn,
                                  const unsigned& globalIndexEx,
-                                 const ResidualNBInfo& nbInfo)
+                                 const ResidualNBInfo& nbInfo,
+                                 const IntensiveQuantityMirror* mirror = nullptr)
     {
         OPM_TIMEBLOCK_LOCAL(calculateFluxes);
         const Scalar Vin = nbInfo.Vin;
@@ -326,6 +366,13 @@ public:
         const Scalar faceArea = nbInfo.faceArea;
         FaceDir::DirEnum facedir = nbInfo.faceDir;
 
+        // the volume fluxes and the upstream cells of the phases are also needed by
+        // the modules
+        std::array<Evaluation, numPhases> volumeFlux;
+        std::array<bool, numPhases> upIsInterior;
+        volumeFlux.fill(0.0);
+        upIsInterior.fill(true);
+
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx))
                 continue;
@@ -337,57 +384,92 @@ public:
             short interiorDofIdx = 0; // NB
             short exteriorDofIdx = 1; // NB
             Evaluation pressureDifference;
-            ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
-                                                             dnIdx,
-                                                             pressureDifference,
-                                                             intQuantsIn,
-                                                             intQuantsEx,
-                                                             phaseIdx, // input
-                                                             interiorDofIdx, // input
-                                                             exteriorDofIdx, // input
-                                                             Vin,
-                                                             Vex,
-                                                             globalIndexIn,
-                                                             globalIndexEx,
-                                                             distZg,
-                                                             thpres);
+            if (mirror)
+                calculatePhasePressureDiff_(upIdx,
+                                            dnIdx,
+                                            pressureDifference,
+                                            *mirror,
+                                            phaseIdx,
+                                            interiorDofIdx,
+                                            exteriorDofIdx,
+                                            Vin,
+                                            Vex,
+                                            globalIndexIn,
+                                            globalIndexEx,
+                                            distZg,
+                                            thpres);
+            else
+                ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                                 dnIdx,
+                                                                 pressureDifference,
+                                                                 intQuantsIn,
+                                                                 intQuantsEx,
+                                                                 phaseIdx, // input
+                                                                 interiorDofIdx, // input
+                                                                 exteriorDofIdx, // input
+                                                                 Vin,
+                                                                 Vex,
+                                                                 globalIndexIn,
+                                                                 globalIndexEx,
+                                                                 distZg,
+                                                                 thpres);
 
 
 
             const IntensiveQuantities& up = (upIdx == interiorDofIdx) ? intQuantsIn : intQuantsEx;
             unsigned globalUpIndex = (upIdx == interiorDofIdx) ? globalIndexIn : globalIndexEx;
             // Use arithmetic average (more accurate with harmonic, but that requires recomputing the transmissbility)
-            const Evaluation transMult = (intQuantsIn.rockCompTransMultiplier() + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+            const Evaluation transMult = mirror
+                ? (mirror->rockCompTransMultiplier(globalIndexIn) + Toolbox::value(mirror->rockCompTransMultiplier(globalIndexEx)))/2
+                : (intQuantsIn.rockCompTransMultiplier() + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+            const Evaluation& upMobility = mirror
+                ? mirror->mobility(globalUpIndex, phaseIdx)
+                : up.mobility(phaseIdx, facedir);
             Evaluation darcyFlux;
             if (pressureDifference == 0) {
                 darcyFlux = 0.0; // NB maybe we could drop calculations
             } else {
                 if (globalUpIndex == globalIndexIn)
-                    darcyFlux = pressureDifference * up.mobility(phaseIdx, facedir) * transMult * (-trans / faceArea);
+                    darcyFlux = pressureDifference * upMobility * transMult * (-trans / faceArea);
                 else
                     darcyFlux = pressureDifference *
-                       (Toolbox::value(up.mobility(phaseIdx, facedir)) * transMult * (-trans / faceArea));
+                       (Toolbox::value(upMobility) * transMult * (-trans / faceArea));
             }
+            volumeFlux[phaseIdx] = darcyFlux;
+            upIsInterior[phaseIdx] = (globalUpIndex == globalIndexIn);
             unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
             darcy[conti0EqIdx + activeCompIdx] = darcyFlux.value() * faceArea; // NB! For the FLORES fluxes without derivatives
 
-            unsigned pvtRegionIdx = up.pvtRegionIndex();
+            // the mirror also provides the PVT region and the dissolution factors, so
+            // the full upstream intensive quantities are only read for the energy
+            unsigned pvtRegionIdx = mirror ? mirror->pvtRegionIndex(globalUpIndex) : up.pvtRegionIndex();
             // if (upIdx == globalFocusDofIdx){
             if (globalUpIndex == globalIndexIn) {
-                const auto& invB
-                    = getInvB_<FluidSystem, FluidState, Evaluation>(up.fluidState(), phaseIdx, pvtRegionIdx);
+                const Evaluation invB = mirror
+                    ? mirror->invB(globalUpIndex, phaseIdx)
+                    : getInvB_<FluidSystem, FluidState, Evaluation>(up.fluidState(), phaseIdx, pvtRegionIdx);
                 const auto& surfaceVolumeFlux = invB * darcyFlux;
-                evalPhaseFluxes_<Evaluation, Evaluation, FluidState>(
-                    flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
+                if (mirror)
+                    evalPhaseFluxes_<Evaluation, Evaluation, DissolutionFactors>(
+                        flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, mirror->dissolutionFactors(globalUpIndex));
+                else
+                    evalPhaseFluxes_<Evaluation, Evaluation, FluidState>(
+                        flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
                 if constexpr (enableEnergy) {
                     EnergyModule::template addPhaseEnthalpyFluxes_<Evaluation, Evaluation, FluidState>(
                         flux, phaseIdx, darcyFlux, up.fluidState());
                 }
             } else {
-                const auto& invB = getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
+                const Scalar invB = mirror
+                    ? Toolbox::value(mirror->invB(globalUpIndex, phaseIdx))
+                    : getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
                 const auto& surfaceVolumeFlux = invB * darcyFlux;
-                evalPhaseFluxes_<Scalar, Evaluation, FluidState>(
-                    flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
+                if (mirror)
+                    evalPhaseFluxes_<Scalar, Evaluation, DissolutionFactors>(
+                        flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, mirror->dissolutionFactors(globalUpIndex));
+                else
+                    evalPhaseFluxes_<Scalar, Evaluation, FluidState>(
+                        flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
                 if constexpr (enableEnergy) {
                     EnergyModule::template
                         addPhaseEnthalpyFluxes_<Scalar, Evaluation, FluidState>
@@ -397,17 +479,59 @@ public:
 
         }
 
+        [[maybe_unused]] const auto upstream = [&](unsigned phaseIdx) -> const IntensiveQuantities&
+        { return upIsInterior[phaseIdx] ? intQuantsIn : intQuantsEx; };
+
         // deal with solvents (if present)
-        static_assert(!enableSolvent, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // SolventModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        [[maybe_unused]] Evaluation solventVolumeFlux = 0.0;
+        [[maybe_unused]] bool solventUpIsInterior = true;
+        if constexpr (enableSolvent) {
+            SolventModule::computeVolumeFlux(solventVolumeFlux,
+                                             solventUpIsInterior,
+                                             intQuantsIn,
+                                             intQuantsEx,
+                                             trans,
+                                             faceArea,
+                                             thpres,
+                                             distZg);
+            SolventModule::computeFlux(flux,
+                                       solventUpIsInterior ? intQuantsIn : intQuantsEx,
+                                       solventUpIsInterior,
+                                       solventVolumeFlux,
+                                       volumeFlux[waterPhaseIdx]);
+        }
 
         // deal with zFracton (if present)
-        static_assert(!enableExtbo, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // ExtboModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableExtbo) {
+            ExtboModule::computeFlux(flux,
+                                     upstream(gasPhaseIdx),
+                                     upIsInterior[gasPhaseIdx],
+                                     volumeFlux[gasPhaseIdx],
+                                     upstream(oilPhaseIdx),
+                                     upIsInterior[oilPhaseIdx],
+                                     volumeFlux[oilPhaseIdx]);
+        }
 
         // deal with polymer (if present)
-        static_assert(!enablePolymer, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // PolymerModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enablePolymer) {
+            Evaluation waterShearFactor;
+            Evaluation polymerShearFactor;
+            PolymerModule::computeShearFactors(waterShearFactor,
+                                               polymerShearFactor,
+                                               intQuantsIn,
+                                               intQuantsEx,
+                                               upIsInterior[waterPhaseIdx],
+                                               volumeFlux[waterPhaseIdx],
+                                               trans,
+                                               faceArea,
+                                               nbInfo.dist);
+            PolymerModule::computeFlux(flux,
+                                       upstream(waterPhaseIdx),
+                                       upIsInterior[waterPhaseIdx],
+                                       volumeFlux[waterPhaseIdx],
+                                       waterShearFactor,
+                                       polymerShearFactor);
+        }
 
         // deal with energy (if present)
         if constexpr(enableEnergy){
@@ -436,12 +560,37 @@ public:
         // EnergyModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
         // deal with foam (if present)
-        static_assert(!enableFoam, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // FoamModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableFoam) {
+            switch (FoamModule::transportPhase()) {
+            case Phase::WATER:
+                FoamModule::computeFlux(flux,
+                                        upstream(waterPhaseIdx),
+                                        upIsInterior[waterPhaseIdx],
+                                        volumeFlux[waterPhaseIdx]);
+                break;
+            case Phase::GAS:
+                FoamModule::computeFlux(flux,
+                                        upstream(gasPhaseIdx),
+                                        upIsInterior[gasPhaseIdx],
+                                        volumeFlux[gasPhaseIdx]);
+                break;
+            default:
+                // solvent. the module rejects all other transport phases
+                FoamModule::computeFlux(flux,
+                                        solventUpIsInterior ? intQuantsIn : intQuantsEx,
+                                        solventUpIsInterior,
+                                        solventVolumeFlux);
+                break;
+            }
+        }
 
         // deal with salt (if present)
-        static_assert(!enableBrine, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // BrineModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableBrine) {
+            BrineModule::computeFlux(flux,
+                                     upstream(waterPhaseIdx),
+                                     upIsInterior[waterPhaseIdx],
+                                     volumeFlux[waterPhaseIdx]);
+        }
 
         // deal with diffusion (if present). opm-models expects per area flux (added in the tmpdiffusivity).
         if constexpr(enableDiffusion){
@@ -470,9 +619,12 @@ public:
 
         }
         // deal with micp (if present)
-        static_assert(!enableMICP, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // MICPModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
-
+        if constexpr (enableMICP) {
+            MICPModule::computeFlux(flux,
+                                    upstream(waterPhaseIdx),
+                                    upIsInterior[waterPhaseIdx],
+                                    volumeFlux[waterPhaseIdx]);
+        }
     }
 
     template <class BoundaryConditionData>
@@ -597,9 +749,38 @@ public:
             EnergyModule::addHeatFlux(bdyFlux, heatFlux);
         }
 
-        static_assert(!enableSolvent, "Relevant treatment of boundary conditions must be implemented before enabling.");
-        static_assert(!enablePolymer, "Relevant treatment of boundary conditions must be implemented before enabling.");
-        static_assert(!enableMICP, "Relevant treatment of boundary conditions must be implemented before enabling.");
+        // like for the phases, the solvent volume flux is driven by the gas pressure
+        // difference. since the boundary fluid state does not specify the amount of
+        // solvent, the solvent only flows if the inside cell is upstream. as for the
+        // element context based variant, it is transported with the inside cell's
+        // quantities.
+        if constexpr (enableSolvent) {
+            if (pressureDifference[gasPhaseIdx] < 0.0) {
+                const Scalar trans = problem.transmissibilityBoundary(globalSpaceIdx, bdyInfo.boundaryFaceIndex);
+                Evaluation solventFlux =
+                    pressureDifference[gasPhaseIdx]*insideIntQuants.solventMobility()*(-trans/bdyInfo.faceArea);
+                if (blackoilConserveSurfaceVolume)
+                    solventFlux *= insideIntQuants.solventInverseFormationVolumeFactor();
+                else
+                    solventFlux *= insideIntQuants.solventDensity();
+                bdyFlux[Indices::contiSolventEqIdx] = solventFlux;
+            }
+        }
+
+        // like for the element context based variant, polymer and the MICP components
+        // are transported with the concentrations of the inside cell
+        if constexpr (enablePolymer) {
+            bdyFlux[Indices::contiPolymerEqIdx] =
+                volumeFlux[waterPhaseIdx]*insideIntQuants.polymerConcentration();
+        }
+        if constexpr (enableMICP) {
+            bdyFlux[Indices::contiMicrobialEqIdx] =
+                volumeFlux[waterPhaseIdx]*insideIntQuants.microbialConcentration();
+            bdyFlux[Indices::contiOxygenEqIdx] =
+                volumeFlux[waterPhaseIdx]*insideIntQuants.oxygenConcentration();
+            bdyFlux[Indices::contiUreaEqIdx] =
+                volumeFlux[waterPhaseIdx]*insideIntQuants.ureaConcentration();
+        }
 
         // make sure that the right mass conservation quantities are used
         adaptMassConservationQuantities_(bdyFlux, insideIntQuants.pvtRegionIndex());
@@ -657,9 +838,36 @@ public:
         problem.source(source, globalSpaceIdex, timeIdx);
 
         // deal with MICP (if present)
-        // deal with micp (if present)
-        static_assert(!enableMICP, "Relevant addSource() method must be implemented for this module before enabling.");
-        // MICPModule::addSource(source, elemCtx, dofIdx, timeIdx);
+        static_assert(!enableMICP, "The source term of MICP depends on the neighbors of the cell, use the "
+                      "overload of computeSource() which takes the neighbor information.");
+
+        // scale the source term of the energy equation
+        if (enableEnergy)
+            source[Indices::contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
+    }
+
+    /*!
+     * \brief Compute the source term of a cell including the contributions of the
+     *        modules which depend on the fluxes over the faces of the cell.
+     *
+     * \c nbInfos is a range of the neighbors of the cell. Each of its entries provides
+     * the global index of the neighbor as \c neighbor and the ResidualNBInfo of the face
+     * as \c res_nbinfo.
+     */
+    template <class NeighborInfoRange>
+    static void computeSource(RateVector& source,
+                              const Problem& problem,
+                              const IntensiveQuantities& intQuants,
+                              unsigned globalSpaceIdex,
+                              const NeighborInfoRange& nbInfos,
+                              unsigned timeIdx)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeSource);
+        // retrieve the source term intrinsic to the problem
+        problem.source(source, globalSpaceIdex, timeIdx);
+
+        // deal with MICP (if present)
+        addMICPSource_(source, problem, intQuants, globalSpaceIdex, nbInfos, timeIdx);
 
         // scale the source term of the energy equation
         if (enableEnergy)
@@ -675,9 +883,33 @@ public:
         problem.addToSourceDense(source, globalSpaceIdex, timeIdx);
 
         // deal with MICP (if present)
-        // deal with micp (if present)
-        static_assert(!enableMICP, "Relevant addSource() method must be implemented for this module before enabling.");
-        // MICPModule::addSource(source, elemCtx, dofIdx, timeIdx);
+        static_assert(!enableMICP, "The source term of MICP depends on the neighbors of the cell, use the "
+                      "overload of computeSourceDense() which takes the neighbor information.");
+
+        // scale the source term of the energy equation
+        if (enableEnergy)
+            source[Indices::contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
+    }
+
+    /*!
+     * \brief Compute the dense source term of a cell including the contributions of
+     *        the modules which depend on the fluxes over the faces of the cell.
+     *
+     * \copydetails computeSource(RateVector&, const Problem&, const IntensiveQuantities&, unsigned, const NeighborInfoRange&, unsigned)
+     */
+    template <class NeighborInfoRange>
+    static void computeSourceDense(RateVector& source,
+                                   const Problem& problem,
+                                   const IntensiveQuantities& intQuants,
+                                   unsigned globalSpaceIdex,
+                                   const NeighborInfoRange& nbInfos,
+                                   unsigned timeIdx)
+    {
+        source = 0.0;
+        problem.addToSourceDense(source, globalSpaceIdex, timeIdx);
+
+        // deal with MICP (if present)
+        addMICPSource_(source, problem, intQuants, globalSpaceIdex, nbInfos, timeIdx);
 
         // scale the source term of the energy equation
         if (enableEnergy)
@@ -704,6 +936,141 @@ public:
                         source[Indices::contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
     }
 
+    // the detachment of the biofilm depends on the maximum norm of the water pressure
+    // gradient in the cell, which is determined from the water fluxes over its faces
+    // like in MICPModule::addSource() for the element context.
+    template <class NeighborInfoRange>
+    static void addMICPSource_([[maybe_unused]] RateVector& source,
+                               [[maybe_unused]] const Problem& problem,
+                               [[maybe_unused]] const IntensiveQuantities& intQuantsIn,
+                               [[maybe_unused]] unsigned globalIndexIn,
+                               [[maybe_unused]] const NeighborInfoRange& nbInfos,
+                               [[maybe_unused]] unsigned timeIdx)
+    {
+        if constexpr (enableMICP) {
+            const Scalar K = problem.intrinsicPermeability(globalIndexIn)[0][0];
+            Evaluation dpW = 0.0;
+            for (const auto& nbInfo : nbInfos) {
+                const unsigned globalIndexEx = nbInfo.neighbor;
+                const IntensiveQuantities& intQuantsEx = problem.model().intensiveQuantities(globalIndexEx, timeIdx);
+                const ResidualNBInfo& faceInfo = nbInfo.res_nbinfo;
+
+                short upIdx;
+                short dnIdx;
+                const short interiorDofIdx = 0;
+                const short exteriorDofIdx = 1;
+                Evaluation pressureDifference;
+                ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                                 dnIdx,
+                                                                 pressureDifference,
+                                                                 intQuantsIn,
+                                                                 intQuantsEx,
+                                                                 waterPhaseIdx,
+                                                                 interiorDofIdx,
+                                                                 exteriorDofIdx,
+                                                                 faceInfo.Vin,
+                                                                 faceInfo.Vex,
+                                                                 globalIndexIn,
+                                                                 globalIndexEx,
+                                                                 faceInfo.dZg,
+                                                                 faceInfo.thpres);
+
+                // the water flux divided by the upstream mobility. faces without mobile
+                // water do not contribute
+                const auto& up = (upIdx == interiorDofIdx) ? intQuantsIn : intQuantsEx;
+                if (pressureDifference == 0.0 || !(up.mobility(waterPhaseIdx) > 0.0))
+                    continue;
+
+                const Evaluation transMult =
+                    (intQuantsIn.rockCompTransMultiplier() + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+                const Evaluation waterVolumeVelocity =
+                    pressureDifference*transMult*(-faceInfo.trans/faceInfo.faceArea)/K;
+                dpW = std::max(dpW, abs(waterVolumeVelocity));
+            }
+
+            MICPModule::addSource(source, intQuantsIn, dpW);
+        }
+    }
+
+    /*!
+     * \brief Compute the pressure difference of a phase across a face and determine
+     *        the upstream DOF from the compact copy of the intensive quantities.
+     *
+     * This uses the same rules as ExtensiveQuantities::calculatePhasePressureDiff_():
+     * Gravity is accounted for by the average density of the two DOFs (without its
+     * derivatives if the extended black-oil module is enabled), ties are broken by the
+     * volume and then by the global index of the DOFs, and the threshold pressure is
+     * subtracted from the magnitude of the pressure difference.
+     */
+    static void calculatePhasePressureDiff_(short& upIdx,
+                                            short& dnIdx,
+                                            Evaluation& pressureDifference,
+                                            const IntensiveQuantityMirror& mirror,
+                                            const unsigned phaseIdx,
+                                            const short interiorDofIdx,
+                                            const short exteriorDofIdx,
+                                            const Scalar Vin,
+                                            const Scalar Vex,
+                                            const unsigned globalIndexIn,
+                                            const unsigned globalIndexEx,
+                                            const Scalar distZg,
+                                            const Scalar thpres)
+    {
+        // if the phase is immobile in both DOFs, there is no flux
+        if (mirror.mobility(globalIndexIn, phaseIdx) <= 0.0 &&
+            mirror.mobility(globalIndexEx, phaseIdx) <= 0.0)
+        {
+            upIdx = interiorDofIdx;
+            dnIdx = exteriorDofIdx;
+            pressureDifference = 0.0;
+            return;
+        }
+
+        // compute the hydrostatic pressure of the exterior DOF at the depth of the
+        // interior one
+        const Evaluation& rhoIn = mirror.density(globalIndexIn, phaseIdx);
+        const Scalar rhoEx = Toolbox::value(mirror.density(globalIndexEx, phaseIdx));
+        const Evaluation rhoAvg = (rhoIn + rhoEx)/2;
+
+        const Evaluation& pressureInterior = mirror.pressure(globalIndexIn, phaseIdx);
+        Evaluation pressureExterior = Toolbox::value(mirror.pressure(globalIndexEx, phaseIdx));
+        if constexpr (enableExtbo)
+            // added stability: the solvent fraction of the extended black-oil model
+            // tends to exhibit a 0/1 behaviour
+            pressureExterior += Toolbox::value(rhoAvg)*distZg;
+        else
+            pressureExterior += rhoAvg*distZg;
+
+        pressureDifference = pressureExterior - pressureInterior;
+
+        bool interiorIsUpstream;
+        if (pressureDifference > 0.0)
+            interiorIsUpstream = false;
+        else if (pressureDifference < 0.0)
+            interiorIsUpstream = true;
+        else if (Vin != Vex)
+            // the DOF with the larger volume is upstream
+            interiorIsUpstream = Vin > Vex;
+        else
+            // the DOF with the smaller global index is upstream
+            interiorIsUpstream = globalIndexIn < globalIndexEx;
+
+        upIdx = interiorIsUpstream ? interiorDofIdx : exteriorDofIdx;
+        dnIdx = interiorIsUpstream ? exteriorDofIdx : interiorDofIdx;
+
+        // apply the threshold pressure of the face
+        if (thpres > 0.0) {
+            if (std::abs(Toolbox::value(pressureDifference)) > thpres) {
+                if (pressureDifference < 0.0)
+                    pressureDifference += thpres;
+                else
+                    pressureDifference -= thpres;
+            }
+            else
+                pressureDifference = 0.0;
+        }
+    }
+
     template <class UpEval, class FluidState>
     static void evalPhaseFluxes_(RateVector& flux,
                                  unsigned phaseIdx,
@@ -277,16 +277,34 @@ public:
         const unsigned inIdx = extQuants.interiorIndex();
         const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
 
+        computeFlux(flux, up, upIdx == inIdx, extQuants.volumeFlux(waterPhaseIdx));
+    }
+
+    /*!
+     * \brief Compute the fluxes of the suspended MICP components over a face from the
+     *        intensive quantities of the upstream DOF of the water phase and the water
+     *        volume flux.
+     *
+     * If the upstream DOF is not the interior one, only the derivatives of the volume
+     * flux are considered.
+     */
+    static void computeFlux(RateVector& flux,
+                            const IntensiveQuantities& up,
+                            bool upIsInterior,
+                            const Evaluation& waterVolumeFlux)
+    {
+        if (!enableMICP)
+            return;
 
-        if (upIdx == inIdx) {
-            flux[contiMicrobialEqIdx] = extQuants.volumeFlux(waterPhaseIdx) * up.microbialConcentration();
-            flux[contiOxygenEqIdx] = extQuants.volumeFlux(waterPhaseIdx) * up.oxygenConcentration();
-            flux[contiUreaEqIdx] = extQuants.volumeFlux(waterPhaseIdx) * up.ureaConcentration();
+        if (upIsInterior) {
+            flux[contiMicrobialEqIdx] = waterVolumeFlux * up.microbialConcentration();
+            flux[contiOxygenEqIdx] = waterVolumeFlux * up.oxygenConcentration();
+            flux[contiUreaEqIdx] = waterVolumeFlux * up.ureaConcentration();
         }
         else {
-            flux[contiMicrobialEqIdx] = extQuants.volumeFlux(waterPhaseIdx) * decay<Scalar>(up.microbialConcentration());
-            flux[contiOxygenEqIdx] = extQuants.volumeFlux(waterPhaseIdx) * decay<Scalar>(up.oxygenConcentration());
-            flux[contiUreaEqIdx] = extQuants.volumeFlux(waterPhaseIdx) * decay<Scalar>(up.ureaConcentration());
+            flux[contiMicrobialEqIdx] = waterVolumeFlux * decay<Scalar>(up.microbialConcentration());
+            flux[contiOxygenEqIdx] = waterVolumeFlux * decay<Scalar>(up.oxygenConcentration());
+            flux[contiUreaEqIdx] = waterVolumeFlux * decay<Scalar>(up.ureaConcentration());
         }
     }
 
@@ -316,6 +334,22 @@ public:
           dpW = std::max(dpW, abs(waterVolumeVelocity));
         }
 
+        addSource(source, intQuants, dpW);
+    }
+
+    /*!
+     * \brief Add the source terms of the MICP processes of a DOF.
+     *
+     * \c dpW is the maximum norm of the water pressure gradient in the DOF, which
+     * determines the detachment of the biofilm.
+     */
+    static void addSource(RateVector& source,
+                          const IntensiveQuantities& intQuants,
+                          const Evaluation& dpW)
+    {
+        if (!enableMICP)
+            return;
+
         // get the model parameters
         Scalar k_a = microbialAttachmentRate();
         Scalar k_d = microbialDeathRate();
@@ -36,6 +36,7 @@
 #include "blackoilextensivequantities.hh"
 #include "blackoilprimaryvariables.hh"
 #include "blackoilintensivequantities.hh"
+#include "blackoilintensivequantitymirror.hh"
 #include "blackoilratevector.hh"
 #include "blackoilboundaryratevector.hh"
 #include "blackoillocalresidual.hh"
@@ -58,6 +59,7 @@
 
 #include <opm/material/fluidsystems/BlackOilFluidSystem.hpp>
 
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -207,6 +209,15 @@ struct BlackoilConserveSurfaceVolume<TypeTag, TTag::BlackOilModel> { static cons
 
 } // namespace Opm::Properties
 
+namespace Opm::Parameters {
+
+//! Do not keep a compact copy of the intensive quantities by default
+template<class TypeTag>
+struct EnableIntensiveQuantityMirror<TypeTag, Properties::TTag::BlackOilModel>
+{ static constexpr bool value = false; };
+
+} // namespace Opm::Parameters
+
 namespace Opm {
 
 /*!
@@ -306,7 +317,10 @@ private:
     using DispersionModule = BlackOilDispersionModule<TypeTag, enableDispersion>;
     using MICPModule = BlackOilMICPModule<TypeTag>;
 
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
 public:
+    using IntensiveQuantityMirror = BlackOilIntensiveQuantityMirror<TypeTag>;
 
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
 
@@ -314,6 +328,13 @@ public:
         : ParentType(simulator)
     {
         eqWeights_.resize(numEq, 1.0);
+
+        // the mirror is filled from the cached intensive quantities
+        if (Parameters::get<TypeTag, Parameters::EnableIntensiveQuantityMirror>() &&
+            this->storeIntensiveQuantities())
+        {
+            intensiveQuantityMirror_ = std::make_unique<IntensiveQuantityMirror>();
+        }
     }
 
     /*!
@@ -323,6 +344,10 @@ public:
     {
         ParentType::registerParameters();
 
+        Parameters::registerParam<TypeTag, Parameters::EnableIntensiveQuantityMirror>
+            ("Keep a compact copy of the intensive quantities which are needed "
+             "to compute the fluxes of the TPFA discretization");
+
         SolventModule::registerParameters();
         ExtboModule::registerParameters();
         PolymerModule::registerParameters();
@@ -459,6 +484,16 @@ public:
         eqWeights_[eqIdx] = value;
     }
 
+    /*!
+     * \brief Returns the compact copy of the intensive quantities of the most recent
+     *        time index or nullptr if it is not maintained.
+     *
+     * The copy is updated whenever the cached intensive quantities of the most recent
+     * time index are written.
+     */
+    const IntensiveQuantityMirror* intensiveQuantityMirror() const
+    { return intensiveQuantityMirror_.get(); }
+
     /*!
      * \brief Write the current solution for a degree of freedom to a
      *        restart file.
@@ -547,6 +582,40 @@ public:
         priVars.setPvtRegionIndex(pvtRegionIdx);
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::numSerializedDofFlags
+     */
+    unsigned numSerializedDofFlags() const
+    { return 6; }
+
+    /*!
+     * \copydoc FvBaseDiscretization::serializeDofFlags
+     */
+    void serializeDofFlags(unsigned dofIdx, int* flags) const
+    {
+        const auto& priVars = this->solution(/*timeIdx=*/0)[dofIdx];
+        flags[0] = static_cast<int>(priVars.primaryVarsMeaningGas());
+        flags[1] = static_cast<int>(priVars.primaryVarsMeaningWater());
+        flags[2] = static_cast<int>(priVars.primaryVarsMeaningPressure());
+        flags[3] = static_cast<int>(priVars.primaryVarsMeaningBrine());
+        flags[4] = static_cast<int>(priVars.primaryVarsMeaningSolvent());
+        flags[5] = static_cast<int>(priVars.pvtRegionIndex());
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::deserializeDofFlags
+     */
+    void deserializeDofFlags(unsigned dofIdx, const int* flags)
+    {
+        auto& priVars = this->solution(/*timeIdx=*/0)[dofIdx];
+        priVars.setPrimaryVarsMeaningGas(static_cast<typename PrimaryVariables::GasMeaning>(flags[0]));
+        priVars.setPrimaryVarsMeaningWater(static_cast<typename PrimaryVariables::WaterMeaning>(flags[1]));
+        priVars.setPrimaryVarsMeaningPressure(static_cast<typename PrimaryVariables::PressureMeaning>(flags[2]));
+        priVars.setPrimaryVarsMeaningBrine(static_cast<typename PrimaryVariables::BrineMeaning>(flags[3]));
+        priVars.setPrimaryVarsMeaningSolvent(static_cast<typename PrimaryVariables::SolventMeaning>(flags[4]));
+        priVars.setPvtRegionIndex(static_cast<unsigned>(flags[5]));
+    }
+
     /*!
      * \brief Deserializes the state of the model.
      *
@@ -584,6 +653,20 @@ protected:
     friend Discretization;
 */
 
+    void prepareIntensiveQuantityMirror_(unsigned timeIdx) const
+    {
+        if (intensiveQuantityMirror_ && timeIdx == 0)
+            intensiveQuantityMirror_->prepare(this->numGridDof());
+    }
+
+    void updateIntensiveQuantityMirror_(unsigned globalIdx,
+                                        const IntensiveQuantities& intQuants,
+                                        unsigned timeIdx) const
+    {
+        if (intensiveQuantityMirror_ && timeIdx == 0)
+            intensiveQuantityMirror_->update(globalIdx, intQuants);
+    }
+
     template <class Context>
     void supplementInitialSolution_(PrimaryVariables& priVars,
                                     const Context& context,
@@ -611,6 +694,7 @@ protected:
 private:
 
     std::vector<Scalar> eqWeights_;
+    mutable std::unique_ptr<IntensiveQuantityMirror> intensiveQuantityMirror_;
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
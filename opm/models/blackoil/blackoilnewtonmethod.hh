@@ -36,6 +36,8 @@
 #include <opm/models/nonlinear/newtonmethod.hh>
 #include "blackoilmicpmodules.hh"
 
+#include <vector>
+
 namespace Opm::Properties {
 
 template <class TypeTag, class MyTypeTag>
@@ -148,6 +150,7 @@ class BlackOilNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonM
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
     using MICPModule = BlackOilMICPModule<TypeTag>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     static const unsigned numEq = getPropValue<TypeTag, Properties::NumEq>();
     static constexpr bool enableSaltPrecipitation = getPropValue<TypeTag, Properties::EnableSaltPrecipitation>();
@@ -177,6 +180,8 @@ public:
 
         wasSwitched_.resize(this->model().numTotalDof());
         std::fill(wasSwitched_.begin(), wasSwitched_.end(), false);
+
+        numPriVarsSwitchedPerThread_.resize(ThreadManager::maxThreads());
     }
 
     /*!
@@ -228,6 +233,8 @@ protected:
     void beginIteration_()
     {
         numPriVarsSwitched_ = 0;
+        for (auto& threadSwitched : numPriVarsSwitchedPerThread_)
+            threadSwitched.value = 0;
         ParentType::beginIteration_();
     }
 
@@ -279,6 +286,7 @@ public:
         if (!succeeded)
             throw NumericalProblem("A process did not succeed in adapting the primary variables");
 
+        collectNumPriVarsSwitched_();
         numPriVarsSwitched_ = comm.sum(numPriVarsSwitched_);
     }
 
@@ -300,6 +308,7 @@ public:
                                     solutionUpdate[dofIdx],
                                     currentResidual[dofIdx]);
         }
+        collectNumPriVarsSwitched_();
     }
 
 protected:
@@ -500,8 +509,10 @@ protected:
         else
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx, waterSaturationMax_, waterOnlyThreshold_);
 
+        // this method may be called concurrently for different DOFs, so the number of
+        // switched DOFs is accumulated per thread
         if (wasSwitched_[globalDofIdx])
-            ++ numPriVarsSwitched_;
+            ++ numPriVarsSwitchedPerThread_[ThreadManager::threadId()].value;
         if(projectSaturations_){
             nextValue.chopAndNormalizeSaturations();
         }
@@ -510,7 +521,23 @@ protected:
     }
 
 private:
+    // add the number of switched DOFs accumulated by the threads to the total
+    void collectNumPriVarsSwitched_()
+    {
+        for (auto& threadSwitched : numPriVarsSwitchedPerThread_) {
+            numPriVarsSwitched_ += threadSwitched.value;
+            threadSwitched.value = 0;
+        }
+    }
+
+    // counter of a single thread, padded to a cache line to avoid false sharing
+    struct alignas(64) ThreadCounter
+    {
+        int value = 0;
+    };
+
     int numPriVarsSwitched_;
+    std::vector<ThreadCounter> numPriVarsSwitchedPerThread_;
 
     Scalar priVarOscilationThreshold_;
     Scalar waterSaturationMax_;
@@ -526,8 +553,9 @@ private:
     Scalar pressMin_;
 
     // keep track of cells where the primary variable meaning has changed
-    // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // to detect and hinder oscillations. Note that this is not a std::vector<bool>
+    // because the entries are written concurrently by multiple threads.
+    std::vector<unsigned char> wasSwitched_;
 };
 } // namespace Opm
 
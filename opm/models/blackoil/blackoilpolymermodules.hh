@@ -521,36 +521,63 @@ public:
             const unsigned upIdx = extQuants.upstreamIndex(FluidSystem::waterPhaseIdx);
             const unsigned inIdx = extQuants.interiorIndex();
             const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+
+            computeFlux(flux,
+                        up,
+                        upIdx == inIdx,
+                        extQuants.volumeFlux(waterPhaseIdx),
+                        extQuants.waterShearFactor(),
+                        extQuants.polymerShearFactor());
+        }
+    }
+
+    /*!
+     * \brief Compute the polymer flux over a face from the intensive quantities of the
+     *        upstream DOF of the water phase, the water volume flux and the shear
+     *        factors of the face.
+     *
+     * The flux of water, which must already be stored in \c flux, is corrected by the
+     * shear factor of water. If the upstream DOF is not the interior one, only the
+     * derivatives of the volume flux are considered.
+     */
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior,
+                            [[maybe_unused]] const Evaluation& waterVolumeFlux,
+                            [[maybe_unused]] const Evaluation& waterShearFactor,
+                            [[maybe_unused]] const Evaluation& polymerShearFactor)
+    {
+        if constexpr (enablePolymer) {
             const unsigned contiWaterEqIdx = Indices::conti0EqIdx + Indices::canonicalToActiveComponentIndex(FluidSystem::waterCompIdx);
 
-            if (upIdx == inIdx) {
+            if (upIsInterior) {
                 flux[contiPolymerEqIdx] =
-                        extQuants.volumeFlux(waterPhaseIdx)
+                        waterVolumeFlux
                         *up.fluidState().invB(waterPhaseIdx)
                         *up.polymerViscosityCorrection()
-                        /extQuants.polymerShearFactor()
+                        /polymerShearFactor
                         *up.polymerConcentration();
 
                 // modify water
                 flux[contiWaterEqIdx] /=
-                        extQuants.waterShearFactor();
+                        waterShearFactor;
             }
             else {
                 flux[contiPolymerEqIdx] =
-                        extQuants.volumeFlux(waterPhaseIdx)
+                        waterVolumeFlux
                         *decay<Scalar>(up.fluidState().invB(waterPhaseIdx))
                         *decay<Scalar>(up.polymerViscosityCorrection())
-                        /decay<Scalar>(extQuants.polymerShearFactor())
+                        /decay<Scalar>(polymerShearFactor)
                         *decay<Scalar>(up.polymerConcentration());
 
                 // modify water
                 flux[contiWaterEqIdx] /=
-                        decay<Scalar>(extQuants.waterShearFactor());
+                        decay<Scalar>(waterShearFactor);
             }
 
             // flux related to transport of polymer molecular weight
             if constexpr (enablePolymerMolarWeight) {
-                if (upIdx == inIdx)
+                if (upIsInterior)
                     flux[contiPolymerMolarWeightEqIdx] =
                         flux[contiPolymerEqIdx]*up.polymerMoleWeight();
                 else
@@ -560,6 +587,70 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the shear factors of water and polymer for a face from the
+     *        intensive quantities of the two adjacent cells.
+     *
+     * This uses the same approach as
+     * BlackOilPolymerExtensiveQuantities::updateShearMultipliers(), but the PVT region
+     * and the critical water saturation are taken from the interior cell. \c dist is
+     * the distance between the centers of the two cells. Only the derivatives with
+     * respect to the primary variables of the interior cell are considered.
+     */
+    static void computeShearFactors([[maybe_unused]] Evaluation& waterShearFactor,
+                                    [[maybe_unused]] Evaluation& polymerShearFactor,
+                                    [[maybe_unused]] const IntensiveQuantities& intQuantsIn,
+                                    [[maybe_unused]] const IntensiveQuantities& intQuantsEx,
+                                    [[maybe_unused]] bool upIsInterior,
+                                    [[maybe_unused]] const Evaluation& waterVolumeFlux,
+                                    [[maybe_unused]] Scalar trans,
+                                    [[maybe_unused]] Scalar faceArea,
+                                    [[maybe_unused]] Scalar dist)
+    {
+        waterShearFactor = 1.0;
+        polymerShearFactor = 1.0;
+
+        if constexpr (enablePolymer) {
+            if (!hasPlyshlog())
+                return;
+
+            const auto& up = upIsInterior ? intQuantsIn : intQuantsEx;
+            const auto upValue = [upIsInterior](const Evaluation& x)
+            { return upIsInterior ? x : Evaluation(Toolbox::value(x)); };
+
+            // compute water velocity from flux
+            const Evaluation poroAvg = intQuantsIn.porosity()*0.5 + Toolbox::value(intQuantsEx.porosity())*0.5;
+            const unsigned pvtnumRegionIdx = intQuantsIn.pvtRegionIndex();
+            const Evaluation Sw = upValue(up.fluidState().saturation(waterPhaseIdx));
+            const Scalar Swcr = intQuantsIn.waterCriticalSaturation();
+
+            // guard against zero porosity and no mobile water
+            Evaluation denom = max(poroAvg * (Sw - Swcr), 1e-12);
+            Evaluation waterVolumeVelocity = waterVolumeFlux / denom;
+
+            // if shrate is specified. Compute shrate based on the water velocity
+            if (hasShrate() && trans > 0.0) {
+                const Evaluation relWater = upValue(up.relativePermeability(waterPhaseIdx));
+                // compute permeability from transmissibility.
+                Scalar absPerm = trans / faceArea * dist;
+                waterVolumeVelocity *=
+                    shrate(pvtnumRegionIdx)*sqrt(poroAvg*Sw / (relWater*absPerm));
+                assert(isfinite(waterVolumeVelocity));
+            }
+
+            // compute share factors for water and polymer
+            const Evaluation polymerConcentration = upValue(up.polymerConcentration());
+            waterShearFactor =
+                computeShearFactor(polymerConcentration,
+                                   pvtnumRegionIdx,
+                                   waterVolumeVelocity);
+            polymerShearFactor =
+                computeShearFactor(polymerConcentration,
+                                   pvtnumRegionIdx,
+                                   waterVolumeVelocity*upValue(up.polymerViscosityCorrection()));
+        }
+    }
+
     /*!
      * \brief Return how much a Newton-Raphson update is considered an error
      */
@@ -896,6 +987,16 @@ public:
         // update rock properties
         polymerDeadPoreVolume_ = PolymerModule::plyrockDeadPoreVolume(elemCtx, dofIdx, timeIdx);
         polymerRockDensity_ = PolymerModule::plyrockRockDensityFactor(elemCtx, dofIdx, timeIdx);
+
+        // the critical water saturation is needed to compute the water velocity for
+        // the shear effects if the fluxes are calculated without an element context
+        waterCriticalSaturation_ = 0.0;
+        if (PolymerModule::hasPlyshlog()) {
+            const unsigned globalSpaceIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+            const auto& materialLawManager = elemCtx.problem().materialLawManager();
+            waterCriticalSaturation_ =
+                materialLawManager->oilWaterScaledEpsInfoDrainage(globalSpaceIdx).Swcr;
+        }
     }
 
     const Evaluation& polymerConcentration() const
@@ -926,6 +1027,10 @@ public:
     const Evaluation& waterViscosityCorrection() const
     { return waterViscosityCorrection_; }
 
+    // scaled critical water saturation, only available if PLYSHLOG is used
+    Scalar waterCriticalSaturation() const
+    { return waterCriticalSaturation_; }
+
 
 protected:
     Implementation& asImp_()
@@ -939,6 +1044,7 @@ protected:
     Evaluation polymerAdsorption_;
     Evaluation polymerViscosityCorrection_;
     Evaluation waterViscosityCorrection_;
+    Scalar waterCriticalSaturation_;
 
 
 };
@@ -976,6 +1082,9 @@ public:
 
     const Evaluation& waterViscosityCorrection() const
     { throw std::runtime_error("waterViscosityCorrection() called but polymers are disabled"); }
+
+    Scalar waterCriticalSaturation() const
+    { throw std::runtime_error("waterCriticalSaturation() called but polymers are disabled"); }
 };
 
 
@@ -93,4 +93,12 @@ struct BlackOilEnergyScalingFactor { using type = UndefinedProperty; };
 
 } // namespace Opm::Properties
 
+namespace Opm::Parameters {
+
+//! Keep a compact copy of the intensive quantities which are read by the TPFA fluxes
+template<class TypeTag, class MyTypeTag>
+struct EnableIntensiveQuantityMirror { using type = Properties::UndefinedProperty; };
+
+} // namespace Opm::Parameters
+
 #endif
@@ -472,50 +472,74 @@ public:
             unsigned inIdx = extQuants.interiorIndex();
             const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
 
+            computeFlux(flux,
+                        up,
+                        upIdx == inIdx,
+                        extQuants.solventVolumeFlux(),
+                        extQuants.volumeFlux(waterPhaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Compute the solvent flux over a face from the intensive quantities of the
+     *        upstream DOF of the solvent, the solvent volume flux and the water volume
+     *        flux.
+     *
+     * The solvent dissolved in water is transported using the upstream DOF of the
+     * solvent, too. If the upstream DOF is not the interior one, only the derivatives
+     * of the volume fluxes are considered.
+     */
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior,
+                            [[maybe_unused]] const Evaluation& solventVolumeFlux,
+                            [[maybe_unused]] const Evaluation& waterVolumeFlux)
+    {
+        if constexpr (enableSolvent) {
             if constexpr (blackoilConserveSurfaceVolume) {
-                if (upIdx == inIdx) 
+                if (upIsInterior)
                     flux[contiSolventEqIdx] =
-                            extQuants.solventVolumeFlux()
+                            solventVolumeFlux
                             *up.solventInverseFormationVolumeFactor();
                 else
                     flux[contiSolventEqIdx] =
-                            extQuants.solventVolumeFlux()
+                            solventVolumeFlux
                             *decay<Scalar>(up.solventInverseFormationVolumeFactor());
 
 
                 if (isSolubleInWater()) {
-                    if (upIdx == inIdx) 
+                    if (upIsInterior)
                         flux[contiSolventEqIdx] +=
-                                extQuants.volumeFlux(waterPhaseIdx)
+                                waterVolumeFlux
                                 * up.fluidState().invB(waterPhaseIdx)
                                 * up.rsSolw();
                     else
                         flux[contiSolventEqIdx] +=
-                                extQuants.volumeFlux(waterPhaseIdx)
+                                waterVolumeFlux
                                 *decay<Scalar>(up.fluidState().invB(waterPhaseIdx))
                                 *decay<Scalar>(up.rsSolw());
                 }
             }
             else {
-                if (upIdx == inIdx)
+                if (upIsInterior)
                     flux[contiSolventEqIdx] =
-                            extQuants.solventVolumeFlux()
+                            solventVolumeFlux
                             *up.solventDensity();
                 else
                     flux[contiSolventEqIdx] =
-                            extQuants.solventVolumeFlux()
+                            solventVolumeFlux
                             *decay<Scalar>(up.solventDensity());
 
 
                 if (isSolubleInWater()) {
-                    if (upIdx == inIdx) 
+                    if (upIsInterior)
                         flux[contiSolventEqIdx] +=
-                                extQuants.volumeFlux(waterPhaseIdx)
+                                waterVolumeFlux
                                 * up.fluidState().density(waterPhaseIdx)
                                 * up.rsSolw();
                     else
                         flux[contiSolventEqIdx] +=
-                                extQuants.volumeFlux(waterPhaseIdx)
+                                waterVolumeFlux
                                 *decay<Scalar>(up.fluidState().density(waterPhaseIdx))
                                 *decay<Scalar>(up.rsSolw());
                 }
@@ -523,6 +547,67 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the volume flux of the solvent over a face from the intensive
+     *        quantities of the two adjacent cells.
+     *
+     * This is the two-point flux approximation which is also used by
+     * BlackOilSolventExtensiveQuantities::updateVolumeFluxTrans(): The gas pressure
+     * potential difference is used and the threshold pressure of the face is
+     * subtracted from it. The flux is per face area and only the derivatives with
+     * respect to the primary variables of the interior cell are considered.
+     */
+    static void computeVolumeFlux([[maybe_unused]] Evaluation& solventVolumeFlux,
+                                  [[maybe_unused]] bool& upIsInterior,
+                                  [[maybe_unused]] const IntensiveQuantities& intQuantsIn,
+                                  [[maybe_unused]] const IntensiveQuantities& intQuantsEx,
+                                  [[maybe_unused]] Scalar trans,
+                                  [[maybe_unused]] Scalar faceArea,
+                                  [[maybe_unused]] Scalar thpres,
+                                  [[maybe_unused]] Scalar distZg)
+    {
+        if constexpr (enableSolvent) {
+            constexpr unsigned gasPhaseIdx = FluidSystem::gasPhaseIdx;
+
+            const Evaluation& rhoIn = intQuantsIn.solventDensity();
+            Scalar rhoEx = Toolbox::value(intQuantsEx.solventDensity());
+            const Evaluation& rhoAvg = rhoIn*0.5 + rhoEx*0.5;
+
+            const Evaluation& pressureInterior = intQuantsIn.fluidState().pressure(gasPhaseIdx);
+            Evaluation pressureExterior = Toolbox::value(intQuantsEx.fluidState().pressure(gasPhaseIdx));
+            pressureExterior += distZg*rhoAvg;
+
+            Evaluation pressureDiffSolvent = pressureExterior - pressureInterior;
+            if (std::abs(scalarValue(pressureDiffSolvent)) > thpres) {
+                if (pressureDiffSolvent < 0.0)
+                    pressureDiffSolvent += thpres;
+                else
+                    pressureDiffSolvent -= thpres;
+            }
+            else
+                pressureDiffSolvent = 0.0;
+
+            // if the potential difference is zero, the interior cell is considered to
+            // be upstream like for the element context based variant
+            upIsInterior = !(pressureDiffSolvent > 0.0);
+            if (pressureDiffSolvent == 0.0) {
+                solventVolumeFlux = 0.0;
+                return;
+            }
+
+            if (upIsInterior)
+                solventVolumeFlux =
+                    intQuantsIn.solventMobility()
+                    *(-trans/faceArea)
+                    *pressureDiffSolvent;
+            else
+                solventVolumeFlux =
+                    scalarValue(intQuantsEx.solventMobility())
+                    *(-trans/faceArea)
+                    *pressureDiffSolvent;
+        }
+    }
+
     /*!
      * \brief Assign the solvent specific primary variables to a PrimaryVariables object
      */
@@ -31,7 +31,9 @@
 
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
+#include <cstddef>
 #include <set>
 #include <vector>
 
@@ -102,6 +104,23 @@ public:
      */
     virtual void addNeighbors(std::vector<NeighborSet>& neighbors) const = 0;
 
+    /*!
+     * \brief Add the additional entries of the Jacobian matrix caused by the auxiliary
+     *        module to a sparsity pattern in CSR format.
+     *
+     * The default implementation calls addNeighbors() and appends the resulting
+     * entries. Modules which add many entries should overload this method and call
+     * Linear::SparsityPattern::appendEntry() directly.
+     */
+    virtual void addSparsityEntries(Linear::SparsityPattern& pattern) const
+    {
+        std::vector<NeighborSet> neighbors(pattern.numRows());
+        addNeighbors(neighbors);
+        for (std::size_t rowIdx = 0; rowIdx < neighbors.size(); ++rowIdx)
+            for (const auto colIdx : neighbors[rowIdx])
+                pattern.appendEntry(rowIdx, colIdx);
+    }
+
     /*!
      * \brief Set the initial condition of the auxiliary module in the solution vector.
      */
@@ -0,0 +1,318 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::DofOrdering
+ */
+#ifndef EWOMS_DOF_ORDERING_HH
+#define EWOMS_DOF_ORDERING_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Computes orderings of the degrees of freedom which improve the memory
+ *        locality of the linearization and of the linear solver.
+ *
+ * All orderings are returned as a vector which contains the new index of each
+ * degree of freedom, i.e., <tt>ordering[oldIdx] == newIdx</tt>. The connectivity of
+ * the degrees of freedom is specified in compressed row storage format: The
+ * neighbors of degree of freedom \c i are
+ * <tt>neighbors[rowOffsets[i]] ... neighbors[rowOffsets[i + 1] - 1]</tt>.
+ */
+class DofOrdering
+{
+public:
+    /*!
+     * \brief Returns the reverse Cuthill-McKee ordering of a graph.
+     *
+     * Each connected component is traversed in breadth-first order, starting at a
+     * pseudo-peripheral vertex and visiting the neighbors of each vertex by ascending
+     * degree. The resulting order is reversed.
+     */
+    static std::vector<unsigned> reverseCuthillMcKee(const std::vector<std::size_t>& rowOffsets,
+                                                     const std::vector<unsigned>& neighbors)
+    {
+        assert(!rowOffsets.empty());
+        const std::size_t n = rowOffsets.size() - 1;
+        const auto degree = [&rowOffsets](unsigned i)
+        { return rowOffsets[i + 1] - rowOffsets[i]; };
+
+        std::vector<unsigned> order;
+        order.reserve(n);
+        std::vector<bool> visited(n, false);
+        std::vector<unsigned> level(n, std::numeric_limits<unsigned>::max());
+        std::vector<unsigned> candidates;
+
+        // consider the start vertices of the connected components by ascending degree
+        std::vector<unsigned> byDegree(n);
+        std::iota(byDegree.begin(), byDegree.end(), 0u);
+        std::stable_sort(byDegree.begin(), byDegree.end(),
+                         [&degree](unsigned a, unsigned b)
+                         { return degree(a) < degree(b); });
+
+        for (unsigned seed : byDegree) {
+            if (visited[seed])
+                continue;
+
+            const unsigned root = findPseudoPeripheral_(rowOffsets, neighbors, seed, level);
+
+            // breadth-first search of the component
+            const std::size_t componentBegin = order.size();
+            order.push_back(root);
+            visited[root] = true;
+            for (std::size_t pos = componentBegin; pos < order.size(); ++pos) {
+                const unsigned i = order[pos];
+                candidates.clear();
+                for (std::size_t k = rowOffsets[i]; k < rowOffsets[i + 1]; ++k) {
+                    const unsigned j = neighbors[k];
+                    if (!visited[j]) {
+                        visited[j] = true;
+                        candidates.push_back(j);
+                    }
+                }
+
+                std::sort(candidates.begin(), candidates.end(),
+                          [&degree](unsigned a, unsigned b)
+                          { return degree(a) < degree(b) || (degree(a) == degree(b) && a < b); });
+                order.insert(order.end(), candidates.begin(), candidates.end());
+            }
+        }
+
+        std::vector<unsigned> result(n);
+        for (std::size_t pos = 0; pos < n; ++pos)
+            result[order[pos]] = static_cast<unsigned>(n - 1 - pos);
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the ordering of a set of points along a Hilbert space filling
+     *        curve.
+     *
+     * The coordinates are shifted to the bounding box of the points, scaled by its
+     * largest extent and quantized to <tt>63/dim</tt> bits per axis. All axes use the
+     * same scale, so the curve is not distorted for elongated domains like thin
+     * reservoir layers.
+     */
+    template <std::size_t dim>
+    static std::vector<unsigned> hilbertCurve(const std::vector<std::array<double, dim> >& points)
+    {
+        static_assert(dim > 0 && dim <= 63, "Unsupported number of dimensions");
+        constexpr unsigned numBits = 63/dim;
+
+        std::array<double, dim> minCoord;
+        std::array<double, dim> maxCoord;
+        minCoord.fill(std::numeric_limits<double>::max());
+        maxCoord.fill(-std::numeric_limits<double>::max());
+        for (const auto& point : points) {
+            for (std::size_t axisIdx = 0; axisIdx < dim; ++axisIdx) {
+                minCoord[axisIdx] = std::min(minCoord[axisIdx], point[axisIdx]);
+                maxCoord[axisIdx] = std::max(maxCoord[axisIdx], point[axisIdx]);
+            }
+        }
+
+        double maxExtent = 0.0;
+        for (std::size_t axisIdx = 0; axisIdx < dim; ++axisIdx)
+            maxExtent = std::max(maxExtent, maxCoord[axisIdx] - minCoord[axisIdx]);
+
+        const double maxCell = static_cast<double>((std::uint64_t(1) << numBits) - 1);
+        std::vector<std::pair<std::uint64_t, unsigned> > keys(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            std::array<std::uint64_t, dim> x;
+            for (std::size_t axisIdx = 0; axisIdx < dim; ++axisIdx) {
+                const double rel =
+                    maxExtent > 0.0 ? (points[i][axisIdx] - minCoord[axisIdx])/maxExtent : 0.0;
+                x[axisIdx] = static_cast<std::uint64_t>(std::round(rel*maxCell));
+            }
+            keys[i] = std::make_pair(hilbertKey_<dim>(x, numBits), static_cast<unsigned>(i));
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<unsigned> result(points.size());
+        for (std::size_t pos = 0; pos < keys.size(); ++pos)
+            result[keys[pos].second] = static_cast<unsigned>(pos);
+
+        return result;
+    }
+
+    /*!
+     * \brief Returns the bandwidth of a graph, i.e., the maximum index distance of
+     *        two neighbors.
+     *
+     * If \c ordering is not empty, the distances are computed for the reordered
+     * indices.
+     */
+    static std::size_t bandwidth(const std::vector<std::size_t>& rowOffsets,
+                                 const std::vector<unsigned>& neighbors,
+                                 const std::vector<unsigned>& ordering = {})
+    {
+        std::size_t result = 0;
+        forEachDistance_(rowOffsets, neighbors, ordering,
+                         [&result](std::size_t dist)
+                         { result = std::max(result, dist); });
+        return result;
+    }
+
+    /*!
+     * \brief Returns the average index distance of two neighbors.
+     *
+     * If \c ordering is not empty, the distances are computed for the reordered
+     * indices.
+     */
+    static double averageNeighborDistance(const std::vector<std::size_t>& rowOffsets,
+                                          const std::vector<unsigned>& neighbors,
+                                          const std::vector<unsigned>& ordering = {})
+    {
+        double sum = 0.0;
+        forEachDistance_(rowOffsets, neighbors, ordering,
+                         [&sum](std::size_t dist)
+                         { sum += static_cast<double>(dist); });
+        return neighbors.empty() ? 0.0 : sum/static_cast<double>(neighbors.size());
+    }
+
+private:
+    template <class Fn>
+    static void forEachDistance_(const std::vector<std::size_t>& rowOffsets,
+                                 const std::vector<unsigned>& neighbors,
+                                 const std::vector<unsigned>& ordering,
+                                 Fn fn)
+    {
+        const auto newIdx = [&ordering](unsigned i)
+        { return ordering.empty() ? i : ordering[i]; };
+
+        for (std::size_t i = 0; i + 1 < rowOffsets.size(); ++i) {
+            const unsigned rowIdx = newIdx(static_cast<unsigned>(i));
+            for (std::size_t k = rowOffsets[i]; k < rowOffsets[i + 1]; ++k) {
+                const unsigned colIdx = newIdx(neighbors[k]);
+                fn(rowIdx > colIdx ? rowIdx - colIdx : colIdx - rowIdx);
+            }
+        }
+    }
+
+    // find a vertex of the connected component of 'seed' whose eccentricity is
+    // (approximately) maximal using repeated level structures. all entries of 'level'
+    // must be unset on entry and they are reset before returning.
+    static unsigned findPseudoPeripheral_(const std::vector<std::size_t>& rowOffsets,
+                                          const std::vector<unsigned>& neighbors,
+                                          unsigned seed,
+                                          std::vector<unsigned>& level)
+    {
+        const unsigned unvisited = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> queue;
+
+        unsigned root = seed;
+        unsigned eccentricity = 0;
+        for (int iterIdx = 0; iterIdx < 8; ++iterIdx) {
+            // breadth-first search from the current root
+            queue.clear();
+            queue.push_back(root);
+            level[root] = 0;
+            for (std::size_t pos = 0; pos < queue.size(); ++pos) {
+                const unsigned i = queue[pos];
+                for (std::size_t k = rowOffsets[i]; k < rowOffsets[i + 1]; ++k) {
+                    const unsigned j = neighbors[k];
+                    if (level[j] != unvisited)
+                        continue;
+                    level[j] = level[i] + 1;
+                    queue.push_back(j);
+                }
+            }
+
+            // choose the vertex of minimum degree on the last level
+            const unsigned lastLevel = level[queue.back()];
+            unsigned candidate = queue.back();
+            for (auto it = queue.rbegin(); it != queue.rend() && level[*it] == lastLevel; ++it) {
+                const auto deg = rowOffsets[*it + 1] - rowOffsets[*it];
+                if (deg < rowOffsets[candidate + 1] - rowOffsets[candidate])
+                    candidate = *it;
+            }
+
+            for (unsigned i : queue)
+                level[i] = unvisited;
+
+            if (iterIdx > 0 && lastLevel <= eccentricity)
+                break;
+
+            eccentricity = lastLevel;
+            root = candidate;
+        }
+
+        return root;
+    }
+
+    // compute the position of a point on the Hilbert curve. This uses the algorithm
+    // of J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004).
+    template <std::size_t dim>
+    static std::uint64_t hilbertKey_(std::array<std::uint64_t, dim> x, unsigned numBits)
+    {
+        const std::uint64_t m = std::uint64_t(1) << (numBits - 1);
+
+        // inverse undo
+        for (std::uint64_t q = m; q > 1; q >>= 1) {
+            const std::uint64_t p = q - 1;
+            for (std::size_t i = 0; i < dim; ++i) {
+                if (x[i] & q)
+                    x[0] ^= p;
+                else {
+                    const std::uint64_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+
+        // gray encode
+        for (std::size_t i = 1; i < dim; ++i)
+            x[i] ^= x[i - 1];
+        std::uint64_t t = 0;
+        for (std::uint64_t q = m; q > 1; q >>= 1)
+            if (x[dim - 1] & q)
+                t ^= q - 1;
+        for (std::size_t i = 0; i < dim; ++i)
+            x[i] ^= t;
+
+        // interleave the bits of the transposed representation
+        std::uint64_t key = 0;
+        for (int bitIdx = static_cast<int>(numBits) - 1; bitIdx >= 0; --bitIdx)
+            for (std::size_t i = 0; i < dim; ++i)
+                key = (key << 1) | ((x[i] >> bitIdx) & 1);
+
+        return key;
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -33,6 +33,8 @@
 #include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Valgrind.hpp>
 
+#include <opm/models/utils/instrumentation.hh>
+
 #include <dune/istl/bvector.hh>
 #include <dune/istl/matrix.hh>
 
@@ -172,8 +174,14 @@ public:
      */
     void linearize(ElementContext& elemCtx, const Element& elem)
     {
+        const auto& newtonMethod = model_().newtonMethod();
+        auto& instrumentation = newtonMethod.instrumentation();
+        const auto& regions = newtonMethod.instrumentationRegions();
+
         elemCtx.updateStencil(elem);
+        Instrumentation::ScopedRegion intQuantsRegion(instrumentation, regions.intensiveQuantities);
         elemCtx.updateAllIntensiveQuantities();
+        intQuantsRegion.stop();
 
         // update the weights of the primary variables for the context
         model_().updatePVWeights(elemCtx);
@@ -185,7 +193,9 @@ public:
         unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned focusDofIdx = 0; focusDofIdx < numPrimaryDof; focusDofIdx++) {
             elemCtx.setFocusDofIndex(focusDofIdx);
+            Instrumentation::ScopedRegion extQuantsRegion(instrumentation, regions.flux);
             elemCtx.updateAllExtensiveQuantities();
+            extQuantsRegion.stop();
 
             // calculate the local residual
             localResidual_.eval(elemCtx);
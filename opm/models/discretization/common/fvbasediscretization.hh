@@ -45,12 +45,15 @@
 #include "fvbaseintensivequantities.hh"
 #include "fvbaseextensivequantities.hh"
 #include "baseauxiliarymodule.hh"
+#include "reorderedelementmapper.hh"
 
 #include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/instrumentation.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
@@ -65,13 +68,18 @@
 
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <list>
+#include <memory>
+#include <numeric>
 #include <stdexcept>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace Opm {
@@ -93,10 +101,11 @@ template<class TypeTag>
 struct VertexMapper<TypeTag, TTag::FvBaseDiscretization>
 { using type = Dune::MultipleCodimMultipleGeomTypeMapper<GetPropType<TypeTag, Properties::GridView>>; };
 
-//! Mapper for the grid view's elements.
+//! Mapper for the grid view's elements. The elements are numbered in the ordering
+//! provided by the vanguard.
 template<class TypeTag>
 struct ElementMapper<TypeTag, TTag::FvBaseDiscretization>
-{ using type = Dune::MultipleCodimMultipleGeomTypeMapper<GetPropType<TypeTag, Properties::GridView>>; };
+{ using type = ReorderedElementMapper<GetPropType<TypeTag, Properties::GridView>>; };
 
 //! marks the border indices (required for the algebraic overlap stuff)
 template<class TypeTag>
@@ -279,6 +288,14 @@ template<class TypeTag>
 struct ThreadsPerProcess<TypeTag, Properties::TTag::FvBaseDiscretization>
 { static constexpr int value = 1; };
 
+template<class TypeTag>
+struct ThreadedIteratorChunkSize<TypeTag, Properties::TTag::FvBaseDiscretization>
+{ static constexpr unsigned value = 16; };
+
+template<class TypeTag>
+struct ThreadedIteratorGuidedSchedule<TypeTag, Properties::TTag::FvBaseDiscretization>
+{ static constexpr bool value = false; };
+
 //! Disable grid adaptation by default
 template<class TypeTag>
 struct EnableGridAdaptation<TypeTag, Properties::TTag::FvBaseDiscretization>
@@ -301,6 +318,16 @@ template<class TypeTag>
 struct EnableAsyncVtkOutput<TypeTag, Properties::TTag::FvBaseDiscretization>
 { static constexpr bool value = true; };
 
+//! By default, use Dune's VTK writer
+template<class TypeTag>
+struct VtkBinaryOutput<TypeTag, Properties::TTag::FvBaseDiscretization>
+{ static constexpr auto value = "none"; };
+
+//! By default, the binary VTK output is written in double precision
+template<class TypeTag>
+struct VtkBinaryOutputSinglePrecision<TypeTag, Properties::TTag::FvBaseDiscretization>
+{ static constexpr bool value = false; };
+
 //! use an unlimited time step size by default
 template<class TypeTag>
 struct MaxTimeStepSize<TypeTag, Properties::TTag::FvBaseDiscretization>
@@ -349,6 +376,11 @@ template<class TypeTag>
 struct EnableThermodynamicHints<TypeTag, Properties::TTag::FvBaseDiscretization>
 { static constexpr bool value = false; };
 
+// assemble groups of elements which do not share any degree of freedom concurrently
+template<class TypeTag>
+struct ElementAssemblyStrategy<TypeTag, Properties::TTag::FvBaseDiscretization>
+{ static constexpr auto value = "coloring"; };
+
 } // namespace Opm::Parameters
 
 namespace Opm {
@@ -401,6 +433,7 @@ class FvBaseDiscretization
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Toolbox = MathToolbox<Evaluation>;
     using VectorBlock = Dune::FieldVector<Evaluation, numEq>;
@@ -449,6 +482,15 @@ public:
     };
 
 private:
+    // linearizers for two-point flux approximations can evaluate the residual cell by
+    // cell without using element contexts
+    template <class L, class = void>
+    struct HasCellwiseResidual_ : std::false_type {};
+
+    template <class L>
+    struct HasCellwiseResidual_<L, std::void_t<decltype(std::declval<L&>().evalResidual(std::declval<GlobalEqVector&>()))>>
+        : std::true_type {};
+
     using DiscreteFunctionSpace = GetPropType<TypeTag, Properties::DiscreteFunctionSpace>;
     using DiscreteFunction = GetPropType<TypeTag, Properties::DiscreteFunction>;
 
@@ -478,10 +520,16 @@ public:
                                         "element-centered finite volume discretization (is: "
                                         +Dune::className<Discretization>()+")");
 
+        elementMapper_.setOrdering(simulator.vanguard().elementOrdering());
+        if (enableGridAdaptation_ && elementMapper_.isReordered())
+            throw std::invalid_argument("Grid adaptation cannot be combined with reordering "
+                                        "the elements");
+
         enableStorageCache_ = Parameters::get<TypeTag, Parameters::EnableStorageCache>();
 
         PrimaryVariables::init();
         size_t numDof = asImp_().numGridDof();
+        std::iota(intensiveQuantityCacheSlot_.begin(), intensiveQuantityCacheSlot_.end(), 0u);
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             if (storeIntensiveQuantities()) {
                 intensiveQuantityCache_[timeIdx].resize(numDof);
@@ -598,6 +646,7 @@ public:
             localLinearizer_[threadId].init(simulator_);
 
         resizeAndResetIntensiveQuantitiesCache_();
+        asImp_().prepareIntensiveQuantityMirror_(/*timeIdx=*/0);
         if (storeIntensiveQuantities()) {
             // invalidate all cached intensive quantities
             for (unsigned timeIdx = 0; timeIdx < historySize; ++ timeIdx)
@@ -667,6 +716,16 @@ public:
 #endif // NDEBUG
     }
 
+    /*!
+     * \brief Prepare the stencil object of a newly created element context.
+     *
+     * This allows discretizations to attach data which is shared by all stencils. By
+     * default, nothing is done.
+     */
+    template <class StencilType>
+    void initStencil(StencilType&) const
+    { }
+
     /*!
      * \brief Allows to improve the performance by prefetching all data which is
      *        associated with a given element.
@@ -725,20 +784,27 @@ public:
      */
     const IntensiveQuantities* cachedIntensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableIntensiveQuantityCache_ || !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx]) {
+        if (!enableIntensiveQuantityCache_)
             return nullptr;
-        }
+
+        const unsigned slotIdx = cacheSlot_(timeIdx);
+        const unsigned char state = intensiveQuantityCacheUpToDate_[slotIdx][globalIdx];
+        if (state == cacheEntryInvalid)
+            return nullptr;
+        else if (state == cacheEntryAliased)
+            // the entry is identical to the one of the next older time level
+            return &intensiveQuantityCache_[cacheSlot_(timeIdx + 1)][globalIdx];
 
         // With the storage cache enabled, usually only the
         // intensive quantities for the most recent time step are
         // cached. However, this may be false for some Problem
         // variants, so we should check if the cache exists for
         // the timeIdx in question.
-        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[timeIdx].empty()) {
+        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[slotIdx].empty()) {
             return nullptr;
         }
 
-        return &intensiveQuantityCache_[timeIdx][globalIdx];
+        return &intensiveQuantityCache_[slotIdx][globalIdx];
     }
 
     /*!
@@ -756,8 +822,14 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = 1;
+        if (timeIdx == 1)
+            resolveCacheAlias_(globalIdx);
+
+        const unsigned slotIdx = cacheSlot_(timeIdx);
+        intensiveQuantityCache_[slotIdx][globalIdx] = intQuants;
+        intensiveQuantityCacheUpToDate_[slotIdx][globalIdx] = cacheEntryValid;
+
+        asImp_().updateIntensiveQuantityMirror_(globalIdx, intQuants, timeIdx);
     }
 
     /*!
@@ -774,7 +846,14 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue ? 1 : 0;
+        if (timeIdx == 1 && !newValue)
+            resolveCacheAlias_(globalIdx);
+
+        unsigned char& state = intensiveQuantityCacheUpToDate_[cacheSlot_(timeIdx)][globalIdx];
+        if (!newValue)
+            state = cacheEntryInvalid;
+        else if (state == cacheEntryInvalid)
+            state = cacheEntryValid;
     }
 
     /*!
@@ -785,18 +864,24 @@ public:
     void invalidateIntensiveQuantitiesCache(unsigned timeIdx) const
     {
         if (storeIntensiveQuantities()) {
-            std::fill(intensiveQuantityCacheUpToDate_[timeIdx].begin(),
-                      intensiveQuantityCacheUpToDate_[timeIdx].end(),
-                      /*value=*/0);
+            if (timeIdx == 1)
+                resolveCacheAliases_();
+
+            auto& upToDate = intensiveQuantityCacheUpToDate_[cacheSlot_(timeIdx)];
+            std::fill(upToDate.begin(), upToDate.end(), /*value=*/cacheEntryInvalid);
         }
     }
 
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
     {
         invalidateIntensiveQuantitiesCache(timeIdx);
+        asImp_().prepareIntensiveQuantityMirror_(timeIdx);
+
+        auto& instrumentation = newtonMethod().instrumentation();
+        const unsigned intQuantsRegionIdx = newtonMethod().instrumentationRegions().intensiveQuantities;
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -805,6 +890,7 @@ public:
             ElementIterator elemIt = threadedElemIt.beginParallel();
             for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
                 const Element& elem = *elemIt;
+                Instrumentation::ScopedRegion intQuantsRegion(instrumentation, intQuantsRegionIdx);
                 elemCtx.updatePrimaryStencil(elem);
                 elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
             }
@@ -814,6 +900,9 @@ public:
     template <class GridViewType>
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx, const GridViewType& gridView) const
     {
+        auto& instrumentation = newtonMethod().instrumentation();
+        const unsigned intQuantsRegionIdx = newtonMethod().instrumentationRegions().intensiveQuantities;
+
         // loop over all elements...
         ThreadedEntityIterator<GridViewType, /*codim=*/0> threadedElemIt(gridView);
 #ifdef _OPENMP
@@ -828,6 +917,7 @@ public:
                     continue;
                 }
                 const Element& elem = *elemIt;
+                Instrumentation::ScopedRegion intQuantsRegion(instrumentation, intQuantsRegionIdx);
                 elemCtx.updatePrimaryStencil(elem);
                 // Mark cache for this element as invalid.
                 const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
@@ -866,14 +956,37 @@ public:
 
         assert(numSlots > 0);
 
-        for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
-            intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
-            intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
+        // entries of the most recent time index which refer to the next older one must
+        // own their data before the older time index is overwritten
+        resolveCacheAliases_();
+
+        if (numSlots > 1) {
+            for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
+                const unsigned srcSlotIdx = cacheSlot_(timeIdx);
+                const unsigned destSlotIdx = cacheSlot_(timeIdx + numSlots);
+                intensiveQuantityCache_[destSlotIdx] = intensiveQuantityCache_[srcSlotIdx];
+                intensiveQuantityCacheUpToDate_[destSlotIdx] = intensiveQuantityCacheUpToDate_[srcSlotIdx];
+            }
+            return;
         }
 
-        // the cache for the most recent time indices do not need to be invalidated
-        // because the solution for them did not change (TODO: that assumes that there is
-        // no post-processing of the solution after a time step! fix it?)
+        // rotate the slots instead of copying the intensive quantities: the objects of
+        // the most recent time index become the ones of the next older time index and
+        // the storage of the oldest time index is recycled for the most recent one.
+        std::rotate(intensiveQuantityCacheSlot_.rbegin(),
+                    intensiveQuantityCacheSlot_.rbegin() + 1,
+                    intensiveQuantityCacheSlot_.rend());
+
+        // the cache for the most recent time index does not need to be invalidated
+        // because the solution for it did not change (TODO: that assumes that there is
+        // no post-processing of the solution after a time step! fix it?). Its valid
+        // entries thus simply refer to the ones of the previous time index until they
+        // are updated.
+        auto& curUpToDate = intensiveQuantityCacheUpToDate_[cacheSlot_(/*timeIdx=*/0)];
+        const auto& prevUpToDate = intensiveQuantityCacheUpToDate_[cacheSlot_(/*timeIdx=*/1)];
+        std::transform(prevUpToDate.begin(), prevUpToDate.end(), curUpToDate.begin(),
+                       [](unsigned char state)
+                       { return state == cacheEntryInvalid ? cacheEntryInvalid : cacheEntryAliased; });
     }
 
     /*!
@@ -939,8 +1052,11 @@ public:
     {
         SolutionVector tmp(asImp_().solution(/*timeIdx=*/0));
         mutableSolution(/*timeIdx=*/0) = u;
-        Scalar res = asImp_().globalResidual(dest);
+        // the cached intensive quantities do not correspond to u, so they are neither
+        // used nor updated
+        Scalar res = globalResidual_(dest, /*solutionIsCached=*/false);
         mutableSolution(/*timeIdx=*/0) = tmp;
+
         return res;
     }
 
@@ -951,59 +1067,7 @@ public:
      * \param dest Stores the result
      */
     Scalar globalResidual(GlobalEqVector& dest) const
-    {
-        dest = 0;
-
-        std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-        {
-            // Attention: the variables below are thread specific and thus cannot be
-            // moved in front of the #pragma!
-            unsigned threadId = ThreadManager::threadId();
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            LocalEvalBlockVector residual, storageTerm;
-
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
-
-                elemCtx.updateAll(elem);
-                residual.resize(elemCtx.numDof(/*timeIdx=*/0));
-                storageTerm.resize(elemCtx.numPrimaryDof(/*timeIdx=*/0));
-                asImp_().localResidual(threadId).eval(residual, elemCtx);
-
-                size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
-                mutex.lock();
-                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
-                    unsigned globalI = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                        dest[globalI][eqIdx] += Toolbox::value(residual[dofIdx][eqIdx]);
-                }
-                mutex.unlock();
-            }
-        }
-
-        // add up the residuals on the process borders
-        const auto sumHandle =
-            GridCommHandleFactory::template sumHandle<EqVector>(dest, asImp_().dofMapper());
-        gridView_.communicate(*sumHandle,
-                              Dune::InteriorBorder_InteriorBorder_Interface,
-                              Dune::ForwardCommunication);
-
-        // calculate the square norm of the residual. this is not
-        // entirely correct, since the residual for the finite volumes
-        // which are on the boundary are counted once for every
-        // process. As often in life: shit happens (, we don't care)...
-        Scalar result2 = dest.two_norm2();
-        result2 = asImp_().gridView().comm().sum(result2);
-
-        return std::sqrt(result2);
-    }
+    { return globalResidual_(dest, /*solutionIsCached=*/true); }
 
     /*!
      * \brief Compute the integral over the domain of the storage
@@ -1013,45 +1077,36 @@ public:
      */
     void globalStorage(EqVector& storage, unsigned timeIdx = 0) const
     {
-        storage = 0;
-
-        std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
+        // the storage of each chunk of elements is summed up separately. the partial
+        // sums are added in a fixed order, so the result does not depend on the
+        // scheduling of the threads.
+        const unsigned numChunks = ThreadManager::maxThreads();
+        std::vector<EqVector> chunkStorage(numChunks, EqVector(0.0));
+
+        std::vector<LocalEvalBlockVector> elemStorage(numChunks);
+        forEachInteriorElementChunk_(numChunks,
+                                     [&](unsigned chunkIdx, ElementContext& elemCtx, const Element& elem)
         {
-            // Attention: the variables below are thread specific and thus cannot be
-            // moved in front of the #pragma!
-            unsigned threadId = ThreadManager::threadId();
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            LocalEvalBlockVector elemStorage;
-
             // in this method, we need to disable the storage cache because we want to
             // evaluate the storage term for other time indices than the most recent one
             elemCtx.setEnableStorageCache(false);
+            elemCtx.updateStencil(elem);
+            elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
 
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue; // ignore ghost and overlap elements
-
-                elemCtx.updateStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+            size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
+            auto& chunkElemStorage = elemStorage[chunkIdx];
+            chunkElemStorage.resize(numPrimaryDof);
 
-                size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
-                elemStorage.resize(numPrimaryDof);
+            localResidual(ThreadManager::threadId()).evalStorage(chunkElemStorage, elemCtx, timeIdx);
 
-                localResidual(threadId).evalStorage(elemStorage, elemCtx, timeIdx);
+            for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    chunkStorage[chunkIdx][eqIdx] += Toolbox::value(chunkElemStorage[dofIdx][eqIdx]);
+        });
 
-                mutex.lock();
-                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                        storage[eqIdx] += Toolbox::value(elemStorage[dofIdx][eqIdx]);
-                mutex.unlock();
-            }
-        }
+        storage = 0;
+        for (const auto& partialStorage : chunkStorage)
+            storage += partialStorage;
 
         storage = gridView_.comm().sum(storage);
     }
@@ -1089,16 +1144,18 @@ public:
         EqVector storageEndTimeStep(0.0);
         globalStorage(storageEndTimeStep, /*timeIdx=*/0);
 
-        // calculate the rate at the boundary and the source rate
-        ElementContext elemCtx(simulator_);
-        elemCtx.setEnableStorageCache(false);
-        auto eIt = simulator_.gridView().template begin</*codim=*/0>();
-        const auto& elemEndIt = simulator_.gridView().template end</*codim=*/0>();
-        for (; eIt != elemEndIt; ++eIt) {
-            if (eIt->partitionType() != Dune::InteriorEntity)
-                continue; // ignore ghost and overlap elements
+        // calculate the rate at the boundary and the source rate. the contributions of
+        // each chunk of elements are summed up separately and added in a fixed order.
+        const unsigned numChunks = ThreadManager::maxThreads();
+        std::vector<Scalar> chunkBoundaryArea(numChunks, 0.0);
+        std::vector<Scalar> chunkVolume(numChunks, 0.0);
+        std::vector<EvalEqVector> chunkRate(numChunks, EvalEqVector(0.0));
 
-            elemCtx.updateAll(*eIt);
+        forEachInteriorElementChunk_(numChunks,
+                                     [&](unsigned chunkIdx, ElementContext& elemCtx, const Element& elem)
+        {
+            elemCtx.setEnableStorageCache(false);
+            elemCtx.updateAll(elem);
 
             // handle the boundary terms
             if (elemCtx.onBoundary()) {
@@ -1107,9 +1164,9 @@ public:
                 for (unsigned faceIdx = 0; faceIdx < boundaryCtx.numBoundaryFaces(/*timeIdx=*/0); ++faceIdx) {
                     BoundaryRateVector values;
                     simulator_.problem().boundary(values,
-                                                         boundaryCtx,
-                                                         faceIdx,
-                                                         /*timeIdx=*/0);
+                                                  boundaryCtx,
+                                                  faceIdx,
+                                                  /*timeIdx=*/0);
                     Valgrind::CheckDefined(values);
 
                     unsigned dofIdx = boundaryCtx.interiorScvIndex(faceIdx, /*timeIdx=*/0);
@@ -1122,9 +1179,9 @@ public:
                     for (unsigned i = 0; i < values.size(); ++i)
                         values[i] *= bfArea;
 
-                    totalBoundaryArea += bfArea;
+                    chunkBoundaryArea[chunkIdx] += bfArea;
                     for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                        totalRate[eqIdx] += values[eqIdx];
+                        chunkRate[chunkIdx][eqIdx] += values[eqIdx];
                 }
             }
 
@@ -1142,9 +1199,15 @@ public:
                     elemCtx.dofVolume(dofIdx, /*timeIdx=*/0)
                     * intQuants.extrusionFactor();
                 for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                    totalRate[eqIdx] += -dofVolume*Toolbox::value(values[eqIdx]);
-                totalVolume += dofVolume;
+                    chunkRate[chunkIdx][eqIdx] += -dofVolume*Toolbox::value(values[eqIdx]);
+                chunkVolume[chunkIdx] += dofVolume;
             }
+        });
+
+        for (unsigned chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+            totalBoundaryArea += chunkBoundaryArea[chunkIdx];
+            totalVolume += chunkVolume[chunkIdx];
+            totalRate += chunkRate[chunkIdx];
         }
 
         // summarize everything over all processes
@@ -1463,11 +1526,15 @@ public:
             asImp_().adaptGrid();
         }
 
-        // make the current solution the previous one.
+        // make the current solution the previous one. Note that this copy cannot be
+        // avoided by swapping the solution objects because the solution of the next
+        // time step is computed in place starting from the current one and some
+        // objects (e.g., the restriction/prolongation operator for grid adaptation)
+        // are bound to the solution object of the most recent time index.
         solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
 
         // shift the intensive quantities cache by one position in the
-        // history
+        // history. This does not copy any intensive quantities.
         asImp_().shiftIntensiveQuantityCache(/*numSlots=*/1);
     }
 
@@ -1546,6 +1613,106 @@ public:
         }
     }
 
+    /*!
+     * \brief Write the current solution of all degrees of freedom of the grid to a
+     *        restart file at once.
+     *
+     * This is used by binary restart files. Besides the values of the primary
+     * variables, the per-DOF flags reported by serializeDofFlags() are written. Since
+     * the values are stored by index, a fingerprint of the element numbering is
+     * written as well.
+     *
+     * \param res The serializer object
+     */
+    template <class Restarter>
+    void serializeBulk(Restarter& res)
+    {
+        const std::uint64_t orderingFingerprint = elementOrderingFingerprint_();
+        res.serializeBlock(&orderingFingerprint, 1);
+
+        const auto& sol = solution(/*timeIdx=*/0);
+        const int numDof = asImp_().numGridDof();
+        std::vector<Scalar> values(static_cast<std::size_t>(numDof)*numEq);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                values[dofIdx*numEq + eqIdx] = sol[dofIdx][eqIdx];
+        res.serializeBlock(values.data(), values.size());
+
+        const unsigned numFlags = asImp_().numSerializedDofFlags();
+        if (numFlags > 0) {
+            std::vector<int> flags(static_cast<std::size_t>(numDof)*numFlags);
+            for (int dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                asImp_().serializeDofFlags(dofIdx, flags.data() + dofIdx*numFlags);
+            res.serializeBlock(flags.data(), flags.size());
+        }
+    }
+
+    /*!
+     * \brief Read the current solution of all degrees of freedom of the grid from a
+     *        restart file at once.
+     *
+     * This is the counterpart of serializeBulk().
+     *
+     * \param res The deserializer object
+     */
+    template <class Restarter>
+    void deserializeBulk(Restarter& res)
+    {
+        std::uint64_t orderingFingerprint;
+        res.deserializeBlock(&orderingFingerprint, 1);
+        if (orderingFingerprint != elementOrderingFingerprint_())
+            throw std::runtime_error("The restart file was written using a different "
+                                     "numbering of the elements. Use the same "
+                                     "ElementOrdering as for the run which wrote it");
+
+        auto& sol = solution(/*timeIdx=*/0);
+        const int numDof = asImp_().numGridDof();
+        std::vector<Scalar> values(static_cast<std::size_t>(numDof)*numEq);
+        res.deserializeBlock(values.data(), values.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                sol[dofIdx][eqIdx] = values[dofIdx*numEq + eqIdx];
+
+        const unsigned numFlags = asImp_().numSerializedDofFlags();
+        if (numFlags > 0) {
+            std::vector<int> flags(static_cast<std::size_t>(numDof)*numFlags);
+            res.deserializeBlock(flags.data(), flags.size());
+            for (int dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                asImp_().deserializeDofFlags(dofIdx, flags.data() + dofIdx*numFlags);
+        }
+    }
+
+    /*!
+     * \brief Returns the number of integer flags which are required to describe the
+     *        state of a degree of freedom in addition to its primary variables.
+     *
+     * Models which need to store additional state in restart files (e.g. the phase
+     * presence) must overload this method and the serializeDofFlags() and
+     * deserializeDofFlags() methods.
+     */
+    unsigned numSerializedDofFlags() const
+    { return 0; }
+
+    /*!
+     * \brief Store the additional state of a degree of freedom in an array of
+     *        numSerializedDofFlags() integers.
+     */
+    void serializeDofFlags(unsigned, int*) const
+    { }
+
+    /*!
+     * \brief Restore the additional state of a degree of freedom from an array of
+     *        numSerializedDofFlags() integers.
+     */
+    void deserializeDofFlags(unsigned, const int*)
+    { }
+
     /*!
      * \brief Returns the number of degrees of freedom (DOFs) for the computational grid
      */
@@ -1755,7 +1922,7 @@ public:
         }
 
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1803,6 +1970,28 @@ public:
     const GridView& gridView() const
     { return gridView_; }
 
+    /*!
+     * \brief Returns the chunks of elements of the grid view which are handed out to
+     *        the threads by ThreadedEntityIterator.
+     *
+     * The chunks are only determined again if the grid or the default chunk size has
+     * changed. This method must be called in a sequential context.
+     */
+    const ThreadedEntityChunks<GridView, /*codim=*/0>& elementChunks() const
+    {
+        const int sequenceNumber = simulator_.vanguard().gridSequenceNumber();
+        const unsigned chunkSize = ThreadedEntityIteratorSchedule::defaultChunkSize();
+        if (!elementChunks_
+            || sequenceNumber != elementChunksSequenceNumber_
+            || elementChunks_->chunkSize() != chunkSize)
+        {
+            elementChunks_ = std::make_unique<ThreadedEntityChunks<GridView, /*codim=*/0>>(gridView_, chunkSize);
+            elementChunksSequenceNumber_ = sequenceNumber;
+        }
+
+        return *elementChunks_;
+    }
+
     /*!
      * \brief Add a module for an auxiliary equation.
      *
@@ -1901,6 +2090,197 @@ public:
     }
 
 protected:
+    /*!
+     * \brief Visit the interior elements of the grid view in a given number of chunks
+     *        which are processed concurrently.
+     *
+     * The chunks are contiguous ranges of the element iteration order, so the
+     * elements of each chunk do not depend on the scheduling of the threads. \c fn
+     * is called for each interior element with the index of its chunk and an element
+     * context which is used exclusively by the chunk.
+     */
+    template <class Fn>
+    void forEachInteriorElementChunk_(unsigned numChunks, Fn&& fn) const
+    {
+        const auto& seeds = interiorElementSeeds_();
+        const auto& grid = gridView_.grid();
+        const std::size_t numElements = seeds.size();
+        const long numChunksSigned = static_cast<long>(numChunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (long i = 0; i < numChunksSigned; ++i) {
+            const auto chunkIdx = static_cast<unsigned>(i);
+            const std::size_t chunkBegin = numElements*chunkIdx/numChunks;
+            const std::size_t chunkEnd = numElements*(chunkIdx + 1)/numChunks;
+            if (chunkBegin == chunkEnd)
+                continue;
+
+            ElementContext elemCtx(simulator_);
+            for (std::size_t elemIdx = chunkBegin; elemIdx < chunkEnd; ++elemIdx) {
+                const Element elem = grid.entity(seeds[elemIdx]);
+                fn(chunkIdx, elemCtx, elem);
+            }
+        }
+    }
+
+    // returns the seeds of the interior elements in the iteration order of the grid
+    // view. they allow each chunk to start at its first element without iterating
+    // over the elements of the preceding chunks. the seeds are only determined again
+    // if the grid has changed.
+    const std::vector<ElementSeed>& interiorElementSeeds_() const
+    {
+        const int sequenceNumber = simulator_.vanguard().gridSequenceNumber();
+        if (sequenceNumber != interiorElementSeedCacheSequenceNumber_) {
+            interiorElementSeedCache_.clear();
+            for (const auto& elem : elements(gridView_, Dune::Partitions::interior))
+                interiorElementSeedCache_.push_back(elem.seed());
+            interiorElementSeedCacheSequenceNumber_ = sequenceNumber;
+        }
+
+        return interiorElementSeedCache_;
+    }
+
+    // compute the global residual for the current solution. solutionIsCached specifies
+    // whether the intensive quantities cached for time index 0 may belong to it.
+    Scalar globalResidual_(GlobalEqVector& dest, bool solutionIsCached) const
+    {
+        if constexpr (HasCellwiseResidual_<Linearizer>::value)
+            globalResidualCellwise_(dest, solutionIsCached);
+        else
+            globalResidualElementwise_(dest, solutionIsCached);
+
+        // add up the residuals on the process borders
+        const auto sumHandle =
+            GridCommHandleFactory::template sumHandle<EqVector>(dest, asImp_().dofMapper());
+        gridView_.communicate(*sumHandle,
+                              Dune::InteriorBorder_InteriorBorder_Interface,
+                              Dune::ForwardCommunication);
+
+        // calculate the square norm of the residual. this is not
+        // entirely correct, since the residual for the finite volumes
+        // which are on the boundary are counted once for every
+        // process. As often in life: shit happens (, we don't care)...
+        Scalar result2 = dest.two_norm2();
+        result2 = asImp_().gridView().comm().sum(result2);
+
+        return std::sqrt(result2);
+    }
+
+    // evaluate the residual using the element contexts and the local residual. this
+    // works for all discretizations.
+    void globalResidualElementwise_(GlobalEqVector& dest, bool solutionIsCached) const
+    {
+        dest = 0;
+
+        // if the elements do not share any primary degrees of freedom, their
+        // residuals can be written to the result directly. otherwise, the
+        // contributions of each chunk of elements are recorded, bucketed by the chunk
+        // which owns the rows, and added up in the order of the elements afterwards.
+        constexpr bool sharedDofs = getPropValue<TypeTag, Properties::UseLinearizationLock>();
+        const unsigned numChunks = ThreadManager::maxThreads();
+        const std::size_t numRows = dest.size();
+        std::vector<std::vector<std::vector<std::pair<unsigned, EqVector>>>> contributions;
+        if constexpr (sharedDofs)
+            contributions.assign(numChunks, std::vector<std::vector<std::pair<unsigned, EqVector>>>(numChunks));
+
+        std::vector<LocalEvalBlockVector> residual(numChunks);
+        forEachInteriorElementChunk_(numChunks,
+                                     [&](unsigned chunkIdx, ElementContext& elemCtx, const Element& elem)
+        {
+            auto& elemResidual = residual[chunkIdx];
+            elemCtx.setEnableIntensiveQuantityCache(solutionIsCached);
+            elemCtx.updateAll(elem);
+            elemResidual.resize(elemCtx.numDof(/*timeIdx=*/0));
+            asImp_().localResidual(ThreadManager::threadId()).eval(elemResidual, elemCtx);
+
+            size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                unsigned globalI = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                EqVector value;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                    value[eqIdx] = Toolbox::value(elemResidual[dofIdx][eqIdx]);
+
+                if constexpr (sharedDofs) {
+                    const std::size_t ownerIdx = static_cast<std::size_t>(globalI)*numChunks/numRows;
+                    contributions[chunkIdx][ownerIdx].emplace_back(globalI, value);
+                }
+                else
+                    dest[globalI] += value;
+            }
+        });
+
+        if constexpr (sharedDofs) {
+            const long numOwners = static_cast<long>(numChunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+            for (long i = 0; i < numOwners; ++i) {
+                const auto ownerIdx = static_cast<std::size_t>(i);
+                for (const auto& chunkContributions : contributions)
+                    for (const auto& [globalI, value] : chunkContributions[ownerIdx])
+                        dest[globalI] += value;
+            }
+        }
+    }
+
+    // evaluate the residual cell by cell using the neighbor information of a
+    // two-point flux linearizer. this avoids updating a full element context for each
+    // cell. the cached intensive quantities are used if all of them are up to date,
+    // otherwise the intensive quantities are evaluated into a separate buffer, i.e.,
+    // the cache is never modified.
+    void globalResidualCellwise_(GlobalEqVector& dest, bool solutionIsCached) const
+    {
+        const std::size_t numDof = asImp_().numGridDof();
+        bool cacheIsComplete = solutionIsCached;
+        for (std::size_t dofIdx = 0; cacheIsComplete && dofIdx < numDof; ++dofIdx)
+            cacheIsComplete = cachedIntensiveQuantities(static_cast<unsigned>(dofIdx), /*timeIdx=*/0) != nullptr;
+
+        if (cacheIsComplete)
+            linearizer_->evalResidual(dest);
+        else {
+            IntensiveQuantitiesVector intQuants(numDof);
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                ElementContext elemCtx(simulator_);
+                elemCtx.setEnableIntensiveQuantityCache(false);
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    elemCtx.updatePrimaryStencil(*elemIt);
+                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx)
+                        intQuants[elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0)] =
+                            elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+                }
+            }
+            linearizer_->evalResidual(dest, intQuants);
+        }
+
+        // like for the element based evaluation, only the interior cells contribute
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            if (!isLocalDof_[dofIdx])
+                dest[dofIdx] = 0.0;
+    }
+
+    // compute a hash of the element indices in the iteration order of the grid. This
+    // allows to detect restart files which use a different numbering of the elements.
+    std::uint64_t elementOrderingFingerprint_() const
+    {
+        // 64 bit FNV-1a
+        std::uint64_t result = 14695981039346656037ULL;
+        for (const auto& elem : elements(gridView_)) {
+            std::uint64_t elemIdx = static_cast<std::uint64_t>(elementMapper_.index(elem));
+            for (unsigned byteIdx = 0; byteIdx < sizeof(elemIdx); ++byteIdx) {
+                result ^= (elemIdx >> (8*byteIdx)) & 0xff;
+                result *= 1099511628211ULL;
+            }
+        }
+        return result;
+    }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
         // allocate the storage cache
@@ -1928,6 +2308,59 @@ protected:
                                     unsigned)
     { }
 
+    /*!
+     * \brief Called by finishInit() and before the intensive quantities of all
+     *        degrees of freedom are updated by invalidateAndUpdateIntensiveQuantities().
+     *
+     * Models which keep a copy of some intensive quantities in a separate data
+     * structure can use this to allocate and reset it. The default is to do nothing.
+     */
+    void prepareIntensiveQuantityMirror_(unsigned) const
+    { }
+
+    /*!
+     * \brief Called by updateCachedIntensiveQuantities() after the cached intensive
+     *        quantities of a degree of freedom have been updated.
+     *
+     * This method may be called concurrently for different degrees of freedom. The
+     * default is to do nothing.
+     */
+    void updateIntensiveQuantityMirror_(unsigned, const IntensiveQuantities&, unsigned) const
+    { }
+
+    // returns the slot of the intensive quantity cache used for a time index
+    unsigned cacheSlot_(unsigned timeIdx) const
+    { return intensiveQuantityCacheSlot_[timeIdx]; }
+
+    // make the cache entry of the most recent time index for a degree of freedom
+    // own its intensive quantities if it refers to the next older time index
+    void resolveCacheAlias_(unsigned globalIdx) const
+    {
+        auto& state = intensiveQuantityCacheUpToDate_[cacheSlot_(/*timeIdx=*/0)][globalIdx];
+        if (state != cacheEntryAliased)
+            return;
+
+        intensiveQuantityCache_[cacheSlot_(/*timeIdx=*/0)][globalIdx] =
+            intensiveQuantityCache_[cacheSlot_(/*timeIdx=*/1)][globalIdx];
+        state = cacheEntryValid;
+    }
+
+    // resolve the aliases of all cache entries of the most recent time index
+    void resolveCacheAliases_() const
+    {
+        const auto& upToDate = intensiveQuantityCacheUpToDate_[cacheSlot_(/*timeIdx=*/0)];
+        if (std::none_of(upToDate.begin(), upToDate.end(),
+                         [](unsigned char state) { return state == cacheEntryAliased; }))
+            return;
+
+        const long numDof = static_cast<long>(upToDate.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long globalIdx = 0; globalIdx < numDof; ++globalIdx)
+            resolveCacheAlias_(static_cast<unsigned>(globalIdx));
+    }
+
     /*!
      * \brief Register all output modules which make sense for the model.
      *
@@ -1986,12 +2419,6 @@ protected:
     // local jacobian
     Linearizer *linearizer_;
 
-    // cur is the current iterative solution, prev the converged
-    // solution of the previous time step
-    mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
-    // while these are logically bools, concurrent writes to vector<bool> are not thread safe.
-    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
-
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
 
     std::list<BaseOutputModule<TypeTag>*> outputModules_;
@@ -2006,6 +2433,32 @@ protected:
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+
+    mutable std::vector<ElementSeed> interiorElementSeedCache_;
+    mutable int interiorElementSeedCacheSequenceNumber_ = -1;
+
+    mutable std::unique_ptr<ThreadedEntityChunks<GridView, /*codim=*/0>> elementChunks_;
+    mutable int elementChunksSequenceNumber_ = -1;
+
+private:
+    // The intensive quantity cache. Its arrays are indexed by slot, not by time index,
+    // and an entry may refer to the one of the next older time index. Access is thus
+    // only possible via cachedIntensiveQuantities(), updateCachedIntensiveQuantities()
+    // and setIntensiveQuantitiesCacheEntryValidity().
+    mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
+    // the state of the cache entries. Since concurrent writes to vector<bool> are not
+    // thread safe, unsigned chars are used.
+    enum : unsigned char {
+        cacheEntryInvalid = 0,
+        cacheEntryValid = 1,
+        // the entry is valid, but its intensive quantities are stored in the slot of
+        // the next older time index. This is only used for the most recent time index.
+        cacheEntryAliased = 2
+    };
+    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+    // the index of the slot of the two arrays above which is used for a time index.
+    // The slots are rotated when advancing the time level.
+    std::array<unsigned, historySize> intensiveQuantityCacheSlot_;
 };
 
 /*!
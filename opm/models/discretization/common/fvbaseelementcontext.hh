@@ -98,8 +98,11 @@ public:
         // remember the simulator object
         simulatorPtr_ = &simulator;
         enableStorageCache_ = Parameters::get<TypeTag, Parameters::EnableStorageCache>();
+        enableIntensiveQuantityCache_ = true;
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+
+        simulator.model().initStencil(stencil_);
     }
 
     static void *operator new(size_t size)
@@ -532,6 +535,23 @@ public:
     void setEnableStorageCache(bool yesno)
     { enableStorageCache_ = yesno; }
 
+    /*!
+     * \brief Returns true iff the intensive quantities cached by the model are used and
+     *        updated by this context.
+     */
+    bool enableIntensiveQuantityCache() const
+    { return enableIntensiveQuantityCache_; }
+
+    /*!
+     * \brief Specifies if the intensive quantities cached by the model ought to be used
+     *        and updated by this context.
+     *
+     * If this is disabled, the intensive quantities are always computed from the
+     * solution of the model, e.g. because it does not correspond to the cached ones.
+     */
+    void setEnableIntensiveQuantityCache(bool yesno)
+    { enableIntensiveQuantityCache_ = yesno; }
+
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -543,7 +563,8 @@ protected:
     /*!
      * \brief Update the first 'n' intensive quantities objects from the primary variables.
      *
-     * This method considers the intensive quantities cache.
+     * This method considers the intensive quantities cache unless it is disabled for
+     * this context.
      */
     void updateIntensiveQuantities_(unsigned timeIdx, size_t numDof)
     {
@@ -559,15 +580,17 @@ protected:
             dofVars_[dofIdx].thermodynamicHint[timeIdx] =
                 model().thermodynamicHint(globalIdx, timeIdx);
 
-            const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
+            const auto *cachedIntQuants =
+                enableIntensiveQuantityCache_ ? model().cachedIntensiveQuantities(globalIdx, timeIdx) : nullptr;
             if (cachedIntQuants) {
                 dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
             }
             else {
                 updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
-                model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
-                                                        globalIdx,
-                                                        timeIdx);
+                if (enableIntensiveQuantityCache_)
+                    model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
+                                                            globalIdx,
+                                                            timeIdx);
             }
         }
     }
@@ -600,6 +623,7 @@ protected:
     int stashedDofIdx_;
     int focusDofIdx_;
     bool enableStorageCache_;
+    bool enableIntensiveQuantityCache_;
 };
 
 } // namespace Opm
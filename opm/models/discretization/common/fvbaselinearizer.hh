@@ -28,6 +28,7 @@
 #ifndef EWOMS_FV_BASE_LINEARIZER_HH
 #define EWOMS_FV_BASE_LINEARIZER_HH
 
+#include "fvbaseparameters.hh"
 #include "fvbaseproperties.hh"
 #include "linearizationtype.hh"
 
@@ -40,16 +41,24 @@
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
 
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <atomic>
+#include <cassert>
 #include <type_traits>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <thread>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <exception>   // current_exception, rethrow_exception
+#include <memory>
 #include <mutex>
 
 namespace Opm {
@@ -95,6 +104,7 @@ class FvBaseLinearizer
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Vector = GlobalEqVector;
 
@@ -108,6 +118,8 @@ class FvBaseLinearizer
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
 
+    enum class AssemblyStrategy { Unsynchronized, Lock, Coloring, ThreadLocal };
+
     // copying the linearizer is not a good idea
     FvBaseLinearizer(const FvBaseLinearizer&);
 //! \endcond
@@ -131,7 +143,12 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        Parameters::registerParam<TypeTag, Parameters::ElementAssemblyStrategy>
+            ("The method used to add the contributions of the elements to the global "
+             "linear system if the discretization requires synchronization. Possible "
+             "values: 'lock', 'coloring' and 'thread-local'.");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -153,6 +170,22 @@ public:
         }
         elementCtx_.resize(0);
         fullDomain_ = std::make_unique<FullDomain>(simulator.gridView());
+
+        if (!getPropValue<TypeTag, Properties::UseLinearizationLock>())
+            assemblyStrategy_ = AssemblyStrategy::Unsynchronized;
+        else {
+            const std::string strategy =
+                Parameters::get<TypeTag, Parameters::ElementAssemblyStrategy>();
+            if (strategy == "lock")
+                assemblyStrategy_ = AssemblyStrategy::Lock;
+            else if (strategy == "coloring")
+                assemblyStrategy_ = AssemblyStrategy::Coloring;
+            else if (strategy == "thread-local")
+                assemblyStrategy_ = AssemblyStrategy::ThreadLocal;
+            else
+                throw std::invalid_argument("Unknown element assembly strategy '" + strategy + "'");
+        }
+        coloringSequenceNumber_ = -1;
     }
 
     /*!
@@ -403,6 +436,7 @@ private:
     {
         // initialize the BCRS matrix for the Jacobian of the residual function
         createMatrix_();
+        createBlockAddressTable_();
 
         // initialize the Jacobian matrix and the vector for the residual function
         residual_.resize(model_().numTotalDof());
@@ -412,28 +446,59 @@ private:
         elementCtx_.resize(ThreadManager::maxThreads());
         for (unsigned threadId = 0; threadId != ThreadManager::maxThreads(); ++ threadId)
             elementCtx_[threadId] = new ElementContext(simulator_());
+
+        // each thread buffers its contributions separately for the row range owned
+        // by each of the threads
+        if (assemblyStrategy_ == AssemblyStrategy::ThreadLocal) {
+            threadLocalBuffers_.resize(ThreadManager::maxThreads());
+            for (auto& buffer : threadLocalBuffers_) {
+                buffer.residual.resize(ThreadManager::maxThreads());
+                buffer.jacobian.resize(ThreadManager::maxThreads());
+            }
+        }
     }
 
     // Construct the BCRS matrix for the Jacobian of the residual function
     void createMatrix_()
     {
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
 
         // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        sparsityPattern_.clear();
-        sparsityPattern_.resize(model.numTotalDof());
+        // freedom of each primary degree of freedom. this is done in two passes over
+        // the grid: the first one counts the entries of each row, the second one adds
+        // them.
+        Linear::SparsityPattern sparsityPattern(model.numTotalDof());
 
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
+        // the stencils must be created in a sequential context
+        std::vector<std::unique_ptr<Stencil>> stencils(ThreadManager::maxThreads());
+        for (auto& stencil : stencils)
+            stencil = std::make_unique<Stencil>(gridView_(), model.dofMapper());
 
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+        for (unsigned pass = 0; pass < 2; ++pass) {
+            if (pass == 1)
+                sparsityPattern.allocate();
+
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model_().elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                Stencil& stencil = *stencils[ThreadManager::threadId()];
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    stencil.updateTopology(*elemIt);
+
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                        unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+
+                        if (pass == 0) {
+                            sparsityPattern.countEntries(myIdx, stencil.numDof());
+                            continue;
+                        }
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern_[myIdx].insert(neighborIdx);
+                        for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                            sparsityPattern.addEntry(myIdx, stencil.globalSpaceIndex(dofIdx));
+                    }
                 }
             }
         }
@@ -442,13 +507,65 @@ private:
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
         for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern_);
+            model.auxiliaryModule(auxModIdx)->addSparsityEntries(sparsityPattern);
+
+        sparsityPattern.finalize();
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
 
         // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern_);
+        jacobian_->reserve(sparsityPattern);
+    }
+
+    // determine the addresses of the blocks of the Jacobian matrix which are touched
+    // by each element. the blocks of an element are stored in the order in which they
+    // are accumulated by linearizeElement_(), i.e., the block for the primary degree
+    // of freedom i and the degree of freedom j of the stencil is at position
+    // i*numDof + j.
+    void createBlockAddressTable_()
+    {
+        const std::size_t numElements = elementMapper_().size();
+        blockAddressOffsets_.assign(numElements + 1, 0);
+
+        std::vector<std::unique_ptr<Stencil>> stencils(ThreadManager::maxThreads());
+        for (auto& stencil : stencils)
+            stencil = std::make_unique<Stencil>(gridView_(), dofMapper_());
+
+        for (unsigned pass = 0; pass < 2; ++pass) {
+            if (pass == 1) {
+                for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx)
+                    blockAddressOffsets_[elemIdx + 1] += blockAddressOffsets_[elemIdx];
+                blockAddresses_.resize(blockAddressOffsets_.back());
+            }
+
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model_().elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                Stencil& stencil = *stencils[ThreadManager::threadId()];
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const unsigned elemIdx = elementMapper_().index(*elemIt);
+                    stencil.updateTopology(*elemIt);
+
+                    if (pass == 0) {
+                        blockAddressOffsets_[elemIdx + 1] = stencil.numPrimaryDof()*stencil.numDof();
+                        continue;
+                    }
+
+                    MatrixBlock** blockAddress = blockAddresses_.data() + blockAddressOffsets_[elemIdx];
+                    for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                        const unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
+                        for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                            const unsigned globJ = stencil.globalSpaceIndex(dofIdx);
+                            *blockAddress++ = jacobian_->blockAddress(globJ, globI);
+                        }
+                    }
+                }
+            }
+        }
     }
 
     // reset the global linear system of equations.
@@ -470,7 +587,7 @@ private:
         constraintsMap_.clear();
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(model_().elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -523,6 +640,22 @@ private:
 
         applyConstraintsToSolution_();
 
+        // the element colouring only covers the full domain
+        AssemblyStrategy strategy = assemblyStrategy_;
+        if constexpr (!std::is_same_v<SubDomainType, FullDomain>) {
+            if (strategy == AssemblyStrategy::Coloring)
+                strategy = AssemblyStrategy::Lock;
+        }
+
+        if (strategy == AssemblyStrategy::Coloring) {
+            linearizeColored_();
+            applyConstraintsToLinearization_();
+            return;
+        }
+
+        if (strategy == AssemblyStrategy::ThreadLocal)
+            clearThreadLocalBuffers_();
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -560,7 +693,7 @@ private:
                     if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                         continue;
 
-                    linearizeElement_(elem);
+                    linearizeElement_(elem, strategy);
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -586,13 +719,196 @@ private:
             std::rethrow_exception(exceptionPtr);
         }
 
+        if (strategy == AssemblyStrategy::ThreadLocal)
+            addThreadLocalContributions_();
+
         applyConstraintsToLinearization_();
     }
 
+    // linearize all elements of the process' grid partition colour by colour. the
+    // elements of a colour do not share any primary degree of freedom, so their
+    // contributions can be added to the global system without synchronization.
+    void linearizeColored_()
+    {
+        updateElementColoring_();
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> failed(false);
+
+        const auto& grid = gridView_().grid();
+        const std::size_t numColors = elementColorOffsets_.size() - 1;
+        for (std::size_t colorIdx = 0; colorIdx < numColors && !failed; ++colorIdx) {
+            const long colorBegin = static_cast<long>(elementColorOffsets_[colorIdx]);
+            const long colorEnd = static_cast<long>(elementColorOffsets_[colorIdx + 1]);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+            for (long i = colorBegin; i < colorEnd; ++i) {
+                if (failed.load(std::memory_order_relaxed))
+                    continue;
+
+                try {
+                    const Element elem = grid.entity(coloredElements_[static_cast<std::size_t>(i)]);
+                    linearizeElement_(elem, AssemblyStrategy::Coloring);
+                }
+                // exceptions must not escape the parallel region (cf. linearize_())
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    failed = true;
+                }
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // group the linearized elements into colours such that the elements of a colour
+    // do not share any primary degree of freedom. this only needs to be done once for
+    // each version of the grid.
+    void updateElementColoring_()
+    {
+        const int sequenceNumber = simulator_().vanguard().gridSequenceNumber();
+        if (sequenceNumber == coloringSequenceNumber_)
+            return;
+
+        const auto& model = model_();
+        Stencil stencil(gridView_(), model.dofMapper());
+
+        // the primary degrees of freedom of each element which needs to be linearized
+        std::vector<ElementSeed> seeds;
+        std::vector<std::size_t> elemDofOffsets(1, 0);
+        std::vector<unsigned> elemDofs;
+        for (const auto& elem : elements(gridView_())) {
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.updateTopology(elem);
+            seeds.push_back(elem.seed());
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                elemDofs.push_back(stencil.globalSpaceIndex(primaryDofIdx));
+            elemDofOffsets.push_back(elemDofs.size());
+        }
+        const std::size_t numElems = seeds.size();
+
+        // the elements which are adjacent to each degree of freedom
+        const std::size_t numDof = model.numTotalDof();
+        std::vector<std::size_t> dofElemOffsets(numDof + 1, 0);
+        for (unsigned dofIdx : elemDofs)
+            ++dofElemOffsets[dofIdx + 1];
+        for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            dofElemOffsets[dofIdx + 1] += dofElemOffsets[dofIdx];
+
+        std::vector<unsigned> dofElems(elemDofs.size());
+        std::vector<std::size_t> fillPos(dofElemOffsets.begin(), dofElemOffsets.end() - 1);
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            for (std::size_t k = elemDofOffsets[elemIdx]; k < elemDofOffsets[elemIdx + 1]; ++k)
+                dofElems[fillPos[elemDofs[k]]++] = static_cast<unsigned>(elemIdx);
+
+        // greedily assign the smallest colour to each element which is not used by
+        // any element that shares a primary degree of freedom with it
+        const unsigned noColor = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> elemColor(numElems, noColor);
+        std::vector<unsigned> colorUsedBy;
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+            for (std::size_t k = elemDofOffsets[elemIdx]; k < elemDofOffsets[elemIdx + 1]; ++k) {
+                const unsigned dofIdx = elemDofs[k];
+                for (std::size_t l = dofElemOffsets[dofIdx]; l < dofElemOffsets[dofIdx + 1]; ++l) {
+                    const unsigned color = elemColor[dofElems[l]];
+                    if (color != noColor)
+                        colorUsedBy[color] = static_cast<unsigned>(elemIdx);
+                }
+            }
+
+            unsigned color = 0;
+            while (color < colorUsedBy.size() && colorUsedBy[color] == elemIdx)
+                ++color;
+            if (color == colorUsedBy.size())
+                colorUsedBy.push_back(noColor);
+            elemColor[elemIdx] = color;
+        }
+
+        // store the elements sorted by colour
+        const std::size_t numColors = colorUsedBy.size();
+        elementColorOffsets_.assign(numColors + 1, 0);
+        for (unsigned color : elemColor)
+            ++elementColorOffsets_[color + 1];
+        for (std::size_t colorIdx = 0; colorIdx < numColors; ++colorIdx)
+            elementColorOffsets_[colorIdx + 1] += elementColorOffsets_[colorIdx];
+
+        std::vector<unsigned> colorOrder(numElems);
+        fillPos.assign(elementColorOffsets_.begin(), elementColorOffsets_.end() - 1);
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            colorOrder[fillPos[elemColor[elemIdx]]++] = static_cast<unsigned>(elemIdx);
+
+        coloredElements_.clear();
+        coloredElements_.reserve(numElems);
+        for (unsigned elemIdx : colorOrder)
+            coloredElements_.push_back(seeds[elemIdx]);
+
+        coloringSequenceNumber_ = sequenceNumber;
+    }
+
+    void clearThreadLocalBuffers_()
+    {
+        for (auto& buffer : threadLocalBuffers_) {
+            for (auto& contributions : buffer.residual)
+                contributions.clear();
+            for (auto& contributions : buffer.jacobian)
+                contributions.clear();
+        }
+    }
+
+    // record the contributions of an element in the buffer of the current thread
+    template <class LocalLinearizer>
+    void bufferElementContributions_(unsigned threadId,
+                                     const ElementContext& elementCtx,
+                                     const LocalLinearizer& localLinearizer,
+                                     MatrixBlock* const* blockAddress)
+    {
+        auto& buffer = threadLocalBuffers_[threadId];
+        const std::size_t numOwners = threadLocalBuffers_.size();
+        const std::size_t numRows = residual_.size();
+        const auto owner = [numOwners, numRows](unsigned rowIdx)
+        { return static_cast<std::size_t>(rowIdx)*numOwners/numRows; };
+
+        size_t numPrimaryDof = elementCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elementCtx.globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            buffer.residual[owner(globI)].push_back({globI, localLinearizer.residual(primaryDofIdx)});
+
+            for (unsigned dofIdx = 0; dofIdx < elementCtx.numDof(/*timeIdx=*/0); ++ dofIdx) {
+                unsigned globJ = elementCtx.globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+                buffer.jacobian[owner(globJ)].push_back({*blockAddress++, localLinearizer.jacobian(dofIdx, primaryDofIdx)});
+            }
+        }
+    }
+
+    // add the buffered contributions to the global system. each thread handles the
+    // rows which it owns, so no synchronization is required.
+    void addThreadLocalContributions_()
+    {
+        const long numOwners = static_cast<long>(threadLocalBuffers_.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (long i = 0; i < numOwners; ++i) {
+            const auto ownerIdx = static_cast<std::size_t>(i);
+            for (const auto& buffer : threadLocalBuffers_) {
+                for (const auto& contribution : buffer.residual[ownerIdx])
+                    residual_[contribution.rowIdx] += contribution.value;
+                for (const auto& contribution : buffer.jacobian[ownerIdx])
+                    *contribution.blockAddress += contribution.value;
+            }
+        }
+    }
+
 
     // linearize an element in the interior of the process' grid partition
     template <class ElementType>
-    void linearizeElement_(const ElementType& elem)
+    void linearizeElement_(const ElementType& elem, AssemblyStrategy strategy)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -602,8 +918,19 @@ private:
         // the actual work of linearization is done by the local linearizer class
         localLinearizer.linearize(*elementCtx, elem);
 
+        // the addresses of the matrix blocks which are touched by the element
+        const unsigned elemIdx = elementMapper_().index(elem);
+        MatrixBlock* const* blockAddress = blockAddresses_.data() + blockAddressOffsets_[elemIdx];
+        assert(blockAddressOffsets_[elemIdx + 1] - blockAddressOffsets_[elemIdx]
+               == elementCtx->numPrimaryDof(/*timeIdx=*/0)*elementCtx->numDof(/*timeIdx=*/0));
+
+        if (strategy == AssemblyStrategy::ThreadLocal) {
+            bufferElementContributions_(threadId, *elementCtx, localLinearizer, blockAddress);
+            return;
+        }
+
         // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (strategy == AssemblyStrategy::Lock)
             globalMatrixMutex_.lock();
 
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
@@ -614,14 +941,11 @@ private:
             residual_[globI] += localLinearizer.residual(primaryDofIdx);
 
             // update the global Jacobian matrix
-            for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
-                unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
-
-                jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
-            }
+            for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx)
+                **blockAddress++ += localLinearizer.jacobian(dofIdx, primaryDofIdx);
         }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (strategy == AssemblyStrategy::Lock)
             globalMatrixMutex_.unlock();
     }
 
@@ -695,7 +1019,36 @@ private:
 
     std::mutex globalMatrixMutex_;
 
-    std::vector<std::set<unsigned int>> sparsityPattern_;
+    // the addresses of the Jacobian blocks of each element, see createBlockAddressTable_()
+    std::vector<MatrixBlock*> blockAddresses_;
+    std::vector<std::size_t> blockAddressOffsets_;
+
+    AssemblyStrategy assemblyStrategy_ = AssemblyStrategy::Lock;
+
+    // the seeds of the linearized elements sorted by colour and the index of the
+    // first element of each colour
+    std::vector<ElementSeed> coloredElements_;
+    std::vector<std::size_t> elementColorOffsets_;
+    int coloringSequenceNumber_ = -1;
+
+    struct ResidualContribution_
+    {
+        unsigned rowIdx;
+        VectorBlock value;
+    };
+    struct JacobianContribution_
+    {
+        MatrixBlock* blockAddress;
+        MatrixBlock value;
+    };
+    // the contributions recorded by each thread, bucketed by the thread which owns
+    // the row
+    struct ThreadLocalBuffer_
+    {
+        std::vector<std::vector<ResidualContribution_>> residual;
+        std::vector<std::vector<JacobianContribution_>> jacobian;
+    };
+    std::vector<ThreadLocalBuffer_> threadLocalBuffers_;
 
     struct FullDomain
     {
@@ -32,6 +32,7 @@
 
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/instrumentation.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -162,14 +163,23 @@ public:
 
         residual = 0.0;
 
+        const auto& newtonMethod = elemCtx.model().newtonMethod();
+        auto& instrumentation = newtonMethod.instrumentation();
+
         // evaluate the flux terms
+        Instrumentation::ScopedRegion fluxRegion(instrumentation,
+                                                 newtonMethod.instrumentationRegions().flux);
         asImp_().evalFluxes(residual, elemCtx, /*timeIdx=*/0);
+        fluxRegion.stop();
 
         // evaluate the storage and the source terms
         asImp_().evalVolumeTerms_(residual, elemCtx);
 
         // evaluate the boundary conditions
+        Instrumentation::ScopedRegion boundaryRegion(instrumentation,
+                                                     newtonMethod.instrumentationRegions().boundary);
         asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0);
+        boundaryRegion.stop();
 
         if (useVolumetricResidual) {
             // make the residual volume specific (i.e., make it incorrect mass per cubic
@@ -498,9 +508,14 @@ protected:
         tmp = 0.0;
         tmp2 = 0.0;
 
+        const auto& newtonMethod = elemCtx.model().newtonMethod();
+        auto& instrumentation = newtonMethod.instrumentation();
+        const auto& regions = newtonMethod.instrumentationRegions();
+
         // evaluate the volumetric terms (storage + source terms)
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
+            Instrumentation::ScopedRegion storageRegion(instrumentation, regions.storage);
             Scalar extrusionFactor =
                 elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
             Valgrind::CheckDefined(extrusionFactor);
@@ -589,8 +604,10 @@ protected:
             }
 
             Valgrind::CheckDefined(residual[dofIdx]);
+            storageRegion.stop();
 
             // deal with the source term
+            Instrumentation::ScopedRegion sourceRegion(instrumentation, regions.source);
             asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
 
             // if the model uses extensive quantities in its storage term, and we use
@@ -97,12 +97,14 @@ public:
     void beginIteration()
     {
         ++ iteration_;
-        if (!vtkMultiWriter_)
+        if (!vtkMultiWriter_) {
             vtkMultiWriter_ =
                 new VtkMultiWriter(/*async=*/false,
                                    newtonMethod_.problem().gridView(),
                                    newtonMethod_.problem().outputDir(),
                                    "convergence");
+            vtkMultiWriter_->setElementOrdering(newtonMethod_.problem().simulator().vanguard().elementOrdering());
+        }
         vtkMultiWriter_->beginWrite(timeStepIdx_ + iteration_ / 100.0);
     }
 
@@ -37,6 +37,22 @@ namespace Opm::Parameters {
 template<class TypeTag, class MyTypeTag>
 struct ThreadsPerProcess { using type = Properties::UndefinedProperty; };
 
+/*!
+ * \brief The number of consecutive grid entities which are handed out to a thread at
+ *        once by the threaded entity iterators.
+ */
+template<class TypeTag, class MyTypeTag>
+struct ThreadedIteratorChunkSize { using type = Properties::UndefinedProperty; };
+
+/*!
+ * \brief Use a guided schedule for the threaded entity iterators.
+ *
+ * If enabled, the threads initially grab large blocks of chunks and the block size is
+ * reduced towards the end of the loop.
+ */
+template<class TypeTag, class MyTypeTag>
+struct ThreadedIteratorGuidedSchedule { using type = Properties::UndefinedProperty; };
+
 /*!
  * \brief Switch to enable or disable grid adaptation
  *
@@ -73,6 +89,23 @@ struct EnableVtkOutput { using type = Properties::UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableAsyncVtkOutput { using type = Properties::UndefinedProperty; };
 
+/*!
+ * \brief Write the VTK output as appended binary data without using Dune's VTK writer
+ *
+ * Possible values are "none" (use Dune::VTKWriter with the format given by the
+ * VtkOutputFormat property), "raw" (uncompressed binary data) and "zlib" (zlib
+ * compressed binary data). In the binary modes, the fields are encoded in parallel
+ * and each process writes its piece of the grid independently.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkBinaryOutput { using type = Properties::UndefinedProperty; };
+
+/*!
+ * \brief Narrow the fields to single precision for the binary VTK output
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkBinaryOutputSinglePrecision { using type = Properties::UndefinedProperty; };
+
 /*!
  * \brief Specify the maximum size of a time integration [s].
  *
@@ -136,6 +169,19 @@ struct EnableStorageCache { using type = Properties::UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableThermodynamicHints { using type = Properties::UndefinedProperty; };
 
+/*!
+ * \brief Specifies how the contributions of the elements are added to the global
+ *        linear system if the discretization requires synchronization.
+ *
+ * "lock" serializes the scatter of each element using a global mutex,
+ * "coloring" assembles groups of elements which do not share any primary degree
+ * of freedom concurrently, and "thread-local" records the contributions of each
+ * thread and adds them to the global system after all elements have been
+ * linearized.
+ */
+template<class TypeTag, class MyTypeTag>
+struct ElementAssemblyStrategy { using type = Properties::UndefinedProperty; };
+
 } // namespace Opm::Parameters
 
 #endif
@@ -39,6 +39,7 @@
 
 #include <iostream>
 #include <limits>
+#include <stdexcept>
 #include <string>
 
 #include <sys/stat.h>
@@ -123,6 +124,8 @@ public:
         , simulator_(simulator)
         , defaultVtkWriter_(0)
     {
+        elementMapper_.setOrdering(simulator.vanguard().elementOrdering());
+
         // calculate the bounding box of the local partition of the grid view
         VertexIterator vIt = gridView_.template begin<dim>();
         const VertexIterator vEndIt = gridView_.template end<dim>();
@@ -140,8 +143,15 @@ public:
         }
 
         if (enableVtkOutput_()) {
+            const std::string binaryOutput = Parameters::get<TypeTag, Parameters::VtkBinaryOutput>();
+            if (binaryOutput != "none" && binaryOutput != "raw" && binaryOutput != "zlib")
+                throw std::runtime_error("Unknown binary VTK output mode '"+binaryOutput+"'. "
+                                         "Valid modes are 'none', 'raw' and 'zlib'");
+
+            // the binary VTK writer does not communicate while writing, so it can be
+            // used asynchronously in the parallel case as well
             bool asyncVtkOutput =
-                simulator_.gridView().comm().size() == 1 &&
+                (simulator_.gridView().comm().size() == 1 || binaryOutput != "none") &&
                 Parameters::get<TypeTag, Parameters::EnableAsyncVtkOutput>();
 
             // asynchonous VTK output currently does not work in conjunction with grid
@@ -156,6 +166,13 @@ public:
 
             defaultVtkWriter_ =
                 new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+            defaultVtkWriter_->setElementOrdering(simulator.vanguard().elementOrdering());
+
+            if (binaryOutput != "none") {
+                using Encoding = typename VtkMultiWriter::BinaryWriter::Encoding;
+                defaultVtkWriter_->enableBinaryOutput(binaryOutput == "zlib" ? Encoding::Zlib : Encoding::Raw,
+                                                      Parameters::get<TypeTag, Parameters::VtkBinaryOutputSinglePrecision>());
+            }
         }
     }
 
@@ -178,6 +195,11 @@ public:
              "before the simulation bails out");
         Parameters::registerParam<TypeTag, Parameters::EnableAsyncVtkOutput>
             ("Dispatch a separate thread to write the VTK output");
+        Parameters::registerParam<TypeTag, Parameters::VtkBinaryOutput>
+            ("Write the VTK output as appended binary data. Possible values: "
+             "'none' (use Dune's VTK writer), 'raw' and 'zlib'");
+        Parameters::registerParam<TypeTag, Parameters::VtkBinaryOutputSinglePrecision>
+            ("Narrow the fields of the binary VTK output to single precision");
         Parameters::registerParam<TypeTag, Parameters::ContinueOnConvergenceError>
             ("Continue with a non-converged solution instead of giving up "
              "if we encounter a time step size smaller than the minimum time "
@@ -560,14 +582,14 @@ public:
      * \brief Returns the minimum allowable size of a time step.
      */
     Scalar minTimeStepSize() const
-    { return Parameters::get<TypeTag, Parameters::MinTimeStepSize>(); }
+    { return Parameters::getResolved<TypeTag, Parameters::MinTimeStepSize>(); }
 
     /*!
      * \brief Returns the maximum number of subsequent failures for the time integration
      *        before giving up.
      */
     unsigned maxTimeIntegrationFailures() const
-    { return Parameters::get<TypeTag, Parameters::MaxTimeStepDivisions>(); }
+    { return Parameters::getResolved<TypeTag, Parameters::MaxTimeStepDivisions>(); }
 
     /*!
      * \brief Returns if we should continue with a non-converged solution instead of
@@ -575,7 +597,7 @@ public:
      *        step size.
      */
     bool continueOnConvergenceError() const
-    { return Parameters::get<TypeTag, Parameters::ContinueOnConvergenceError>(); }
+    { return Parameters::getResolved<TypeTag, Parameters::ContinueOnConvergenceError>(); }
 
     /*!
      * \brief Impose the next time step size to be used externally.
@@ -593,7 +615,7 @@ public:
         if (nextTimeStepSize_ > 0.0)
             return nextTimeStepSize_;
 
-        Scalar dtNext = std::min(Parameters::get<TypeTag, Parameters::MaxTimeStepSize>(),
+        Scalar dtNext = std::min(Parameters::getResolved<TypeTag, Parameters::MaxTimeStepSize>(),
                                  newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
 
         if (dtNext < simulator().maxTimeStepSize()
@@ -812,7 +834,7 @@ protected:
 
 private:
     bool enableVtkOutput_() const
-    { return Parameters::get<TypeTag, Parameters::EnableVtkOutput>(); }
+    { return Parameters::getResolved<TypeTag, Parameters::EnableVtkOutput>(); }
 
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
@@ -0,0 +1,142 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ReorderedElementMapper
+ */
+#ifndef EWOMS_REORDERED_ELEMENT_MAPPER_HH
+#define EWOMS_REORDERED_ELEMENT_MAPPER_HH
+
+#include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A mapper for the elements of a grid view which renumbers the indices of
+ *        Dune::MultipleCodimMultipleGeomTypeMapper according to an ordering.
+ *
+ * The ordering contains the new index of each element for the index of the
+ * underlying mapper and it is usually provided by the vanguard. Without an ordering,
+ * the indices of the underlying mapper are used. Since the methods of the Dune mapper
+ * are not virtual, objects of this class must not be accessed via references to the
+ * base class.
+ */
+template <class GridView>
+class ReorderedElementMapper : public Dune::MultipleCodimMultipleGeomTypeMapper<GridView>
+{
+    using ParentType = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+
+public:
+    using Index = typename ParentType::Index;
+    using Ordering = std::vector<unsigned>;
+
+    ReorderedElementMapper(const GridView& gridView, const Dune::MCMGLayout& layout)
+        : ParentType(gridView, layout)
+    {}
+
+    /*!
+     * \brief Set the ordering of the elements.
+     *
+     * A null pointer restores the ordering of the underlying mapper.
+     */
+    void setOrdering(std::shared_ptr<const Ordering> ordering)
+    {
+        assert(!ordering || ordering->size() == this->size());
+        ordering_ = std::move(ordering);
+    }
+
+    /*!
+     * \brief Returns true if the indices are renumbered.
+     */
+    bool isReordered() const
+    { return static_cast<bool>(ordering_); }
+
+    template <class EntityType>
+    Index index(const EntityType& e) const
+    {
+        if constexpr (EntityType::codimension == 0)
+            return reorder_(ParentType::index(e));
+        else
+            return ParentType::index(e);
+    }
+
+    Index subIndex(const Element& e, int i, unsigned int codim) const
+    {
+        const Index idx = ParentType::subIndex(e, i, codim);
+        return codim == 0 ? reorder_(idx) : idx;
+    }
+
+    template <class EntityType>
+    bool contains(const EntityType& e, Index& result) const
+    {
+        if (!ParentType::contains(e, result))
+            return false;
+        if constexpr (EntityType::codimension == 0)
+            result = reorder_(result);
+        return true;
+    }
+
+    bool contains(const Element& e, int i, int cc, Index& result) const
+    {
+        if (!ParentType::contains(e, i, cc, result))
+            return false;
+        if (cc == 0)
+            result = reorder_(result);
+        return true;
+    }
+
+    /*!
+     * \brief Recalculate the indices after the grid has changed.
+     *
+     * This discards the ordering because it refers to the previous grid.
+     */
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+    void update(const GridView& gridView)
+    {
+        ordering_.reset();
+        ParentType::update(gridView);
+    }
+#else
+    void update()
+    {
+        ordering_.reset();
+        ParentType::update();
+    }
+#endif
+
+private:
+    Index reorder_(Index idx) const
+    { return ordering_ ? static_cast<Index>((*ordering_)[idx]) : idx; }
+
+    std::shared_ptr<const Ordering> ordering_;
+};
+
+} // namespace Opm
+
+#endif
@@ -40,6 +40,8 @@
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/instrumentation.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
@@ -283,6 +285,40 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution
+     *        without assembling the Jacobian.
+     *
+     * The residual is computed cell by cell from the intensive quantities cached by
+     * the model, which thus must be up to date. The internal residual and Jacobian of
+     * the linearizer are not modified and the Jacobian is not allocated if it does not
+     * exist yet. Unlike linearize(), the well source terms are always evaluated
+     * cell-wise because the separate sparse source terms can only be added to an
+     * assembled Jacobian.
+     */
+    void evalResidual(GlobalEqVector& dest)
+    {
+        evalResidual_(dest, [this](unsigned globalIdx) -> const IntensiveQuantities&
+                            { return model_().intensiveQuantities(globalIdx, /*timeIdx=*/0); },
+                      /*useMirror=*/true);
+    }
+
+    /*!
+     * \brief Evaluate the residual of the spatial domain for given intensive quantities
+     *        of the most recent time index without assembling the Jacobian.
+     *
+     * This is identical to evalResidual(GlobalEqVector&), but the intensive quantities
+     * of time index 0 are taken from \c intQuants, which must contain an entry for
+     * each degree of freedom, instead of the cache of the model.
+     */
+    template <class IntensiveQuantitiesVector>
+    void evalResidual(GlobalEqVector& dest, const IntensiveQuantitiesVector& intQuants)
+    {
+        evalResidual_(dest, [&intQuants](unsigned globalIdx) -> const IntensiveQuantities&
+                            { return intQuants[globalIdx]; },
+                      /*useMirror=*/false);
+    }
+
     /*!
      * \brief Return constant reference to global Jacobian matrix backend.
      */
@@ -382,6 +418,45 @@ public:
         }
     }
 
+private:
+    // models may maintain a compact copy of the intensive quantities which is read by
+    // the local residual when computing the fluxes
+    template <class M, class = void>
+    struct HasIntensiveQuantityMirror_ : std::false_type {};
+
+    template <class M>
+    struct HasIntensiveQuantityMirror_<M, std::void_t<decltype(std::declval<const M&>().intensiveQuantityMirror())>>
+        : std::true_type {};
+
+    // local residuals whose source terms depend on the neighbors of a cell provide
+    // overloads of computeSource() and computeSourceDense() which additionally take the
+    // intensive quantities and the neighbor information of the cell
+    template <class LR, class NeighborInfoRange, class = void>
+    struct HasNeighborSource_ : std::false_type {};
+
+    template <class LR, class NeighborInfoRange>
+    struct HasNeighborSource_<LR, NeighborInfoRange,
+                              std::void_t<decltype(LR::computeSource(std::declval<ADVectorBlock&>(),
+                                                                     std::declval<const Problem&>(),
+                                                                     std::declval<const IntensiveQuantities&>(),
+                                                                     0u,
+                                                                     std::declval<const NeighborInfoRange&>(),
+                                                                     0u))>>
+        : std::true_type {};
+
+    template <class LR, class NeighborInfoRange, class = void>
+    struct HasNeighborSourceDense_ : std::false_type {};
+
+    template <class LR, class NeighborInfoRange>
+    struct HasNeighborSourceDense_<LR, NeighborInfoRange,
+                                   std::void_t<decltype(LR::computeSourceDense(std::declval<ADVectorBlock&>(),
+                                                                               std::declval<const Problem&>(),
+                                                                               std::declval<const IntensiveQuantities&>(),
+                                                                               0u,
+                                                                               std::declval<const NeighborInfoRange&>(),
+                                                                               0u))>>
+        : std::true_type {};
+
 private:
     Simulator& simulator_()
     { return *simulatorPtr_; }
@@ -401,6 +476,86 @@ private:
     const GridView& gridView_() const
     { return problem_().gridView(); }
 
+    // evaluate the residual of the spatial domain. intQuants(globalIdx) returns the
+    // intensive quantities of a degree of freedom for the most recent time index,
+    // useMirror specifies whether these are the cached ones.
+    template <class IntQuantsFn>
+    void evalResidual_(GlobalEqVector& dest, const IntQuantsFn& intQuants, bool useMirror)
+    {
+        OPM_TIMEBLOCK(evalResidual);
+        createNeighborInfo_();
+
+        const unsigned numCells = model_().numTotalDof();
+        dest.resize(numCells);
+        const bool recycleStorage = problem_().recycleFirstIterationStorage();
+        const bool firstIteration = model_().newtonMethod().numIterations() == 0;
+        const Scalar dt = simulator_().timeStepSize();
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            const auto& nbInfos = neighborInfo_[globI];
+            const IntensiveQuantities& intQuantsIn = intQuants(globI);
+            VectorBlock& res = dest[globI];
+            res = 0.0;
+            ADVectorBlock adres(0.0);
+            ADVectorBlock darcyFlux(0.0);
+
+            // flux term
+            for (const auto& nbInfo : nbInfos) {
+                const unsigned globJ = nbInfo.neighbor;
+                const IntensiveQuantities& intQuantsEx = intQuants(globJ);
+                adres = 0.0;
+                darcyFlux = 0.0;
+                computeFlux_(adres, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo,
+                             useMirror);
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    res[eqIdx] += adres[eqIdx].value()*nbInfo.res_nbinfo.faceArea;
+            }
+
+            // accumulation term. this uses the same storage term of the beginning of
+            // the time step as linearize_(), but it does not update the storage cache.
+            const Scalar volume = model_().dofTotalVolume(globI);
+            adres = 0.0;
+            LocalResidual::computeStorage(adres, intQuantsIn);
+            VectorBlock storage;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                storage[eqIdx] = adres[eqIdx].value();
+            VectorBlock storageOld;
+            if (model_().enableStorageCache() && !firstIteration)
+                storageOld = model_().cachedStorage(globI, 1);
+            else if (model_().enableStorageCache() && recycleStorage)
+                storageOld = storage;
+            else {
+                const IntensiveQuantities& intQuantsOld = model_().intensiveQuantities(globI, 1);
+                LocalResidual::computeStorage(storageOld, intQuantsOld);
+            }
+            storage -= storageOld;
+            storage *= volume/dt;
+            res += storage;
+
+            // source term
+            adres = 0.0;
+            computeSource_(adres, intQuantsIn, globI, nbInfos, /*dense=*/false);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                res[eqIdx] -= adres[eqIdx].value()*volume;
+        }
+
+        // boundary terms
+        for (const auto& bdyInfo : boundaryInfo_) {
+            if (bdyInfo.bcdata.type == BCType::NONE)
+                continue;
+
+            ADVectorBlock adres(0.0);
+            const unsigned globI = bdyInfo.cell;
+            const IntensiveQuantities& insideIntQuants = intQuants(globI);
+            LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                dest[globI][eqIdx] += adres[eqIdx].value()*bdyInfo.bcdata.faceArea;
+        }
+    }
+
     void initFirstIteration_()
     {
         // initialize the BCRS matrix for the Jacobian of the residual function
@@ -414,10 +569,11 @@ private:
         createFlows_();
     }
 
-    // Construct the BCRS matrix for the Jacobian of the residual function
-    void createMatrix_()
+    // Determine the neighbors of each cell and the data of the faces between them as
+    // well as the cells which are subject to boundary conditions
+    void createNeighborInfo_()
     {
-        OPM_TIMEBLOCK(createMatrix);
+        OPM_TIMEBLOCK(createNeighborInfo);
         if (!neighborInfo_.empty()) {
             // It is ok to call this function multiple times, but it
             // should not do anything if already called.
@@ -428,8 +584,6 @@ private:
 
         // for the main model, find out the global indices of the neighboring degrees of
         // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
         const Scalar gravity = problem_().gravity()[dimWorld - 1];
         unsigned numCells = model.numTotalDof();
         neighborInfo_.reserve(numCells, 6 * numCells);
@@ -443,7 +597,6 @@ private:
 
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
                     unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
                     if (dofIdx > 0) {
                         const Scalar trans = problem_().transmissibility(myIdx, neighborIdx);
                         const auto scvfIdx = dofIdx - 1;
@@ -472,7 +625,9 @@ private:
                         const auto dirId = scvf.dirId();
                         auto faceDir = dirId < 0 ? FaceDir::DirEnum::Unknown
                                                  : FaceDir::FromIntersectionIndex(dirId);
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity}, nullptr};
+                        const Scalar dist = (stencil.subControlVolume(primaryDofIdx).globalPos()
+                                             - stencil.subControlVolume(dofIdx).globalPos()).two_norm();
+                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity, dist}, nullptr};
 
                     }
                 }
@@ -503,12 +658,52 @@ private:
                 }
             }
         }
+    }
+
+    // Construct the BCRS matrix for the Jacobian of the residual function
+    void createMatrix_()
+    {
+        OPM_TIMEBLOCK(createMatrix);
+        if (jacobian_) {
+            // It is ok to call this function multiple times, but it
+            // should not do anything if already called.
+            return;
+        }
+        createNeighborInfo_();
+
+        const auto& model = model_();
+        const unsigned numCells = model.numTotalDof();
+
+        // the rows of the sparsity pattern consist of the degree of freedom itself and
+        // its neighbors. since there is exactly one row per cell, the counting and
+        // filling passes can be done in parallel over the cells without conflicts.
+        Linear::SparsityPattern sparsityPattern(numCells);
+        const long numRows = static_cast<long>(neighborInfo_.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < numRows; ++i) {
+            const auto globI = static_cast<unsigned>(i);
+            sparsityPattern.countEntries(globI, 1 + static_cast<unsigned>(neighborInfo_[globI].size()));
+        }
+        sparsityPattern.allocate();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < numRows; ++i) {
+            const auto globI = static_cast<unsigned>(i);
+            sparsityPattern.addEntry(globI, globI);
+            for (const auto& nbInfo : neighborInfo_[globI])
+                sparsityPattern.addEntry(globI, nbInfo.neighbor);
+        }
 
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
         for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+            model.auxiliaryModule(auxModIdx)->addSparsityEntries(sparsityPattern);
+
+        sparsityPattern.finalize();
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
@@ -673,7 +868,7 @@ public:
                 adres = 0.0;
                 darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
+                computeFlux_(adres, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
                 adres *= nbInfo.res_nbinfo.faceArea;
                 if (enableFlows) {
                     for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
@@ -733,6 +928,10 @@ private:
         const unsigned int numCells = domain.cells.size();
         const bool on_full_domain = (numCells == model_().numTotalDof());
 
+        const auto& newtonMethod = model_().newtonMethod();
+        auto& instrumentation = newtonMethod.instrumentation();
+        const auto& regions = newtonMethod.instrumentationRegions();
+
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
@@ -749,6 +948,7 @@ private:
             // Flux term.
             {
             OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
+            Instrumentation::ScopedRegion fluxRegion(instrumentation, regions.flux);
             short loc = 0;
             for (const auto& nbInfo : nbInfos) {
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
@@ -759,7 +959,7 @@ private:
                 adres = 0.0;
                 darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
+                computeFlux_(adres, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
                 adres *= nbInfo.res_nbinfo.faceArea;
                 if (enableDispersion) {
                     for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
@@ -778,6 +978,7 @@ private:
             }
 
             // Accumulation term.
+            Instrumentation::ScopedRegion storageRegion(instrumentation, regions.storage);
             double dt = simulator_().timeStepSize();
             double volume = model_().dofTotalVolume(globI);
             Scalar storefac = volume / dt;
@@ -828,17 +1029,15 @@ private:
             residual_[globI] += res;
             //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
             *diagMatAddress_[globI] += bMat;
+            storageRegion.stop();
 
             // Cell-wise source terms.
             // This will include well sources if SeparateSparseSourceTerms is false.
+            Instrumentation::ScopedRegion sourceRegion(instrumentation, regions.source);
             res = 0.0;
             bMat = 0.0;
             adres = 0.0;
-            if (separateSparseSourceTerms_) {
-                LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
-            } else {
-                LocalResidual::computeSource(adres, problem_(), globI, 0);
-            }
+            computeSource_(adres, intQuantsIn, globI, nbInfos, /*dense=*/separateSparseSourceTerms_);
             adres *= -volume;
             setResAndJacobi(res, bMat, adres);
             residual_[globI] += res;
@@ -848,10 +1047,12 @@ private:
 
         // Add sparse source terms. For now only wells.
         if (separateSparseSourceTerms_) {
+            Instrumentation::ScopedRegion sourceRegion(instrumentation, regions.source);
             problem_().wellModel().addReservoirSourceTerms(residual_, diagMatAddress_);
         }
 
         // Boundary terms. Only looping over cells with nontrivial bcs.
+        Instrumentation::ScopedRegion boundaryRegion(instrumentation, regions.boundary);
         for (const auto& bdyInfo : boundaryInfo_) {
             if (bdyInfo.bcdata.type == BCType::NONE)
                 continue;
@@ -870,6 +1071,49 @@ private:
         }
     }
 
+    template <class ResidualNBInfo>
+    void computeFlux_(ADVectorBlock& adres,
+                      ADVectorBlock& darcyFlux,
+                      unsigned globI,
+                      unsigned globJ,
+                      const IntensiveQuantities& intQuantsIn,
+                      const IntensiveQuantities& intQuantsEx,
+                      const ResidualNBInfo& res_nbinfo,
+                      bool useMirror = true) const
+    {
+        // the mirror is a copy of the cached intensive quantities, so it must not be
+        // used for intensive quantities which were obtained otherwise
+        if constexpr (HasIntensiveQuantityMirror_<Model>::value)
+            LocalResidual::computeFlux(adres, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, res_nbinfo,
+                                       useMirror ? model_().intensiveQuantityMirror() : nullptr);
+        else
+            LocalResidual::computeFlux(adres, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, res_nbinfo);
+    }
+
+    // compute the source term of a cell. if dense is true, the sparse source terms
+    // (i.e., the wells) are excluded. the intensive quantities and the neighbors of the
+    // cell are only passed to local residuals which use them.
+    template <class NeighborInfoRange>
+    void computeSource_(ADVectorBlock& adres,
+                        const IntensiveQuantities& intQuants,
+                        unsigned globI,
+                        const NeighborInfoRange& nbInfos,
+                        bool dense) const
+    {
+        if (dense) {
+            if constexpr (HasNeighborSourceDense_<LocalResidual, NeighborInfoRange>::value)
+                LocalResidual::computeSourceDense(adres, problem_(), intQuants, globI, nbInfos, 0);
+            else
+                LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
+        }
+        else {
+            if constexpr (HasNeighborSource_<LocalResidual, NeighborInfoRange>::value)
+                LocalResidual::computeSource(adres, problem_(), intQuants, globI, nbInfos, 0);
+            else
+                LocalResidual::computeSource(adres, problem_(), globI, 0);
+        }
+    }
+
     void updateStoredTransmissibilities()
     {
         if (neighborInfo_.empty()) {
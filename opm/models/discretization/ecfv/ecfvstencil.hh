@@ -28,6 +28,7 @@
 #ifndef EWOMS_ECFV_STENCIL_HH
 #define EWOMS_ECFV_STENCIL_HH
 
+#include <opm/models/discretization/common/reorderedelementmapper.hh>
 #include <opm/models/utils/quadraturegeometries.hh>
 
 #include <opm/material/common/ConditionalStorage.hpp>
@@ -65,7 +66,7 @@ class EcfvStencil
     using Intersection = typename GridView::Intersection;
     using Element = typename GridView::template Codim<0>::Entity;
 
-    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = ReorderedElementMapper<GridView>;
 
     using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
 
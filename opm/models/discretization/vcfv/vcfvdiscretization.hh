@@ -39,6 +39,10 @@
 #include <opm/simulators/linalg/vertexborderlistfromgrid.hh>
 #include <opm/models/discretization/common/fvbasediscretization.hh>
 
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+
 #if HAVE_DUNE_FEM
 #include <opm/models/discretization/common/fvbasediscretizationfemadapt.hh>
 #include <dune/fem/space/common/functionspace.hh>
@@ -143,6 +147,15 @@ struct LinearizeNonLocalElements<TypeTag, TTag::VcfvDiscretization> { static con
 
 } // namespace Opm::Properties
 
+namespace Opm::Parameters {
+
+//! Do not cache the geometry of the stencils by default
+template<class TypeTag>
+struct EnableVcfvGeometryCache<TypeTag, Properties::TTag::VcfvDiscretization>
+{ static constexpr bool value = false; };
+
+} // namespace Opm::Parameters
+
 namespace Opm {
 
 /*!
@@ -158,13 +171,32 @@ class VcfvDiscretization : public GetPropType<TypeTag, Properties::BaseDiscretiz
     using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+    using GeometryCache = typename Stencil::GeometryCache;
 
     enum { dim = GridView::dimension };
 
 public:
     VcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+        , enableGeometryCache_(Parameters::get<TypeTag, Parameters::EnableVcfvGeometryCache>())
+    {
+        // stencils which outlive a grid adaptation must not use the old geometry
+        geometryCache_.setGridSequenceNumberFunction([this]()
+            { return this->simulator_.vanguard().gridSequenceNumber(); });
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the model.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        Parameters::registerParam<TypeTag, Parameters::EnableVcfvGeometryCache>
+            ("Store the sub-control volume geometry of all elements instead of "
+             "recomputing it for each element context update");
+    }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -185,6 +217,27 @@ public:
     const DofMapper& dofMapper() const
     { return this->vertexMapper(); }
 
+    /*!
+     * \brief Prepare the stencil of an element context.
+     *
+     * If the geometry cache is enabled, it is (re-)built if required and attached to
+     * the stencil.
+     */
+    void initStencil(Stencil& stencil) const
+    {
+        if (!enableGeometryCache_)
+            return;
+
+        updateGeometryCache_();
+        stencil.setGeometryCache(&geometryCache_);
+    }
+
+    /*!
+     * \brief Returns the number of bytes occupied by the geometry cache.
+     */
+    std::size_t geometryCacheMemoryUsage() const
+    { return geometryCache_.memoryUsage(); }
+
     /*!
      * \brief Serializes the current state of the model.
      *
@@ -211,10 +264,40 @@ public:
     }
 
 private:
+    // compute the geometry of all elements if the grid has changed since the cache
+    // was built. element contexts may be created concurrently, so this is serialized.
+    void updateGeometryCache_() const
+    {
+        std::lock_guard<std::mutex> lock(geometryCacheMutex_);
+
+        const int sequenceNumber = this->simulator_.vanguard().gridSequenceNumber();
+        if (geometryCache_.sequenceNumber() == sequenceNumber)
+            return;
+
+        geometryCache_.clear();
+        geometryCache_.resize(static_cast<std::size_t>(this->gridView_.size(/*codim=*/0)));
+
+        Stencil stencil(this->gridView_, dofMapper());
+        for (const auto& elem : elements(this->gridView_)) {
+            stencil.update(elem);
+            geometryCache_.store(static_cast<unsigned>(this->gridView_.indexSet().index(elem)), stencil);
+        }
+        geometryCache_.setSequenceNumber(sequenceNumber);
+
+        if (this->gridView_.comm().rank() == 0)
+            std::cout << "VCFV geometry cache: "
+                      << geometryCache_.memoryUsage()/1024 << " KiB on rank 0\n"
+                      << std::flush;
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    bool enableGeometryCache_;
+    mutable GeometryCache geometryCache_;
+    mutable std::mutex geometryCacheMutex_;
 };
 } // namespace Opm
 
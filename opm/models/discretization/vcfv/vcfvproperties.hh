@@ -48,4 +48,18 @@ struct UseP1FiniteElementGradients { using type = UndefinedProperty; };
 
 } // namespace Opm::Properties
 
+namespace Opm::Parameters {
+
+/*!
+ * \brief Specify whether the sub-control volume geometry of all elements should be
+ *        cached instead of being recomputed whenever a stencil is updated.
+ *
+ * This potentially reduces the CPU time of the linearization, but comes at the cost of
+ * considerably higher memory consumption.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableVcfvGeometryCache { using type = Properties::UndefinedProperty; };
+
+} // namespace Opm::Parameters
+
 #endif
@@ -40,7 +40,12 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace Opm {
@@ -808,10 +813,215 @@ public:
     //! compatibility alias
     using BoundaryFace = SubControlVolumeFace;
 
+    /*!
+     * \brief Stores the geometric quantities of the stencils of all elements of a
+     *        grid.
+     *
+     * The sub-control volume geometry of an element does not change as long as the
+     * grid is not modified, so it only needs to be computed once. Since this requires a
+     * considerable amount of memory (see memoryUsage()), stencils only use the cache if
+     * it is explicitly attached via VcfvStencil::setGeometryCache().
+     *
+     * The cache remembers the sequence number of the grid for which it was built and
+     * stencils only use it if it matches the one of the current grid.
+     */
+    class GeometryCache
+    {
+        struct ElementData
+        {
+            LocalPosition localCenter;
+            GlobalPosition center;
+            Scalar volume;
+            unsigned scvOffset;
+            unsigned faceOffset;
+            unsigned faceCenterOffset;
+            unsigned boundaryFaceOffset;
+            unsigned short numBoundaryFaces;
+            bool isValid;
+        };
+
+    public:
+        GeometryCache()
+            : sequenceNumber_(-1)
+        {}
+
+        /*!
+         * \brief Specify the function which returns the sequence number of the current
+         *        grid.
+         */
+        void setGridSequenceNumberFunction(std::function<int()> fn)
+        { gridSequenceNumber_ = std::move(fn); }
+
+        /*!
+         * \brief Remove all cached elements.
+         */
+        void clear()
+        {
+            sequenceNumber_.store(-1, std::memory_order_release);
+            elementData_.clear();
+            scvLocal_.clear();
+            scvGlobal_.clear();
+            scvVolumes_.clear();
+            interiorFaces_.clear();
+            edgeCenters_.clear();
+            faceCenters_.clear();
+            boundaryFaces_.clear();
+        }
+
+        /*!
+         * \brief Prepare the cache for a given number of elements.
+         */
+        void resize(std::size_t numElements)
+        {
+            ElementData invalidData{};
+            invalidData.isValid = false;
+            elementData_.assign(numElements, invalidData);
+        }
+
+        /*!
+         * \brief Copy the geometry of a stencil which was updated for a given element.
+         *
+         * This method must not be called concurrently.
+         */
+        void store(unsigned elemIdx, const VcfvStencil& stencil)
+        {
+            auto& data = elementData_[elemIdx];
+            data.localCenter = stencil.elementLocal;
+            data.center = stencil.elementGlobal;
+            data.volume = stencil.elementVolume;
+
+            data.scvOffset = static_cast<unsigned>(scvVolumes_.size());
+            for (unsigned scvIdx = 0; scvIdx < stencil.numVertices; ++scvIdx) {
+                scvLocal_.push_back(stencil.subContVol[scvIdx].local);
+                scvGlobal_.push_back(stencil.subContVol[scvIdx].global);
+                scvVolumes_.push_back(stencil.subContVol[scvIdx].volume_);
+            }
+
+            data.faceOffset = static_cast<unsigned>(interiorFaces_.size());
+            interiorFaces_.insert(interiorFaces_.end(),
+                                  stencil.subContVolFace,
+                                  stencil.subContVolFace + stencil.numEdges);
+            edgeCenters_.insert(edgeCenters_.end(),
+                                stencil.edgeCoord,
+                                stencil.edgeCoord + stencil.numEdges);
+
+            data.faceCenterOffset = static_cast<unsigned>(faceCenters_.size());
+            faceCenters_.insert(faceCenters_.end(),
+                                stencil.faceCoord,
+                                stencil.faceCoord + stencil.numFaces);
+
+            data.boundaryFaceOffset = static_cast<unsigned>(boundaryFaces_.size());
+            data.numBoundaryFaces = static_cast<unsigned short>(stencil.numBoundarySegments_);
+            boundaryFaces_.insert(boundaryFaces_.end(),
+                                  stencil.boundaryFace_,
+                                  stencil.boundaryFace_ + stencil.numBoundarySegments_);
+
+            data.isValid = true;
+        }
+
+        /*!
+         * \brief Copy the cached geometry of an element to a stencil.
+         *
+         * The number of vertices, edges and faces of the stencil must already be set
+         * for the element.
+         */
+        void restore(unsigned elemIdx, VcfvStencil& stencil) const
+        {
+            const auto& data = elementData_[elemIdx];
+            stencil.elementLocal = data.localCenter;
+            stencil.elementGlobal = data.center;
+            stencil.elementVolume = data.volume;
+
+            for (unsigned scvIdx = 0; scvIdx < stencil.numVertices; ++scvIdx) {
+                auto& scv = stencil.subContVol[scvIdx];
+                scv.local = scvLocal_[data.scvOffset + scvIdx];
+                scv.global = scvGlobal_[data.scvOffset + scvIdx];
+                scv.volume_ = scvVolumes_[data.scvOffset + scvIdx];
+            }
+
+            std::copy_n(interiorFaces_.begin() + data.faceOffset,
+                        stencil.numEdges,
+                        stencil.subContVolFace);
+            std::copy_n(edgeCenters_.begin() + data.faceOffset,
+                        stencil.numEdges,
+                        stencil.edgeCoord);
+            std::copy_n(faceCenters_.begin() + data.faceCenterOffset,
+                        stencil.numFaces,
+                        stencil.faceCoord);
+
+            stencil.numBoundarySegments_ = data.numBoundaryFaces;
+            std::copy_n(boundaryFaces_.begin() + data.boundaryFaceOffset,
+                        data.numBoundaryFaces,
+                        stencil.boundaryFace_);
+        }
+
+        /*!
+         * \brief Returns true if the cache was built for the current grid.
+         *
+         * This method may be called concurrently.
+         */
+        bool isCurrent() const
+        {
+            const int sequenceNumber = sequenceNumber_.load(std::memory_order_acquire);
+            return sequenceNumber >= 0 && gridSequenceNumber_ && gridSequenceNumber_() == sequenceNumber;
+        }
+
+        /*!
+         * \brief Returns true if the geometry of a given element is cached.
+         */
+        bool contains(unsigned elemIdx) const
+        { return elemIdx < elementData_.size() && elementData_[elemIdx].isValid; }
+
+        /*!
+         * \brief The sequence number of the grid for which the cache was built.
+         *
+         * This is -1 if the cache is empty.
+         */
+        int sequenceNumber() const
+        { return sequenceNumber_.load(std::memory_order_acquire); }
+
+        /*!
+         * \brief Set the sequence number of the grid for which the cache was built.
+         *
+         * This must be called after all elements have been stored.
+         */
+        void setSequenceNumber(int value)
+        { sequenceNumber_.store(value, std::memory_order_release); }
+
+        /*!
+         * \brief Returns the number of bytes occupied by the cache.
+         */
+        std::size_t memoryUsage() const
+        {
+            return
+                elementData_.capacity()*sizeof(ElementData)
+                + scvLocal_.capacity()*sizeof(LocalPosition)
+                + scvGlobal_.capacity()*sizeof(GlobalPosition)
+                + scvVolumes_.capacity()*sizeof(Scalar)
+                + interiorFaces_.capacity()*sizeof(SubControlVolumeFace)
+                + edgeCenters_.capacity()*sizeof(GlobalPosition)
+                + faceCenters_.capacity()*sizeof(GlobalPosition)
+                + boundaryFaces_.capacity()*sizeof(BoundaryFace);
+        }
+
+    private:
+        std::vector<ElementData> elementData_;
+        std::vector<LocalPosition> scvLocal_;
+        std::vector<GlobalPosition> scvGlobal_;
+        std::vector<Scalar> scvVolumes_;
+        std::vector<SubControlVolumeFace> interiorFaces_;
+        std::vector<GlobalPosition> edgeCenters_;
+        std::vector<GlobalPosition> faceCenters_;
+        std::vector<BoundaryFace> boundaryFaces_;
+        std::function<int()> gridSequenceNumber_;
+        std::atomic<int> sequenceNumber_;
+    };
+
     VcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , vertexMapper_(mapper )
         , element_(*gridView.template begin</*codim=*/0>())
+        , geometryCache_(nullptr)
     {
         // try to check if the mapper really maps the vertices
         assert(static_cast<int>(gridView.size(/*codim=*/dimWorld)) == static_cast<int>(mapper.size()));
@@ -835,17 +1045,10 @@ public:
      */
     void updateTopology(const Element& e)
     {
-        element_ = e;
-
-        numVertices = e.subEntities(/*codim=*/dim);
-        numEdges = e.subEntities(/*codim=*/dim-1);
-        numFaces = (dim<3)?0:e.subEntities(/*codim=*/1);
-
-        numBoundarySegments_ = 0; // TODO: really required here(?)
+        updateEntityCounts_(e);
 
         // compute the local and global coordinates of the element
         const Geometry& geometry = e.geometry();
-        geometryType_ = geometry.type();
         const auto& referenceElement = Dune::ReferenceElements<CoordScalar,dim>::general(geometryType_);
         for (unsigned vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
             subContVol[vertexIdx].local = referenceElement.position(static_cast<int>(vertexIdx), dim);
@@ -861,8 +1064,28 @@ public:
         updateTopology(element);
     }
 
+    /*!
+     * \brief Use a cache for the geometric quantities of the elements.
+     *
+     * If the cache was built for the current grid and contains the element passed to
+     * update(), the geometry is copied from the cache instead of being recomputed. Pass
+     * nullptr to disable the cache.
+     */
+    void setGeometryCache(const GeometryCache* cache)
+    { geometryCache_ = cache; }
+
     void update(const Element& e)
     {
+        if (geometryCache_ && geometryCache_->isCurrent()) {
+            const auto elemIdx = static_cast<unsigned>(gridView_.indexSet().index(e));
+            if (geometryCache_->contains(elemIdx)) {
+                updateEntityCounts_(e);
+                geometryCache_->restore(elemIdx, *this);
+                updateScvGeometry(e);
+                return;
+            }
+        }
+
         updateTopology(e);
 
         const Geometry& geometry = e.geometry();
@@ -1111,6 +1334,20 @@ private:
 #pragma GCC diagnostic ignored "-Wpragmas"
 #pragma GCC diagnostic ignored "-Warray-bounds"
 #endif
+    // update the element and the numbers of its sub-entities
+    void updateEntityCounts_(const Element& e)
+    {
+        element_ = e;
+
+        numVertices = e.subEntities(/*codim=*/dim);
+        numEdges = e.subEntities(/*codim=*/dim-1);
+        numFaces = (dim<3)?0:e.subEntities(/*codim=*/1);
+
+        numBoundarySegments_ = 0; // TODO: really required here(?)
+
+        geometryType_ = e.type();
+    }
+
     void fillSubContVolData_()
     {
         if (dim == 1) {
@@ -1376,6 +1613,8 @@ private:
     //! number of faces (0 in < 3D)
     unsigned numFaces;
     Dune::GeometryType geometryType_;
+
+    const GeometryCache* geometryCache_;
 };
 
 #if HAVE_DUNE_LOCALFUNCTIONS
@@ -27,17 +27,28 @@
 #ifndef EWOMS_BASE_VANGUARD_HH
 #define EWOMS_BASE_VANGUARD_HH
 
+#include <opm/models/discretization/common/dofordering.hh>
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/utils/parametersystem.hh>
 
 #include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/rangegenerators.hh>
 
 #if HAVE_DUNE_FEM
 #include <dune/fem/space/common/dofmanager.hh>
 #endif
 
-#include <type_traits>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Opm {
 
@@ -56,7 +67,11 @@ class BaseVanguard
     using GridPart = GetPropType<TypeTag, Properties::GridPart>;
 #endif
 
+    enum { dimWorld = GridView::dimensionworld };
+
 public:
+    using Ordering = std::vector<unsigned>;
+
     BaseVanguard(Simulator& simulator)
         : simulator_(simulator)
     {}
@@ -100,6 +115,16 @@ public:
     }
 
 
+    /*!
+     * \brief Returns the ordering of the elements of the grid view.
+     *
+     * The ordering contains the index used by the discretization for each index of
+     * Dune::MultipleCodimMultipleGeomTypeMapper. A null pointer means that the
+     * elements are not reordered.
+     */
+    const std::shared_ptr<const Ordering>& elementOrdering() const
+    { return elementOrdering_; }
+
     /*!
      * \brief Distribute the grid (and attached data) over all
      *        processes.
@@ -131,6 +156,68 @@ protected:
         {
             gridView_ = std::make_unique<GridView>(asImp_().grid().leafGridView());
         }
+
+        updateElementOrdering_();
+    }
+
+    void updateElementOrdering_()
+    {
+        elementOrdering_.reset();
+
+        const std::string orderingName = Parameters::get<TypeTag, Parameters::ElementOrdering>();
+        if (orderingName == "none")
+            return;
+        if (orderingName != "rcm" && orderingName != "hilbert")
+            throw std::invalid_argument("Unknown element ordering '" + orderingName + "'. "
+                                        "Valid orderings are 'none', 'rcm' and 'hilbert'");
+
+        // determine the connectivity of the elements in compressed row storage format
+        const GridView& gv = gridView();
+        const Dune::MultipleCodimMultipleGeomTypeMapper<GridView>
+            elementMapper(gv, Dune::mcmgElementLayout());
+        const std::size_t numElements = elementMapper.size();
+
+        std::vector<std::pair<unsigned, unsigned> > connections;
+        std::vector<std::array<double, dimWorld> > centers(numElements);
+        for (const auto& elem : elements(gv)) {
+            const unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+            const auto center = elem.geometry().center();
+            std::copy(center.begin(), center.end(), centers[elemIdx].begin());
+
+            for (const auto& intersection : intersections(gv, elem)) {
+                if (intersection.neighbor())
+                    connections.emplace_back(elemIdx,
+                                             static_cast<unsigned>(elementMapper.index(intersection.outside())));
+            }
+        }
+        std::sort(connections.begin(), connections.end());
+        connections.erase(std::unique(connections.begin(), connections.end()), connections.end());
+
+        std::vector<std::size_t> rowOffsets(numElements + 1, 0);
+        std::vector<unsigned> neighbors(connections.size());
+        for (std::size_t i = 0; i < connections.size(); ++i) {
+            ++rowOffsets[connections[i].first + 1];
+            neighbors[i] = connections[i].second;
+        }
+        for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx)
+            rowOffsets[elemIdx + 1] += rowOffsets[elemIdx];
+
+        auto ordering = std::make_shared<Ordering>();
+        if (orderingName == "rcm")
+            *ordering = DofOrdering::reverseCuthillMcKee(rowOffsets, neighbors);
+        else
+            *ordering = DofOrdering::hilbertCurve<dimWorld>(centers);
+
+        if (gv.comm().rank() == 0)
+            std::cout << "Element ordering '" << orderingName << "': bandwidth "
+                      << DofOrdering::bandwidth(rowOffsets, neighbors) << " -> "
+                      << DofOrdering::bandwidth(rowOffsets, neighbors, *ordering)
+                      << ", average neighbor distance "
+                      << DofOrdering::averageNeighborDistance(rowOffsets, neighbors) << " -> "
+                      << DofOrdering::averageNeighborDistance(rowOffsets, neighbors, *ordering)
+                      << "\n" << std::flush;
+
+        elementOrdering_ = std::move(ordering);
     }
 
 private:
@@ -145,6 +232,7 @@ private:
     std::unique_ptr<GridPart> gridPart_;
 #endif
     std::unique_ptr<GridView> gridView_;
+    std::shared_ptr<const Ordering> elementOrdering_;
 };
 
 } // namespace Opm
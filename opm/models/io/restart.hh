@@ -27,18 +27,259 @@
 #ifndef EWOMS_RESTART_HH
 #define EWOMS_RESTART_HH
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 
 /*!
  * \brief Load or save a state of a problem to/from the harddisk.
+ *
+ * Restart files are written either in a binary or in a text format. The binary format
+ * consists of a magic string followed by a sequence of sections. Each section starts
+ * with its name, followed by the size of its payload, the payload itself and the CRC-32
+ * checksum of the payload. All binary data is stored in little-endian byte order. The
+ * format of existing restart files is detected when reading them, i.e., text restart
+ * files written by earlier versions can still be read.
  */
 class Restart
 {
+public:
+    enum class Format {
+        Text,
+        Binary
+    };
+
+private:
+    static constexpr char binaryMagic_[8] = { 'O', 'P', 'M', 'R', 'S', 'T', 'B', '\n' };
+    static constexpr std::uint64_t binaryVersion_ = 2;
+    static constexpr std::uint32_t maxCookieLength_ = 4096;
+
+    /*!
+     * \brief Update a CRC-32 checksum (IEEE 802.3 polynomial) by a chunk of data.
+     */
+    static std::uint32_t crc32Update_(std::uint32_t crc, const char* data, std::size_t size)
+    {
+        static const auto table = [] {
+            std::array<std::uint32_t, 256> result{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                result[i] = c;
+            }
+            return result;
+        }();
+
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    /*!
+     * \brief A stream buffer which forwards the data written to it to another stream
+     *        buffer and keeps track of its size and checksum.
+     */
+    class ChecksumOutBuf_ : public std::streambuf
+    {
+    public:
+        void reset(std::streambuf* sink)
+        {
+            sink_ = sink;
+            crc_ = 0;
+            size_ = 0;
+        }
+
+        std::uint32_t crc() const
+        { return crc_; }
+
+        std::uint64_t size() const
+        { return size_; }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (traits_type::eq_int_type(ch, traits_type::eof()))
+                return traits_type::not_eof(ch);
+
+            char c = traits_type::to_char_type(ch);
+            return (xsputn(&c, 1) == 1) ? ch : traits_type::eof();
+        }
+
+        std::streamsize xsputn(const char* data, std::streamsize size) override
+        {
+            std::streamsize n = sink_->sputn(data, size);
+            if (n > 0) {
+                crc_ = crc32Update_(crc_, data, static_cast<std::size_t>(n));
+                size_ += static_cast<std::uint64_t>(n);
+            }
+            return n;
+        }
+
+    private:
+        std::streambuf* sink_ = nullptr;
+        std::uint32_t crc_ = 0;
+        std::uint64_t size_ = 0;
+    };
+
+    /*!
+     * \brief A stream buffer which reads the payload of a single section from another
+     *        stream buffer and keeps track of the checksum of the data read.
+     *
+     * Reading beyond the end of the section's payload yields EOF.
+     */
+    class ChecksumInBuf_ : public std::streambuf
+    {
+    public:
+        ChecksumInBuf_()
+            : buffer_(64*1024)
+        { setg(buffer_.data(), buffer_.data(), buffer_.data()); }
+
+        void reset(std::streambuf* source, std::uint64_t size)
+        {
+            source_ = source;
+            remaining_ = size;
+            crc_ = 0;
+            setg(buffer_.data(), buffer_.data(), buffer_.data());
+        }
+
+        std::uint32_t crc() const
+        { return crc_; }
+
+        //! The number of bytes of the section which have not been consumed yet.
+        std::uint64_t unread() const
+        { return remaining_ + static_cast<std::uint64_t>(egptr() - gptr()); }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+
+            if (remaining_ == 0)
+                return traits_type::eof();
+
+            std::streamsize n = static_cast<std::streamsize>(std::min<std::uint64_t>(remaining_, buffer_.size()));
+            n = source_->sgetn(buffer_.data(), n);
+            if (n <= 0)
+                return traits_type::eof();
+
+            consumed_(buffer_.data(), n);
+            setg(buffer_.data(), buffer_.data(), buffer_.data() + n);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        std::streamsize xsgetn(char* dest, std::streamsize size) override
+        {
+            std::streamsize numRead = 0;
+            while (numRead < size) {
+                std::streamsize numBuffered = egptr() - gptr();
+                if (numBuffered > 0) {
+                    std::streamsize n = std::min(numBuffered, size - numRead);
+                    std::memcpy(dest + numRead, gptr(), static_cast<std::size_t>(n));
+                    gbump(static_cast<int>(n));
+                    numRead += n;
+                }
+                else if (size - numRead >= static_cast<std::streamsize>(buffer_.size())) {
+                    // large blocks are read directly into the destination
+                    if (remaining_ == 0)
+                        break;
+                    std::streamsize n = static_cast<std::streamsize>(
+                        std::min<std::uint64_t>(remaining_, static_cast<std::uint64_t>(size - numRead)));
+                    n = source_->sgetn(dest + numRead, n);
+                    if (n <= 0)
+                        break;
+                    consumed_(dest + numRead, n);
+                    numRead += n;
+                }
+                else if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+                    break;
+            }
+            return numRead;
+        }
+
+    private:
+        void consumed_(const char* data, std::streamsize n)
+        {
+            remaining_ -= static_cast<std::uint64_t>(n);
+            crc_ = crc32Update_(crc_, data, static_cast<std::size_t>(n));
+        }
+
+        std::vector<char> buffer_;
+        std::streambuf* source_ = nullptr;
+        std::uint64_t remaining_ = 0;
+        std::uint32_t crc_ = 0;
+    };
+
+    static bool hostIsLittleEndian_()
+    {
+        const std::uint16_t probe = 1;
+        return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+    }
+
+    /*!
+     * \brief Write an array of values in little-endian byte order to a stream.
+     */
+    template <class T>
+    static void writeValues_(std::ostream& os, const T* values, std::size_t n)
+    {
+        if (hostIsLittleEndian_()) {
+            os.write(reinterpret_cast<const char*>(values),
+                     static_cast<std::streamsize>(n*sizeof(T)));
+            return;
+        }
+
+        char tmp[sizeof(T)];
+        for (std::size_t i = 0; i < n; ++i) {
+            std::memcpy(tmp, &values[i], sizeof(T));
+            std::reverse(tmp, tmp + sizeof(T));
+            os.write(tmp, sizeof(T));
+        }
+    }
+
+    /*!
+     * \brief Read an array of values in little-endian byte order from a stream.
+     */
+    template <class T>
+    static void readValues_(std::istream& is, T* values, std::size_t n)
+    {
+        is.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(n*sizeof(T)));
+        if (hostIsLittleEndian_())
+            return;
+
+        char tmp[sizeof(T)];
+        for (std::size_t i = 0; i < n; ++i) {
+            std::memcpy(tmp, &values[i], sizeof(T));
+            std::reverse(tmp, tmp + sizeof(T));
+            std::memcpy(&values[i], tmp, sizeof(T));
+        }
+    }
+
+    template <class T>
+    static void writeValue_(std::ostream& os, T value)
+    { writeValues_(os, &value, 1); }
+
+    template <class T>
+    static T readValue_(std::istream& is)
+    {
+        T value{};
+        readValues_(is, &value, 1);
+        return value;
+    }
+
     /*!
      * \brief Create a magic cookie for restart files, so that it is
      *        unlikely to load a restart file for an incorrectly.
@@ -66,6 +307,26 @@ class Restart
         return oss.str();
     }
 
+    /*!
+     * \brief Create the header of binary restart files.
+     *
+     * This is the binary counterpart of magicRestartCookie_().
+     */
+    template <class GridView>
+    static std::array<std::uint64_t, 6> binaryRestartHeader_(const GridView& gridView)
+    {
+        static const int dim = GridView::dimension;
+
+        return {
+            binaryVersion_,
+            static_cast<std::uint64_t>(gridView.comm().size()),
+            static_cast<std::uint64_t>(gridView.comm().rank()),
+            static_cast<std::uint64_t>(gridView.size(0)),
+            static_cast<std::uint64_t>(gridView.size(dim - 1)),
+            static_cast<std::uint64_t>(gridView.size(dim))
+        };
+    }
+
     /*!
      * \brief Return the restart file name.
      */
@@ -88,27 +349,60 @@ class Restart
     }
 
 public:
+    /*!
+     * \brief Create a restarter.
+     *
+     * \param format The format used for writing restart files. When reading restart
+     *               files, the format is determined from the file's content.
+     */
+    explicit Restart(Format format = Format::Binary)
+        : format_(format)
+        , binaryOutStream_(&binaryOutBuf_)
+        , binaryInStream_(&binaryInBuf_)
+    {
+        binaryOutStream_.precision(20);
+    }
+
     /*!
      * \brief Returns the name of the file which is (de-)serialized.
      */
     const std::string& fileName() const
     { return fileName_; }
 
+    /*!
+     * \brief Returns the format of the file which is currently (de-)serialized.
+     */
+    Format format() const
+    { return format_; }
+
     /*!
      * \brief Write the current state of the model to disk.
      */
     template <class Simulator>
     void serializeBegin(Simulator& simulator)
     {
-        const std::string magicCookie = magicRestartCookie_(simulator.gridView());
         fileName_ = restartFileName_(simulator.gridView(),
                                      simulator.problem().outputDir(),
                                      simulator.problem().name(),
                                      simulator.time());
 
+        if (format_ == Format::Binary) {
+            // open output file and write the magic string and the header
+            openOutStream_(std::ios::out | std::ios::binary);
+            outStream_().write(binaryMagic_, sizeof(binaryMagic_));
+
+            const auto header = binaryRestartHeader_(simulator.gridView());
+            serializeSectionBegin("Header");
+            serializeBlock(header.data(), header.size());
+            serializeSectionEnd();
+            return;
+        }
+
+        const std::string magicCookie = magicRestartCookie_(simulator.gridView());
+
         // open output file and write magic cookie
-        outStream_.open(fileName_.c_str());
-        outStream_.precision(20);
+        openOutStream_(std::ios::out);
+        outStream_().precision(20);
 
         serializeSectionBegin(magicCookie);
         serializeSectionEnd();
@@ -118,24 +412,81 @@ public:
      * \brief The output stream to write the serialized data.
      */
     std::ostream& serializeStream()
-    { return outStream_; }
+    { return (format_ == Format::Binary) ? binaryOutStream_ : outStream_(); }
 
     /*!
      * \brief Start a new section in the serialized output.
      */
     void serializeSectionBegin(const std::string& cookie)
-    { outStream_ << cookie << "\n"; }
+    {
+        if (format_ == Format::Binary) {
+            writeValue_(outStream_(), static_cast<std::uint32_t>(cookie.size()));
+            outStream_().write(cookie.data(), static_cast<std::streamsize>(cookie.size()));
+
+            // the size of the payload is not known yet, so we write a placeholder
+            // which is overwritten at the end of the section
+            sectionSizePos_ = outStream_().tellp();
+            writeValue_(outStream_(), std::uint64_t{0});
+            binaryOutBuf_.reset(outStream_().rdbuf());
+            binaryOutStream_.clear();
+            return;
+        }
+
+        outStream_() << cookie << "\n";
+    }
 
     /*!
      * \brief End of a section in the serialized output.
      */
     void serializeSectionEnd()
-    { outStream_ << "\n"; }
+    {
+        if (format_ == Format::Binary) {
+            binaryOutStream_.flush();
+
+            const auto endPos = outStream_().tellp();
+            outStream_().seekp(sectionSizePos_);
+            writeValue_(outStream_(), binaryOutBuf_.size());
+            outStream_().seekp(endPos);
+            writeValue_(outStream_(), binaryOutBuf_.crc());
+
+            if (!outStream_().good() || !binaryOutStream_.good())
+                throw std::runtime_error("Could not write to restart file '"+fileName_+"'");
+            return;
+        }
+
+        outStream_() << "\n";
+    }
+
+    /*!
+     * \brief Write a contiguous array of values to the current section.
+     *
+     * For binary restart files, the values are written as raw little-endian data.
+     */
+    template <class T>
+    void serializeBlock(const T* values, std::size_t n)
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Only arrays of trivially copyable values can be serialized as a block");
+
+        auto& os = serializeStream();
+        if (format_ == Format::Binary) {
+            writeValue_(os, static_cast<std::uint64_t>(n));
+            writeValue_(os, static_cast<std::uint32_t>(sizeof(T)));
+            writeValues_(os, values, n);
+            return;
+        }
+
+        os << n << " ";
+        for (std::size_t i = 0; i < n; ++i)
+            os << values[i] << " ";
+    }
 
     /*!
      * \brief Serialize all leaf entities of a codim in a gridView.
      *
-     * The actual work is done by Serializer::serialize(Entity)
+     * For text restart files, the actual work is done by
+     * Serializer::serializeEntity(Entity). For binary restart files, the data of all
+     * entities is written at once by Serializer::serializeBulk(Restart).
      */
     template <int codim, class Serializer, class GridView>
     void serializeEntities(Serializer& serializer, const GridView& gridView)
@@ -145,14 +496,18 @@ public:
         std::string cookie = oss.str();
         serializeSectionBegin(cookie);
 
-        // write element data
-        using Iterator = typename GridView::template Codim<codim>::Iterator;
-
-        Iterator it = gridView.template begin<codim>();
-        const Iterator& endIt = gridView.template end<codim>();
-        for (; it != endIt; ++it) {
-            serializer.serializeEntity(outStream_, *it);
-            outStream_ << "\n";
+        if (format_ == Format::Binary)
+            serializer.serializeBulk(*this);
+        else {
+            // write element data
+            using Iterator = typename GridView::template Codim<codim>::Iterator;
+
+            Iterator it = gridView.template begin<codim>();
+            const Iterator& endIt = gridView.template end<codim>();
+            for (; it != endIt; ++it) {
+                serializer.serializeEntity(outStream_(), *it);
+                outStream_() << "\n";
+            }
         }
 
         serializeSectionEnd();
@@ -162,7 +517,66 @@ public:
      * \brief Finish the restart file.
      */
     void serializeEnd()
-    { outStream_.close(); }
+    {
+        if (!staged_)
+            fileOutStream_.close();
+    }
+
+    /*!
+     * \brief Specify whether the restart file is written to an in-memory staging
+     *        buffer instead of directly to disk.
+     *
+     * If staging is enabled, serializeBegin() ... serializeEnd() only fill the
+     * staging buffer and the file is written by commitStaged(). Since the staged
+     * data is independent of the simulator's state, commitStaged() may be called
+     * from a different thread while the simulation proceeds.
+     */
+    void setStaged(bool yesno)
+    { staged_ = yesno; }
+
+    /*!
+     * \brief Returns true if the restart file is written to a staging buffer.
+     */
+    bool staged() const
+    { return staged_; }
+
+    /*!
+     * \brief Returns the number of bytes which are currently in the staging buffer.
+     */
+    std::size_t stagedSize()
+    {
+        const auto pos = stagingOutStream_.tellp();
+        return (pos < 0) ? 0 : static_cast<std::size_t>(pos);
+    }
+
+    /*!
+     * \brief Write the content of the staging buffer to the restart file.
+     *
+     * The data is first written to a temporary file which is then renamed, so
+     * an interrupted write never leaves a truncated restart file behind. The
+     * staging buffer is released afterwards.
+     */
+    void commitStaged()
+    {
+        if (!staged_)
+            throw std::logic_error("Restart::commitStaged() called for a non-staged restart file");
+
+        const std::string tmpFileName = fileName_ + ".tmp";
+        {
+            std::ofstream os(tmpFileName, std::ios::out | std::ios::binary);
+            stagingOutStream_.seekg(0);
+            os << stagingOutStream_.rdbuf();
+            os.close();
+            if (!os.good())
+                throw std::runtime_error("Could not write to restart file '"+tmpFileName+"'");
+        }
+
+        if (std::rename(tmpFileName.c_str(), fileName_.c_str()) != 0)
+            throw std::runtime_error("Could not rename restart file '"+tmpFileName
+                                     +"' to '"+fileName_+"'");
+
+        std::stringstream().swap(stagingOutStream_);
+    }
 
     /*!
      * \brief Start reading a restart file at a certain simulated
@@ -174,7 +588,7 @@ public:
         fileName_ = restartFileName_(simulator.gridView(), simulator.problem().outputDir(), simulator.problem().name(), t);
 
         // open input file and read magic cookie
-        inStream_.open(fileName_.c_str());
+        inStream_.open(fileName_.c_str(), std::ios::in | std::ios::binary);
         if (!inStream_.good()) {
             throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
         }
@@ -187,6 +601,30 @@ public:
         }
         inStream_.seekg(0, std::ios::beg);
 
+        // find out whether we deal with a binary or a text restart file
+        char magic[sizeof(binaryMagic_)] = {};
+        inStream_.read(magic, sizeof(magic));
+        if (inStream_.good() && std::equal(magic, magic + sizeof(magic), binaryMagic_)) {
+            format_ = Format::Binary;
+
+            std::array<std::uint64_t, 6> header;
+            deserializeSectionBegin("Header");
+            deserializeBlock(header.data(), header.size());
+            deserializeSectionEnd();
+
+            if (header[0] != binaryVersion_)
+                throw std::runtime_error("Restart file '"+fileName_+"' uses the unsupported format version "
+                                         +std::to_string(header[0]));
+            if (header != binaryRestartHeader_(simulator.gridView()))
+                throw std::runtime_error("Restart file '"+fileName_+"' does not match the grid "
+                                         "or the number of processes of the simulation");
+            return;
+        }
+
+        format_ = Format::Text;
+        inStream_.clear();
+        inStream_.seekg(0, std::ios::beg);
+
         const std::string magicCookie = magicRestartCookie_(simulator.gridView());
 
         deserializeSectionBegin(magicCookie);
@@ -198,7 +636,7 @@ public:
      *        deserialized.
      */
     std::istream& deserializeStream()
-    { return inStream_; }
+    { return (format_ == Format::Binary) ? binaryInStream_ : inStream_; }
 
     /*!
      * \brief Start reading a new section of the restart file.
@@ -207,6 +645,23 @@ public:
     {
         if (!inStream_.good())
             throw std::runtime_error("Encountered unexpected EOF in restart file.");
+
+        if (format_ == Format::Binary) {
+            const auto cookieLen = readValue_<std::uint32_t>(inStream_);
+            if (!inStream_.good() || cookieLen > maxCookieLength_)
+                throw std::runtime_error("Could not start section '"+cookie+"'");
+            std::string buf(cookieLen, '\0');
+            inStream_.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            const auto payloadSize = readValue_<std::uint64_t>(inStream_);
+            if (!inStream_.good() || buf != cookie)
+                throw std::runtime_error("Could not start section '"+cookie+"'");
+
+            sectionName_ = cookie;
+            binaryInBuf_.reset(inStream_.rdbuf(), payloadSize);
+            binaryInStream_.clear();
+            return;
+        }
+
         std::string buf;
         std::getline(inStream_, buf);
         if (buf != cookie)
@@ -218,6 +673,26 @@ public:
      */
     void deserializeSectionEnd()
     {
+        if (format_ == Format::Binary) {
+            // skip the remaining whitespace of the section and verify its checksum
+            std::vector<char> rest(binaryInBuf_.unread());
+            binaryInStream_.clear();
+            binaryInStream_.read(rest.data(), static_cast<std::streamsize>(rest.size()));
+            for (char c : rest) {
+                if (!std::isspace(static_cast<unsigned char>(c))) {
+                    throw std::logic_error("Encountered unread values while deserializing");
+                }
+            }
+
+            const auto crc = readValue_<std::uint32_t>(inStream_);
+            if (!inStream_.good())
+                throw std::runtime_error("Encountered unexpected EOF in restart file.");
+            if (crc != binaryInBuf_.crc())
+                throw std::runtime_error("Checksum mismatch in section '"+sectionName_
+                                         +"' of restart file '"+fileName_+"'");
+            return;
+        }
+
         std::string dummy;
         std::getline(inStream_, dummy);
         for (unsigned i = 0; i < dummy.length(); ++i) {
@@ -227,10 +702,49 @@ public:
         }
     }
 
+    /*!
+     * \brief Read a contiguous array of values from the current section.
+     *
+     * This is the counterpart of serializeBlock(). The number of values must match
+     * the one of the serialized array.
+     */
+    template <class T>
+    void deserializeBlock(T* values, std::size_t n)
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "Only arrays of trivially copyable values can be deserialized as a block");
+
+        auto& is = deserializeStream();
+        std::uint64_t numValues = 0;
+        std::uint32_t valueSize = sizeof(T);
+        if (format_ == Format::Binary) {
+            numValues = readValue_<std::uint64_t>(is);
+            valueSize = readValue_<std::uint32_t>(is);
+        }
+        else
+            is >> numValues;
+
+        if (!is.good() || numValues != n || valueSize != sizeof(T))
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted: expected a block of "
+                                     +std::to_string(n)+" values of size "+std::to_string(sizeof(T)));
+
+        if (format_ == Format::Binary)
+            readValues_(is, values, n);
+        else {
+            for (std::size_t i = 0; i < n; ++i)
+                is >> values[i];
+        }
+
+        if (is.fail())
+            throw std::runtime_error("Restart file '"+fileName_+"' is corrupted");
+    }
+
     /*!
      * \brief Deserialize all leaf entities of a codim in a grid.
      *
-     * The actual work is done by Deserializer::deserialize(Entity)
+     * For text restart files, the actual work is done by
+     * Deserializer::deserializeEntity(Entity). For binary restart files, the data of
+     * all entities is read at once by Deserializer::deserializeBulk(Restart).
      */
     template <int codim, class Deserializer, class GridView>
     void deserializeEntities(Deserializer& deserializer, const GridView& gridView)
@@ -240,6 +754,12 @@ public:
         std::string cookie = oss.str();
         deserializeSectionBegin(cookie);
 
+        if (format_ == Format::Binary) {
+            deserializer.deserializeBulk(*this);
+            deserializeSectionEnd();
+            return;
+        }
+
         std::string curLine;
 
         // read entity data
@@ -266,9 +786,39 @@ public:
     { inStream_.close(); }
 
 private:
+    std::ostream& outStream_()
+    {
+        if (staged_)
+            return stagingOutStream_;
+        return fileOutStream_;
+    }
+
+    void openOutStream_(std::ios::openmode mode)
+    {
+        if (staged_) {
+            std::stringstream().swap(stagingOutStream_);
+            stagingOutStream_.precision(20);
+            return;
+        }
+
+        fileOutStream_.open(fileName_.c_str(), mode);
+        if (!fileOutStream_.good())
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened for writing");
+    }
+
+    Format format_;
     std::string fileName_;
+    std::string sectionName_;
     std::ifstream inStream_;
-    std::ofstream outStream_;
+    std::ofstream fileOutStream_;
+    std::stringstream stagingOutStream_;
+    bool staged_ = false;
+    std::streampos sectionSizePos_;
+
+    ChecksumOutBuf_ binaryOutBuf_;
+    ChecksumInBuf_ binaryInBuf_;
+    std::ostream binaryOutStream_;
+    std::istream binaryInStream_;
 };
 } // namespace Opm
 
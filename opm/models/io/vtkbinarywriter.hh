@@ -0,0 +1,533 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::VtkBinaryWriter
+ */
+#ifndef EWOMS_VTK_BINARY_WRITER_HH
+#define EWOMS_VTK_BINARY_WRITER_HH
+
+#include <opm/models/discretization/common/reorderedelementmapper.hh>
+#include <opm/models/io/baseoutputwriter.hh>
+
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Writes the output of a time step to VTK XML files with appended binary
+ *        data, which is optionally compressed using zlib.
+ *
+ * In contrast to Dune::VTKWriter, the values of the fields are directly read from
+ * the output buffers and the fields are encoded in parallel. Each process writes its
+ * own piece of the grid and the first process additionally writes a .pvtu file
+ * which references the pieces of all processes. The geometry of the grid is only
+ * encoded once and reused until gridChanged() is called.
+ */
+template <class GridView>
+class VtkBinaryWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using ElementMapper = ReorderedElementMapper<GridView>;
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    // a field which ought to be written. exactly one of the buffer pointers is set.
+    struct Field
+    {
+        std::string name;
+        int codim;
+        unsigned numComponents;
+        const ScalarBuffer* scalarBuf = nullptr;
+        const VectorBuffer* vectorBuf = nullptr;
+        const TensorBuffer* tensorBuf = nullptr;
+        unsigned colIdx = 0;
+
+        double value(std::size_t idx, unsigned compIdx) const
+        {
+            if (scalarBuf)
+                return (*scalarBuf)[idx];
+            if (vectorBuf)
+                return (compIdx < (*vectorBuf)[idx].size()) ? (*vectorBuf)[idx][compIdx] : 0.0;
+            return (*tensorBuf)[idx][compIdx][colIdx];
+        }
+    };
+
+    // the size of the chunks which are compressed independently [bytes]
+    static constexpr std::size_t zlibBlockSize_ = 1 << 16;
+
+public:
+    enum class Encoding { Raw, Zlib };
+
+    VtkBinaryWriter(const GridView& gridView,
+                    const ElementMapper& elementMapper,
+                    const VertexMapper& vertexMapper,
+                    Encoding encoding,
+                    bool singlePrecision)
+        : gridView_(gridView)
+        , elementMapper_(elementMapper)
+        , vertexMapper_(vertexMapper)
+        , encoding_(encoding)
+        , singlePrecision_(singlePrecision)
+        , geometryValid_(false)
+    {
+        if (encoding_ == Encoding::Zlib && !zlibAvailable())
+            throw std::runtime_error("Compressed VTK output was requested, but zlib is not available");
+
+        commRank_ = gridView.comm().rank();
+        commSize_ = gridView.comm().size();
+    }
+
+    /*!
+     * \brief Returns true if the writer was compiled with support for zlib.
+     */
+    static constexpr bool zlibAvailable()
+    {
+#if HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Must be called if the grid was changed.
+     */
+    void gridChanged()
+    { geometryValid_ = false; }
+
+    /*!
+     * \brief Forget about all fields which have been added so far.
+     */
+    void clear()
+    {
+        fields_.clear();
+        encodedFields_.clear();
+    }
+
+    /*!
+     * \brief Add a scalar field for elements (codim 0) or vertices (codim dim).
+     *
+     * The buffer must stay valid until write() has finished.
+     */
+    void addScalarField(const ScalarBuffer& buf, const std::string& name, int codim)
+    {
+        Field field;
+        field.name = name;
+        field.codim = codim;
+        field.numComponents = 1;
+        field.scalarBuf = &buf;
+        fields_.push_back(field);
+    }
+
+    /*!
+     * \brief Add a vector field for elements (codim 0) or vertices (codim dim).
+     *
+     * Like Dune::VTKWriter, two-dimensional vectors are padded to three components.
+     */
+    void addVectorField(const VectorBuffer& buf, const std::string& name, int codim)
+    {
+        Field field;
+        field.name = name;
+        field.codim = codim;
+        field.numComponents = buf.empty() ? 1 : static_cast<unsigned>(buf[0].size());
+        if (field.numComponents == 2)
+            field.numComponents = 3;
+        field.vectorBuf = &buf;
+        fields_.push_back(field);
+    }
+
+    /*!
+     * \brief Add a column of a tensor field for elements (codim 0) or vertices
+     *        (codim dim).
+     */
+    void addTensorField(const TensorBuffer& buf, const std::string& name, int codim, unsigned colIdx)
+    {
+        Field field;
+        field.name = name;
+        field.codim = codim;
+        field.numComponents = static_cast<unsigned>(buf[0].M());
+        field.tensorBuf = &buf;
+        field.colIdx = colIdx;
+        fields_.push_back(field);
+    }
+
+    /*!
+     * \brief Encode all fields which were added since the last call to clear().
+     *
+     * The fields are encoded in parallel by the OpenMP threads of the calling thread.
+     * If the output is written asynchronously, this should be called before the
+     * writing is dispatched, so that no second team of threads is started while the
+     * main thread is busy with the simulation.
+     */
+    void encode()
+    {
+        if (!geometryValid_)
+            updateGeometry_();
+
+        const int numFields = static_cast<int>(fields_.size());
+        std::vector<std::string> encodedFields(fields_.size());
+        std::exception_ptr exceptionPtr = nullptr;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int fieldIdx = 0; fieldIdx < numFields; ++fieldIdx) {
+            try {
+                const Field& field = fields_[fieldIdx];
+                const auto& order = (field.codim == 0) ? cellOrder_ : pointOrder_;
+                if (singlePrecision_)
+                    encodedFields[fieldIdx] = encodeField_<float>(field, order);
+                else
+                    encodedFields[fieldIdx] = encodeField_<double>(field, order);
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                exceptionPtr = std::current_exception();
+            }
+        }
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        encodedFields_ = std::move(encodedFields);
+    }
+
+    /*!
+     * \brief Write all fields which were added since the last call to clear().
+     *
+     * The fields are encoded first unless encode() has been called after the last
+     * field was added and the grid was not changed since then. The encoded fields
+     * are discarded after they have been written.
+     *
+     * \return The path of the written .vtu file in the sequential case and the
+     *         path of the .pvtu file in the parallel case.
+     */
+    std::string write(const std::string& outputDir, const std::string& name)
+    {
+        if (!geometryValid_ || encodedFields_.size() != fields_.size())
+            encode();
+
+        std::string pieceName = name;
+        if (commSize_ > 1)
+            pieceName = pieceFileName_(name, commRank_);
+        writePiece_(outputDir + "/" + pieceName + ".vtu", encodedFields_);
+
+        // the encoded data is not needed anymore
+        encodedFields_.clear();
+
+        if (commSize_ == 1)
+            return outputDir + "/" + pieceName + ".vtu";
+
+        const std::string pvtuFileName = outputDir + "/" + name + ".pvtu";
+        if (commRank_ == 0)
+            writeParallelHeader_(pvtuFileName, name);
+        return pvtuFileName;
+    }
+
+private:
+    static std::string pieceFileName_(const std::string& name, int rank)
+    {
+        std::ostringstream oss;
+        oss << name << "-p" << std::setw(4) << std::setfill('0') << rank;
+        return oss.str();
+    }
+
+    static const char* byteOrder_()
+    {
+        const std::uint16_t probe = 1;
+        unsigned char firstByte;
+        std::memcpy(&firstByte, &probe, 1);
+        return (firstByte == 1) ? "LittleEndian" : "BigEndian";
+    }
+
+    const char* floatTypeName_() const
+    { return singlePrecision_ ? "Float32" : "Float64"; }
+
+    // collect the points and cells of the interior partition in the order in which
+    // they are written
+    void updateGeometry_()
+    {
+        cellOrder_.clear();
+        pointOrder_.clear();
+
+        std::vector<double> points;
+        std::vector<std::int64_t> connectivity;
+        std::vector<std::int64_t> offsets;
+        std::vector<std::uint8_t> types;
+
+        std::vector<std::int64_t> pointIdx(vertexMapper_.size(), -1);
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            const auto& geomType = elem.type();
+            const auto& geom = elem.geometry();
+
+            cellOrder_.push_back(static_cast<std::size_t>(elementMapper_.index(elem)));
+            const int numCorners = geom.corners();
+            for (int vtkCornerIdx = 0; vtkCornerIdx < numCorners; ++vtkCornerIdx) {
+                const int cornerIdx = Dune::VTK::renumber(geomType, vtkCornerIdx);
+                const auto vertexIdx = vertexMapper_.subIndex(elem, cornerIdx, dim);
+                if (pointIdx[vertexIdx] < 0) {
+                    pointIdx[vertexIdx] = static_cast<std::int64_t>(pointOrder_.size());
+                    pointOrder_.push_back(static_cast<std::size_t>(vertexIdx));
+
+                    const auto& pos = geom.corner(cornerIdx);
+                    for (int d = 0; d < 3; ++d)
+                        points.push_back((d < dimWorld) ? static_cast<double>(pos[d]) : 0.0);
+                }
+                connectivity.push_back(pointIdx[vertexIdx]);
+            }
+            offsets.push_back(static_cast<std::int64_t>(connectivity.size()));
+            types.push_back(static_cast<std::uint8_t>(Dune::VTK::geometryType(geomType)));
+        }
+
+        encodedPoints_ = encodeBlock_(points.data(), points.size());
+        encodedConnectivity_ = encodeBlock_(connectivity.data(), connectivity.size());
+        encodedOffsets_ = encodeBlock_(offsets.data(), offsets.size());
+        encodedTypes_ = encodeBlock_(types.data(), types.size());
+
+        geometryValid_ = true;
+    }
+
+    template <class T>
+    std::string encodeField_(const Field& field, const std::vector<std::size_t>& order) const
+    {
+        const unsigned numComponents = field.numComponents;
+        std::vector<T> values(order.size()*numComponents);
+        for (std::size_t i = 0; i < order.size(); ++i)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                values[i*numComponents + compIdx] = static_cast<T>(field.value(order[i], compIdx));
+
+        return encodeBlock_(values.data(), values.size());
+    }
+
+    // convert an array to a block of the appended data section, i.e., a header which
+    // specifies the size of the data followed by the possibly compressed data
+    template <class T>
+    std::string encodeBlock_(const T* values, std::size_t n) const
+    {
+        const char* data = reinterpret_cast<const char*>(values);
+        const std::size_t numBytes = n*sizeof(T);
+
+        std::string result;
+        if (encoding_ == Encoding::Raw) {
+            appendUInt64_(result, numBytes);
+            result.append(data, numBytes);
+            return result;
+        }
+
+#if HAVE_ZLIB
+        const std::size_t numBlocks = (numBytes + zlibBlockSize_ - 1)/zlibBlockSize_;
+        const std::size_t lastBlockSize =
+            (numBytes % zlibBlockSize_ == 0 && numBytes > 0) ? zlibBlockSize_ : numBytes % zlibBlockSize_;
+
+        std::vector<std::uint64_t> compressedSizes(numBlocks);
+        std::string compressed;
+        std::vector<Bytef> buffer(compressBound(zlibBlockSize_));
+        for (std::size_t blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+            const std::size_t blockSize =
+                (blockIdx + 1 == numBlocks) ? lastBlockSize : zlibBlockSize_;
+            uLongf compressedSize = static_cast<uLongf>(buffer.size());
+            const int ret = compress2(buffer.data(), &compressedSize,
+                                      reinterpret_cast<const Bytef*>(data + blockIdx*zlibBlockSize_),
+                                      static_cast<uLong>(blockSize),
+                                      Z_BEST_SPEED);
+            if (ret != Z_OK)
+                throw std::runtime_error("Could not compress VTK output data");
+
+            compressedSizes[blockIdx] = compressedSize;
+            compressed.append(reinterpret_cast<const char*>(buffer.data()), compressedSize);
+        }
+
+        appendUInt64_(result, numBlocks);
+        appendUInt64_(result, zlibBlockSize_);
+        appendUInt64_(result, lastBlockSize);
+        for (const auto size : compressedSizes)
+            appendUInt64_(result, size);
+        result += compressed;
+#endif
+        return result;
+    }
+
+    static void appendUInt64_(std::string& dest, std::uint64_t value)
+    { dest.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    void writeFileHeader_(std::ostream& os, const char* type) const
+    {
+        os << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"" << type << "\" version=\"1.0\""
+           << " byte_order=\"" << byteOrder_() << "\""
+           << " header_type=\"UInt64\"";
+        if (encoding_ == Encoding::Zlib)
+            os << " compressor=\"vtkZLibDataCompressor\"";
+        os << ">\n";
+    }
+
+    void writePiece_(const std::string& fileName, const std::vector<std::string>& encodedFields) const
+    {
+        std::ofstream os(fileName, std::ios::out | std::ios::binary);
+        if (!os.good())
+            throw std::runtime_error("Could not open VTK output file '"+fileName+"'");
+
+        writeFileHeader_(os, "UnstructuredGrid");
+        os << " <UnstructuredGrid>\n"
+           << "  <Piece NumberOfPoints=\"" << pointOrder_.size() << "\""
+           << " NumberOfCells=\"" << cellOrder_.size() << "\">\n";
+
+        std::uint64_t offset = 0;
+        const auto writeDataArray =
+            [&os, &offset](const char* typeName,
+                           const std::string& name,
+                           unsigned numComponents,
+                           const std::string& encoded)
+            {
+                os << "    <DataArray type=\"" << typeName << "\"";
+                if (!name.empty())
+                    os << " Name=\"" << name << "\"";
+                os << " NumberOfComponents=\"" << numComponents << "\""
+                   << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+                offset += encoded.size();
+            };
+
+        for (const int codim : {int(dim), 0}) {
+            os << ((codim == 0) ? "   <CellData>\n" : "   <PointData>\n");
+            for (std::size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx) {
+                const Field& field = fields_[fieldIdx];
+                if (field.codim == codim)
+                    writeDataArray(floatTypeName_(), field.name, field.numComponents, encodedFields[fieldIdx]);
+            }
+            os << ((codim == 0) ? "   </CellData>\n" : "   </PointData>\n");
+        }
+
+        os << "   <Points>\n";
+        writeDataArray("Float64", "Coordinates", 3, encodedPoints_);
+        os << "   </Points>\n"
+           << "   <Cells>\n";
+        writeDataArray("Int64", "connectivity", 1, encodedConnectivity_);
+        writeDataArray("Int64", "offsets", 1, encodedOffsets_);
+        writeDataArray("UInt8", "types", 1, encodedTypes_);
+        os << "   </Cells>\n"
+           << "  </Piece>\n"
+           << " </UnstructuredGrid>\n"
+           << " <AppendedData encoding=\"raw\">\n"
+           << "_";
+
+        // the appended data must be in the same order as the data arrays above
+        for (const int codim : {int(dim), 0})
+            for (std::size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx)
+                if (fields_[fieldIdx].codim == codim)
+                    os << encodedFields[fieldIdx];
+        os << encodedPoints_
+           << encodedConnectivity_
+           << encodedOffsets_
+           << encodedTypes_;
+
+        os << "\n </AppendedData>\n"
+           << "</VTKFile>\n";
+
+        os.close();
+        if (!os.good())
+            throw std::runtime_error("Could not write VTK output file '"+fileName+"'");
+    }
+
+    void writeParallelHeader_(const std::string& fileName, const std::string& name) const
+    {
+        std::ofstream os(fileName);
+        if (!os.good())
+            throw std::runtime_error("Could not open VTK output file '"+fileName+"'");
+
+        writeFileHeader_(os, "PUnstructuredGrid");
+        os << " <PUnstructuredGrid GhostLevel=\"0\">\n";
+        for (const int codim : {int(dim), 0}) {
+            os << ((codim == 0) ? "  <PCellData>\n" : "  <PPointData>\n");
+            for (const auto& field : fields_)
+                if (field.codim == codim)
+                    os << "   <PDataArray type=\"" << floatTypeName_() << "\""
+                       << " Name=\"" << field.name << "\""
+                       << " NumberOfComponents=\"" << field.numComponents << "\"/>\n";
+            os << ((codim == 0) ? "  </PCellData>\n" : "  </PPointData>\n");
+        }
+        os << "  <PPoints>\n"
+           << "   <PDataArray type=\"Float64\" Name=\"Coordinates\" NumberOfComponents=\"3\"/>\n"
+           << "  </PPoints>\n";
+
+        // the file names of the pieces are relative to the .pvtu file
+        for (int rank = 0; rank < commSize_; ++rank)
+            os << "  <Piece Source=\"" << pieceFileName_(name, rank) << ".vtu\"/>\n";
+
+        os << " </PUnstructuredGrid>\n"
+           << "</VTKFile>\n";
+
+        os.close();
+        if (!os.good())
+            throw std::runtime_error("Could not write VTK output file '"+fileName+"'");
+    }
+
+    const GridView gridView_;
+    const ElementMapper& elementMapper_;
+    const VertexMapper& vertexMapper_;
+    Encoding encoding_;
+    bool singlePrecision_;
+
+    int commRank_;
+    int commSize_;
+
+    std::vector<Field> fields_;
+    std::vector<std::string> encodedFields_;
+
+    // the geometry of the local piece of the grid
+    bool geometryValid_;
+    std::vector<std::size_t> cellOrder_;
+    std::vector<std::size_t> pointOrder_;
+    std::string encodedPoints_;
+    std::string encodedConnectivity_;
+    std::string encodedOffsets_;
+    std::string encodedTypes_;
+};
+
+} // namespace Opm
+
+#endif
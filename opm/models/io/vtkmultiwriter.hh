@@ -32,7 +32,9 @@
 #include "vtkvectorfunction.hh"
 #include "vtktensorfunction.hh"
 
+#include <opm/models/discretization/common/reorderedelementmapper.hh>
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/vtkbinarywriter.hh>
 #include <opm/models/parallel/tasklets.hh>
 
 #include <opm/material/common/Valgrind.hpp>
@@ -48,10 +50,12 @@
 
 #include <filesystem>
 #include <list>
+#include <memory>
 #include <string>
 #include <limits>
 #include <sstream>
 #include <fstream>
+#include <utility>
 
 namespace Opm {
 /*!
@@ -75,7 +79,10 @@ class VtkMultiWriter : public BaseOutputWriter
         {
             std::string fileName;
             // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
-            if (multiWriter_.commSize_ > 1)
+            if (multiWriter_.binaryWriter_)
+                fileName = multiWriter_.binaryWriter_->write(/*outputDir=*/multiWriter_.outputDir_,
+                                                             /*name=*/multiWriter_.curOutFileName_);
+            else if (multiWriter_.commSize_ > 1)
                 fileName = multiWriter_.curWriter_->pwrite(/*name=*/multiWriter_.curOutFileName_,
                                                            /*path=*/multiWriter_.outputDir_,
                                                            /*extendPath=*/"",
@@ -101,7 +108,7 @@ class VtkMultiWriter : public BaseOutputWriter
     enum { dim = GridView::dimension };
 
     using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
-    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = ReorderedElementMapper<GridView>;
 
 public:
     using Scalar = BaseOutputWriter::Scalar;
@@ -113,6 +120,7 @@ public:
 
     using VtkWriter = Dune::VTKWriter<GridView>;
     using FunctionPtr = std::shared_ptr< Dune::VTKFunction< GridView > >;
+    using BinaryWriter = VtkBinaryWriter<GridView>;
 
     VtkMultiWriter(bool asyncWriting,
                    const GridView& gridView,
@@ -149,6 +157,37 @@ public:
             multiFile_.close();
     }
 
+    /*!
+     * \brief Write the fields as appended binary data instead of using
+     *        Dune::VTKWriter.
+     *
+     * In this mode, the fields are optionally compressed using zlib and encoded in
+     * parallel, and they can be narrowed to single precision. This method must be
+     * called before the first call to beginWrite().
+     */
+    void enableBinaryOutput(typename BinaryWriter::Encoding encoding, bool singlePrecision)
+    {
+        binaryWriter_ = std::make_unique<BinaryWriter>(gridView_,
+                                                       elementMapper_,
+                                                       vertexMapper_,
+                                                       encoding,
+                                                       singlePrecision);
+    }
+
+    /*!
+     * \brief Set the ordering of the elements which is used by the attached element
+     *        data.
+     *
+     * This must be the ordering used by the element mapper of the discretization. A
+     * null pointer means that the element data uses the numbering of the grid.
+     */
+    void setElementOrdering(std::shared_ptr<const typename ElementMapper::Ordering> ordering)
+    {
+        elementMapper_.setOrdering(std::move(ordering));
+        if (binaryWriter_)
+            binaryWriter_->gridChanged();
+    }
+
     /*!
      * \brief Returns the number of the current VTK file.
      */
@@ -171,6 +210,9 @@ public:
         elementMapper_.update();
         vertexMapper_.update();
 #endif
+
+        if (binaryWriter_)
+            binaryWriter_->gridChanged();
     }
 
     /*!
@@ -190,7 +232,10 @@ public:
         curTime_ = t;
         curOutFileName_ = fileName_();
 
-        curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
+        if (binaryWriter_)
+            binaryWriter_->clear();
+        else
+            curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
         ++curWriterNum_;
     }
 
@@ -243,6 +288,11 @@ public:
     {
         sanitizeScalarBuffer_(buf);
 
+        if (binaryWriter_) {
+            binaryWriter_->addScalarField(buf, name, /*codim=*/dim);
+            return;
+        }
+
         using VtkFn = VtkScalarFunction<GridView, VertexMapper>;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -271,6 +321,11 @@ public:
     {
         sanitizeScalarBuffer_(buf);
 
+        if (binaryWriter_) {
+            binaryWriter_->addScalarField(buf, name, /*codim=*/0);
+            return;
+        }
+
         using VtkFn = VtkScalarFunction<GridView, ElementMapper>;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -300,6 +355,11 @@ public:
     {
         sanitizeVectorBuffer_(buf);
 
+        if (binaryWriter_) {
+            binaryWriter_->addVectorField(buf, name, /*codim=*/dim);
+            return;
+        }
+
         using VtkFn = VtkVectorFunction<GridView, VertexMapper>;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -320,6 +380,11 @@ public:
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
+            if (binaryWriter_) {
+                binaryWriter_->addTensorField(buf, oss.str(), /*codim=*/dim, colIdx);
+                continue;
+            }
+
             FunctionPtr fnPtr(new VtkFn(oss.str(),
                                         gridView_,
                                         vertexMapper_,
@@ -349,6 +414,11 @@ public:
     {
         sanitizeVectorBuffer_(buf);
 
+        if (binaryWriter_) {
+            binaryWriter_->addVectorField(buf, name, /*codim=*/0);
+            return;
+        }
+
         using VtkFn = VtkVectorFunction<GridView, ElementMapper>;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -369,6 +439,11 @@ public:
             std::ostringstream oss;
             oss << name <<  "[" << colIdx << "]";
 
+            if (binaryWriter_) {
+                binaryWriter_->addTensorField(buf, oss.str(), /*codim=*/0, colIdx);
+                continue;
+            }
+
             FunctionPtr fnPtr(new VtkFn(oss.str(),
                                         gridView_,
                                         elementMapper_,
@@ -389,6 +464,12 @@ public:
     void endWrite(bool onlyDiscard = false)
     {
         if (!onlyDiscard) {
+            // the fields are encoded by the threads of the simulation. doing this in
+            // the tasklet would start a second team of threads which competes with
+            // the simulation if the output is written asynchronously
+            if (binaryWriter_)
+                binaryWriter_->encode();
+
             auto tasklet = std::make_shared<WriteDataTasklet>(*this);
             taskletRunner_.dispatch(tasklet);
         }
@@ -563,6 +644,8 @@ private:
     std::list<ScalarBuffer *> managedScalarBuffers_;
     std::list<VectorBuffer *> managedVectorBuffers_;
 
+    std::unique_ptr<BinaryWriter> binaryWriter_;
+
     TaskletRunner taskletRunner_;
 };
 } // namespace Opm
@@ -41,13 +41,20 @@
 #include <opm/models/nonlinear/newtonmethodproperties.hh>
 #include <opm/models/nonlinear/nullconvergencewriter.hh>
 
+#include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/instrumentation.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
 #include <opm/simulators/linalg/linalgproperties.hh>
 
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <unistd.h>
 
@@ -113,6 +120,14 @@ template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, Properties::TTag::NewtonMethod>
 { static constexpr int value = 20; };
 
+template<class TypeTag>
+struct NewtonInstrumentationFile<TypeTag, Properties::TTag::NewtonMethod>
+{ static constexpr auto value = ""; };
+
+template<class TypeTag>
+struct NewtonInstrumentationHardwareCounters<TypeTag, Properties::TTag::NewtonMethod>
+{ static constexpr bool value = false; };
+
 } // namespace Opm::Parameters
 
 namespace Opm {
@@ -140,23 +155,68 @@ class NewtonMethod
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
     using LinearSolverBackend = GetPropType<TypeTag, Properties::LinearSolverBackend>;
     using ConvergenceWriter = GetPropType<TypeTag, Properties::NewtonConvergenceWriter>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Communicator = typename Dune::MPIHelper::MPICommunicator;
     using CollectiveCommunication = typename Dune::Communication<typename Dune::MPIHelper::MPICommunicator>;
 
 public:
+    /*!
+     * \brief The indices of the regions of the Newton method which are measured by
+     *        the instrumentation object.
+     */
+    struct InstrumentationRegions
+    {
+        unsigned linearize;
+        unsigned intensiveQuantities;
+        unsigned storage;
+        unsigned flux;
+        unsigned source;
+        unsigned boundary;
+        unsigned auxModules;
+        unsigned solve;
+        unsigned preconditionerSetup;
+        unsigned solverIterations;
+        unsigned update;
+    };
+
     NewtonMethod(Simulator& simulator)
         : simulator_(simulator)
         , endIterMsgStream_(std::ostringstream::out)
         , linearSolver_(simulator)
         , comm_(Dune::MPIHelper::getCommunicator())
         , convergenceWriter_(asImp_())
+        , instrumentation_(ThreadManager::maxThreads())
     {
         lastError_ = 1e100;
         error_ = 1e100;
         tolerance_ = Parameters::get<TypeTag, Parameters::NewtonTolerance>();
 
         numIterations_ = 0;
+
+        // the regions below "linearize" except for the auxiliary modules are entered
+        // for each element, so reading the hardware counters there would dominate
+        // the measurement
+        auto& regions = instrumentationRegions_;
+        regions.linearize = instrumentation_.addRegion("linearize");
+        regions.intensiveQuantities = instrumentation_.addRegion("intensiveQuantities", regions.linearize,
+                                                                 /*readCounters=*/false);
+        regions.storage = instrumentation_.addRegion("storage", regions.linearize, /*readCounters=*/false);
+        regions.flux = instrumentation_.addRegion("flux", regions.linearize, /*readCounters=*/false);
+        regions.source = instrumentation_.addRegion("source", regions.linearize, /*readCounters=*/false);
+        regions.boundary = instrumentation_.addRegion("boundary", regions.linearize, /*readCounters=*/false);
+        regions.auxModules = instrumentation_.addRegion("auxModules", regions.linearize);
+        regions.solve = instrumentation_.addRegion("solve");
+        regions.preconditionerSetup = instrumentation_.addRegion("preconditionerSetup", regions.solve);
+        regions.solverIterations = instrumentation_.addRegion("solverIterations", regions.solve);
+        regions.update = instrumentation_.addRegion("update");
+
+        instrumentationFileName_ = Parameters::get<TypeTag, Parameters::NewtonInstrumentationFile>();
+        if (!instrumentationFileName_.empty()) {
+            instrumentation_.setEnabled(true);
+            instrumentation_.setHardwareCountersEnabled(
+                Parameters::get<TypeTag, Parameters::NewtonInstrumentationHardwareCounters>());
+        }
     }
 
     /*!
@@ -182,6 +242,14 @@ public:
         Parameters::registerParam<TypeTag, Parameters::NewtonMaxError>
             ("The maximum error tolerated by the Newton "
              "method to which does not cause an abort");
+        Parameters::registerParam<TypeTag, Parameters::NewtonInstrumentationFile>
+            ("The file to which the time spent in the regions of the Newton method "
+             "is written after each time step. Files ending with '.csv' use the CSV "
+             "format, all others JSON lines. An empty name disables the "
+             "instrumentation");
+        Parameters::registerParam<TypeTag, Parameters::NewtonInstrumentationHardwareCounters>
+            ("Record hardware performance counters for the coarse regions of the Newton "
+             "method, i.e., the ones which are not entered for each element");
     }
 
     /*!
@@ -286,6 +354,13 @@ public:
 
         TimerGuard prePostProcessTimerGuard(prePostProcessTimer_);
 
+        // finish the record of the instrumentation for the time step regardless of
+        // how the method exits
+        bool instrumentationConverged = false;
+        auto finishInstrumentationFn = [this, &instrumentationConverged]() -> void
+                                       { this->finishInstrumentation_(instrumentationConverged); };
+        auto finishInstrumentationGuard = Opm::make_guard(finishInstrumentationFn);
+
         // tell the implementation that we begin solving
         prePostProcessTimer_.start();
         asImp_().begin_(nextSolution);
@@ -319,23 +394,36 @@ public:
 
                 // do the actual linearization
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                {
+                    Instrumentation::ScopedRegion linearizeRegion(instrumentation_,
+                                                                  instrumentationRegions_.linearize);
+                    asImp_().linearizeDomain_();
+
+                    Instrumentation::ScopedRegion auxModulesRegion(instrumentation_,
+                                                                   instrumentationRegions_.auxModules);
+                    asImp_().linearizeAuxiliaryEquations_();
+                }
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
+                Instrumentation::ScopedRegion prepareRegion(instrumentation_,
+                                                            instrumentationRegions_.solve);
                 auto& residual = linearizer.residual();
                 const auto& jacobian = linearizer.jacobian();
                 linearSolver_.prepare(jacobian, residual);
                 linearSolver_.setResidual(residual);
                 linearSolver_.getResidual(residual);
+                prepareRegion.stop();
                 solveTimer_.stop();
 
                 // The preSolve_() method usually computes the errors, but it can do
                 // something else in addition. TODO: should its costs be counted to
                 // the linearization or to the update?
                 updateTimer_.start();
+                Instrumentation::ScopedRegion preSolveRegion(instrumentation_,
+                                                             instrumentationRegions_.update);
                 asImp_().preSolve_(currentSolution, residual);
+                preSolveRegion.stop();
                 updateTimer_.stop();
 
                 if (!asImp_().proceed_()) {
@@ -361,9 +449,12 @@ public:
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
+                Instrumentation::ScopedRegion solveRegion(instrumentation_,
+                                                          instrumentationRegions_.solve);
                 linearSolver_.setMatrix(jacobian);
                 solutionUpdate = 0.0;
                 bool converged = linearSolver_.solve(solutionUpdate);
+                solveRegion.stop();
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -388,10 +479,13 @@ public:
                 // update the current solution (i.e. uOld) with the delta
                 // (i.e. u). The result is stored in u
                 updateTimer_.start();
+                Instrumentation::ScopedRegion updateRegion(instrumentation_,
+                                                           instrumentationRegions_.update);
                 asImp_().postSolve_(currentSolution,
                                     residual,
                                     solutionUpdate);
                 asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                updateRegion.stop();
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -466,6 +560,7 @@ public:
         }
 
         // if we converged, tell the implementation that we've succeeded
+        instrumentationConverged = true;
         prePostProcessTimer_.start();
         asImp_().succeeded_();
         prePostProcessTimer_.stop();
@@ -538,13 +633,28 @@ public:
     const Timer& updateTimer() const
     { return updateTimer_; }
 
+    /*!
+     * \brief Returns the object which measures the time spent in the regions of the
+     *        Newton method.
+     *
+     * The indices of the regions are given by instrumentationRegions().
+     */
+    Instrumentation& instrumentation() const
+    { return instrumentation_; }
+
+    /*!
+     * \brief Returns the indices of the regions of the Newton method.
+     */
+    const InstrumentationRegions& instrumentationRegions() const
+    { return instrumentationRegions_; }
+
 protected:
     /*!
      * \brief Returns true if the Newton method ought to be chatty.
      */
     bool verbose_() const
     {
-        return Parameters::get<TypeTag, Parameters::NewtonVerbose>() && (comm_.rank() == 0);
+        return Parameters::getResolved<TypeTag, Parameters::NewtonVerbose>() && (comm_.rank() == 0);
     }
 
     /*!
@@ -557,7 +667,7 @@ protected:
     {
         numIterations_ = 0;
 
-        if (Parameters::get<TypeTag, Parameters::NewtonWriteConvergence>())
+        if (Parameters::getResolved<TypeTag, Parameters::NewtonWriteConvergence>())
             convergenceWriter_.beginTimeStep();
     }
 
@@ -609,27 +719,46 @@ protected:
     {
         const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
-        Scalar newtonMaxError = Parameters::get<TypeTag, Parameters::NewtonMaxError>();
+        Scalar newtonMaxError = Parameters::getResolved<TypeTag, Parameters::NewtonMaxError>();
 
         // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
+        // the solution's residual. each thread determines the maximum for its part
+        // of the DOFs, the result is then reduced over the threads. since taking the
+        // maximum does not depend on the order of the operations, this yields exactly
+        // the same result as the sequential loop.
+        const int numDof = currentResidual.size();
+        std::vector<Scalar> threadError(ThreadManager::maxThreads(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar localError = 0.0;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (int dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                // do not consider auxiliary DOFs for the error
+                if (static_cast<std::size_t>(dofIdx) >= model().numGridDof()
+                    || model().dofTotalVolume(dofIdx) <= 0.0)
                     continue;
-            }
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+                // also do not consider DOFs which are constraint
+                if (enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0)
+                        continue;
+                }
+
+                const auto& r = currentResidual[dofIdx];
+                for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+                    localError = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), localError);
+            }
+            threadError[ThreadManager::threadId()] = localError;
         }
 
+        error_ = 0;
+        for (const auto& localError : threadError)
+            error_ = max(localError, error_);
+
         // take the other processes into account
         error_ = comm_.max(error_);
 
@@ -712,14 +841,30 @@ protected:
         if (!std::isfinite(solutionUpdate.one_norm()))
             throw NumericalProblem("Non-finite update!");
 
-        size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
-                    asImp_().updateConstraintDof_(dofIdx,
-                                                  nextSolution[dofIdx],
-                                                  constraints);
+        // the primary variables of the grid DOFs are updated independently of each
+        // other, so the update can be done in parallel. Any exception thrown by a
+        // thread is stored and re-thrown after the parallel region.
+        std::exception_ptr exceptionPtr = nullptr;
+        std::mutex exceptionLock;
+        const int numGridDof = model().numGridDof();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            try {
+                if (enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0) {
+                        const auto& constraints = constraintsMap.at(dofIdx);
+                        asImp_().updateConstraintDof_(dofIdx,
+                                                      nextSolution[dofIdx],
+                                                      constraints);
+                    }
+                    else
+                        asImp_().updatePrimaryVariables_(dofIdx,
+                                                         nextSolution[dofIdx],
+                                                         currentSolution[dofIdx],
+                                                         solutionUpdate[dofIdx],
+                                                         currentResidual[dofIdx]);
                 }
                 else
                     asImp_().updatePrimaryVariables_(dofIdx,
@@ -728,14 +873,15 @@ protected:
                                                      solutionUpdate[dofIdx],
                                                      currentResidual[dofIdx]);
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
         }
 
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
         for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
@@ -774,7 +920,7 @@ protected:
     void writeConvergence_(const SolutionVector& currentSolution,
                            const GlobalEqVector& solutionUpdate)
     {
-        if (Parameters::get<TypeTag, Parameters::NewtonWriteConvergence>()) {
+        if (Parameters::getResolved<TypeTag, Parameters::NewtonWriteConvergence>()) {
             convergenceWriter_.beginIteration();
             convergenceWriter_.writeFields(currentSolution, solutionUpdate);
             convergenceWriter_.endIteration();
@@ -846,7 +992,7 @@ protected:
      */
     void end_()
     {
-        if (Parameters::get<TypeTag, Parameters::NewtonWriteConvergence>())
+        if (Parameters::getResolved<TypeTag, Parameters::NewtonWriteConvergence>())
             convergenceWriter_.endTimeStep();
     }
 
@@ -868,10 +1014,10 @@ protected:
 
     // optimal number of iterations we want to achieve
     int targetIterations_() const
-    { return Parameters::get<TypeTag, Parameters::NewtonTargetIterations>(); }
+    { return Parameters::getResolved<TypeTag, Parameters::NewtonTargetIterations>(); }
     // maximum number of iterations we do before giving up
     int maxIterations_() const
-    { return Parameters::get<TypeTag, Parameters::NewtonMaxIterations>(); }
+    { return Parameters::getResolved<TypeTag, Parameters::NewtonMaxIterations>(); }
 
     static bool enableConstraints_()
     { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
@@ -903,11 +1049,63 @@ protected:
     // method to disk
     ConvergenceWriter convergenceWriter_;
 
+    // measures the time spent in the regions of the Newton method
+    mutable Instrumentation instrumentation_;
+    InstrumentationRegions instrumentationRegions_;
+    std::string instrumentationFileName_;
+    std::ofstream instrumentationStream_;
+
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
+
+    // create the record of the instrumentation for the current time step and append it
+    // to the output file
+    void finishInstrumentation_(bool converged)
+    {
+        if (!instrumentation_.enabled())
+            return;
+
+        const auto& record = instrumentation_.finishTimeStep(simulator_.timeStepIndex(),
+                                                             simulator_.time(),
+                                                             simulator_.timeStepSize(),
+                                                             numIterations_,
+                                                             converged);
+
+        const bool useCsv =
+            instrumentationFileName_.size() >= 4 &&
+            instrumentationFileName_.compare(instrumentationFileName_.size() - 4, 4, ".csv") == 0;
+
+        if (!instrumentationStream_.is_open()) {
+            // each process writes its own file
+            std::string fileName = instrumentationFileName_;
+            if (comm_.size() > 1) {
+                const auto extPos = useCsv ? fileName.size() - 4 : fileName.size();
+                fileName.insert(extPos, ".rank" + std::to_string(comm_.rank()));
+            }
+
+            instrumentationStream_.open(fileName);
+            if (!instrumentationStream_) {
+                // this is called by a guard object, so we must not throw
+                std::cerr << "Warning: Could not open instrumentation file '" << fileName
+                          << "'. Disabling the instrumentation of the Newton method.\n";
+                instrumentation_.setEnabled(false);
+                return;
+            }
+            if (useCsv)
+                instrumentation_.writeCsvHeader(instrumentationStream_);
+        }
+
+        if (useCsv)
+            instrumentation_.writeCsvRecord(instrumentationStream_, record);
+        else
+            instrumentation_.writeJsonRecord(instrumentationStream_, record);
+        instrumentationStream_.flush();
+
+        instrumentation_.clearHistory();
+    }
 };
 
 } // namespace Opm
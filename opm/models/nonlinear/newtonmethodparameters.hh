@@ -65,6 +65,21 @@ struct NewtonTargetIterations { using type = Properties::UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = Properties::UndefinedProperty; };
 
+/*!
+ * \brief The name of the file to which the time spent in the regions of the Newton
+ *        method is written after each time step.
+ *
+ * If the name ends with ".csv", the CSV format is used, else each time step is written
+ * as a JSON object on a separate line. An empty name disables the instrumentation.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonInstrumentationFile { using type = Properties::UndefinedProperty; };
+
+//! Specifies whether hardware performance counters are recorded for the regions of
+//! the Newton method
+template<class TypeTag, class MyTypeTag>
+struct NewtonInstrumentationHardwareCounters { using type = Properties::UndefinedProperty; };
+
 } // end namespace Opm::Parameters
 
 #endif
@@ -96,7 +96,8 @@ public:
     }
 
     /*!
-     * \brief Wait until the buffer was send to the peer completely.
+     * \brief Wait until the buffer was send to the peer completely or until an
+     *        asyncronous receive operation has finished.
      */
     void wait()
     {
@@ -121,6 +122,25 @@ public:
 #endif // HAVE_MPI
     }
 
+    /*!
+     * \brief Start receiving the buffer asyncronously from a peer rank.
+     *
+     * The data is only guaranteed to be available after the wait() method was
+     * called.
+     */
+    void startReceive([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        MPI_Irecv(data_,
+                  static_cast<int>(mpiDataSize_),
+                  mpiDataType_,
+                  static_cast<int>(peerRank),
+                  0, // tag
+                  MPI_COMM_WORLD,
+                  &mpiRequest_);
+#endif // HAVE_MPI
+    }
+
 #if HAVE_MPI
     /*!
      * \brief Returns the current MPI_Request object.
@@ -27,14 +27,23 @@
 #ifndef EWOMS_TASKLETS_HH
 #define EWOMS_TASKLETS_HH
 
+#include <algorithm>
 #include <atomic>
-#include <stdexcept>
 #include <cassert>
-#include <thread>
-#include <queue>
-#include <mutex>
-#include <iostream>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Opm {
 
@@ -83,6 +92,44 @@ private:
     const Fn& fn_;
 };
 
+/*!
+ * \brief A tasklet that runs a function once and provides its result via a future.
+ *
+ * If the function throws, the exception is stored in the future and it is also
+ * reported to the tasklet runner.
+ */
+template <class Fn, class Result>
+class FutureTasklet : public TaskletInterface
+{
+public:
+    explicit FutureTasklet(Fn fn)
+        : fn_(std::move(fn))
+    {}
+
+    std::future<Result> future()
+    { return promise_.get_future(); }
+
+    void run() override
+    {
+        try {
+            if constexpr (std::is_void_v<Result>) {
+                fn_();
+                promise_.set_value();
+            }
+            else
+                promise_.set_value(fn_());
+        }
+        catch (...) {
+            promise_.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+private:
+    Fn fn_;
+    std::promise<Result> promise_;
+};
+
 class TaskletRunner;
 
 // this class stores the thread local static attributes for the TaskletRunner class. we
@@ -107,59 +154,108 @@ thread_local int TaskletRunnerHelper_<Dummy>::workerThreadIndex_ = -1;
  *
  * Depending on the number of worker threads, a tasklet can either be run in a separate
  * worker thread or by the main thread.
+ *
+ * Each worker thread owns a lock-free queue. Tasklets which are dispatched by a
+ * worker thread are added to its own queue, while tasklets dispatched by other
+ * threads are put into a shared injection queue from which idle workers fetch them in
+ * batches. Workers which run out of work steal tasklets from the queues of the other
+ * workers. All queues are processed in first-in-first-out order, i.e., if there is
+ * only a single worker thread, the tasklets are run in the order in which they were
+ * dispatched.
  */
 class TaskletRunner
 {
-    /// \brief Implements a barrier. This class can only be used in the asynchronous case.
-    class BarrierTasklet : public TaskletInterface
+    // a tasklet which has been dispatched but not run yet. tasklets which ought to be
+    // run multiple times are represented by one node per invocation.
+    struct Node_
     {
+        std::shared_ptr<TaskletInterface> tasklet;
+    };
+
+    /// \brief A queue to which only its owner thread adds nodes, but from which any
+    ///        thread may take nodes.
+    ///
+    /// This is the stealing end of the Chase-Lev work stealing deque.
+    class WorkQueue_
+    {
+        struct Buffer
+        {
+            explicit Buffer(std::size_t capacity)
+                : slots(capacity)
+            {
+                for (auto& slot : slots)
+                    slot.store(nullptr, std::memory_order_relaxed);
+            }
+
+            std::size_t capacity() const
+            { return slots.size(); }
+
+            std::atomic<Node_*>& slot(std::int64_t idx)
+            { return slots[static_cast<std::size_t>(idx) & (slots.size() - 1)]; }
+
+            std::vector<std::atomic<Node_*> > slots;
+        };
+
     public:
-        BarrierTasklet(unsigned numWorkers)
-            : TaskletInterface(/*refCount=*/numWorkers)
+        WorkQueue_()
         {
-            numWorkers_ = numWorkers;
-            numWaiting_ = 0;
+            buffers_.push_back(std::make_unique<Buffer>(/*capacity=*/64));
+            buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
         }
 
-        void run()
-        { wait(); }
-
-        void wait()
+        ~WorkQueue_()
         {
-            std::unique_lock<std::mutex> lock(barrierMutex_);
+            while (Node_* node = take())
+                delete node;
+        }
 
-            numWaiting_ += 1;
-            if (numWaiting_ >= numWorkers_ + 1) {
-                lock.unlock();
-                barrierCondition_.notify_all();
+        //! Add a node to the end of the queue. Only the owner thread may call this.
+        void push(Node_* node)
+        {
+            const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+            const std::int64_t t = top_.load(std::memory_order_acquire);
+            Buffer* buf = buffer_.load(std::memory_order_relaxed);
+            if (b - t >= static_cast<std::int64_t>(buf->capacity())) {
+                // grow the buffer. the old buffers are kept alive because other threads
+                // may still read from them.
+                auto newBuf = std::make_unique<Buffer>(2*buf->capacity());
+                for (std::int64_t i = t; i < b; ++i)
+                    newBuf->slot(i).store(buf->slot(i).load(std::memory_order_relaxed),
+                                          std::memory_order_relaxed);
+                buf = newBuf.get();
+                buffers_.push_back(std::move(newBuf));
+                buffer_.store(buf, std::memory_order_release);
             }
-            else {
-                const auto& areAllWaiting =
-                    [this]() -> bool
-                    { return this->numWaiting_ >= this->numWorkers_ + 1; };
 
-                barrierCondition_.wait(lock, /*predicate=*/areAllWaiting);
+            buf->slot(b).store(node, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        //! Remove the node at the front of the queue. Any thread may call this.
+        Node_* take()
+        {
+            while (true) {
+                std::int64_t t = top_.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const std::int64_t b = bottom_.load(std::memory_order_acquire);
+                if (t >= b)
+                    return nullptr;
+
+                Buffer* buf = buffer_.load(std::memory_order_acquire);
+                Node_* node = buf->slot(t).load(std::memory_order_relaxed);
+                if (top_.compare_exchange_strong(t, t + 1,
+                                                 std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed))
+                    return node;
             }
         }
 
     private:
-        unsigned numWorkers_;
-        unsigned numWaiting_;
-
-        std::condition_variable barrierCondition_;
-        std::mutex barrierMutex_;
-    };
-
-    /// \brief TerminateThreadTasklet class
-    /// Empty tasklet marking thread termination.
-    class TerminateThreadTasklet : public TaskletInterface
-    {
-    public:
-        void run()
-        { }
-
-        bool isEndMarker() const
-        { return true; }
+        alignas(64) std::atomic<std::int64_t> top_{0};
+        alignas(64) std::atomic<std::int64_t> bottom_{0};
+        std::atomic<Buffer*> buffer_;
+        std::vector<std::unique_ptr<Buffer> > buffers_;
     };
 
 public:
@@ -174,6 +270,10 @@ public:
      */
     TaskletRunner(unsigned numWorkers)
     {
+        workQueues_.resize(numWorkers);
+        for (auto& workQueue : workQueues_)
+            workQueue = std::make_unique<WorkQueue_>();
+
         threads_.resize(numWorkers);
         for (unsigned i = 0; i < numWorkers; ++i)
             // create a worker thread
@@ -190,8 +290,14 @@ public:
     ~TaskletRunner()
     {
         if (threads_.size() > 0) {
-            // dispatch a tasklet which will terminate the worker thread
-            dispatch(std::make_shared<TerminateThreadTasklet>());
+            barrier();
+
+            // tell the worker threads to terminate
+            {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+                terminate_.store(true);
+            }
+            idleCondition_.notify_all();
 
             // wait until all worker threads have terminated
             for (auto& thread : threads_)
@@ -233,31 +339,42 @@ public:
             // run the tasklet immediately in synchronous mode.
             while (tasklet->referenceCount() > 0) {
                 tasklet->dereference();
-                try {
-                    tasklet->run();
-                }
-                catch (const std::exception& e) {
-                    std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
-                    failureFlag_.store(true, std::memory_order_relaxed);
-                }
-                catch (...) {
-                    std::cerr << "ERROR: Uncaught exception (general type) when running tasklet. Trying to continue.\n";
-                    failureFlag_.store(true, std::memory_order_relaxed);
-                }
+                runTasklet_(*tasklet, /*trailer=*/" Trying to continue.");
             }
+            return;
         }
-        else {
-            // lock mutex for the tasklet queue to make sure that nobody messes with the
-            // task queue
-            taskletQueueMutex_.lock();
 
-            // add the tasklet to the queue
-            taskletQueue_.push(tasklet);
+        if (tasklet->referenceCount() == 1) {
+            // avoid allocating a vector for the common case of a single invocation
+            tasklet->dereference();
+            Node_* node = new Node_{std::move(tasklet)};
+            enqueue_(&node, &node + 1);
+            return;
+        }
 
-            taskletQueueMutex_.unlock();
+        std::vector<Node_*> nodes;
+        makeNodes_(nodes, std::move(tasklet));
+        enqueue_(nodes.data(), nodes.data() + nodes.size());
+    }
 
-            workAvailableCondition_.notify_all();
+    /*!
+     * \brief Add a batch of tasklets.
+     *
+     * This is equivalent to dispatching the tasklets individually, but the worker
+     * threads are only notified once.
+     */
+    void dispatch(const std::vector<std::shared_ptr<TaskletInterface> >& tasklets)
+    {
+        if (threads_.empty()) {
+            for (const auto& tasklet : tasklets)
+                dispatch(tasklet);
+            return;
         }
+
+        std::vector<Node_*> nodes;
+        for (const auto& tasklet : tasklets)
+            makeNodes_(nodes, tasklet);
+        enqueue_(nodes.data(), nodes.data() + nodes.size());
     }
 
     /*!
@@ -272,21 +389,39 @@ public:
         return tasklet;
     }
 
+    /*!
+     * \brief Dispatch a function which is run once and return a future for its
+     *        result.
+     *
+     * In contrast to dispatchFunction(), the function object is copied into the
+     * tasklet.
+     */
+    template <class Fn>
+    auto dispatchTask(Fn fn) -> std::future<std::invoke_result_t<Fn&> >
+    {
+        using Tasklet = FutureTasklet<Fn, std::invoke_result_t<Fn&> >;
+        auto tasklet = std::make_shared<Tasklet>(std::move(fn));
+        auto future = tasklet->future();
+        this->dispatch(tasklet);
+        return future;
+    }
+
     /*!
      * \brief Make sure that all tasklets have been completed after this method has been called
+     *
+     * This method must not be called by the worker threads.
      */
     void barrier()
     {
-        unsigned numWorkers = threads_.size();
-        if (numWorkers == 0)
+        if (threads_.empty())
             // nothing needs to be done to implement a barrier in synchronous mode
             return;
 
-        // dispatch a barrier tasklet and wait until it has been run by the worker thread
-        auto barrierTasklet = std::make_shared<BarrierTasklet>(numWorkers);
-        dispatch(barrierTasklet);
-
-        barrierTasklet->wait();
+        assert(workerThreadIndex() < 0);
+        std::unique_lock<std::mutex> lock(doneMutex_);
+        doneCondition_.wait(lock,
+                            [this]() -> bool
+                            { return numPending_.load() == 0; });
     }
 private:
     // Atomic flag that is set to failure if any of the tasklets run by the TaskletRunner fails.
@@ -306,63 +441,161 @@ protected:
         TaskletRunnerHelper_<void>::taskletRunner_ = taskletRunner;
         TaskletRunnerHelper_<void>::workerThreadIndex_ = workerThreadIndex;
 
-        taskletRunner->run_();
+        taskletRunner->run_(static_cast<unsigned>(workerThreadIndex));
     }
 
-    //! do the work until the queue received an end tasklet
-    void run_()
+    //! do the work until the runner is destroyed
+    void run_(unsigned workerIdx)
     {
         while (true) {
+            Node_* node = findWork_(workerIdx);
+            if (node) {
+                numQueued_.fetch_sub(1);
+                runTasklet_(*node->tasklet, /*trailer=*/"");
+                delete node;
+
+                if (numPending_.fetch_sub(1) == 1) {
+                    // the last outstanding tasklet has been completed. wake up the
+                    // threads waiting in barrier().
+                    { std::lock_guard<std::mutex> lock(doneMutex_); }
+                    doneCondition_.notify_all();
+                }
+                continue;
+            }
 
-            // wait until tasklets have been pushed to the queue. first we need to lock
-            // mutex for access to taskletQueue_
-            std::unique_lock<std::mutex> lock(taskletQueueMutex_);
+            // tasklets are often dispatched in quick succession, so spin for a short
+            // while before going to sleep
+            bool workAvailable = false;
+            for (int spinIdx = 0; spinIdx < numSpinIterations_ && !workAvailable; ++spinIdx) {
+                std::this_thread::yield();
+                workAvailable = numQueued_.load() > 0 || terminate_.load();
+            }
+            if (workAvailable && !terminate_.load())
+                continue;
+
+            // wait until new tasklets have been dispatched. numSleeping_ and numQueued_
+            // are sequentially consistent, so either the dispatching thread sees the
+            // sleeping worker or the worker sees the new tasklets.
+            std::unique_lock<std::mutex> lock(idleMutex_);
+            numSleeping_.fetch_add(1);
+            idleCondition_.wait(lock,
+                                [this]() -> bool
+                                { return numQueued_.load() > 0 || terminate_.load(); });
+            numSleeping_.fetch_sub(1);
+            if (terminate_.load() && numQueued_.load() <= 0)
+                return;
+        }
+    }
 
-            const auto& workIsAvailable =
-                [this]() -> bool
-                { return !taskletQueue_.empty(); };
+    // take a tasklet from the worker's own queue, from the injection queue or from
+    // another worker, in this order.
+    Node_* findWork_(unsigned workerIdx)
+    {
+        WorkQueue_& ownQueue = *workQueues_[workerIdx];
+        if (Node_* node = ownQueue.take())
+            return node;
 
-            if (!workIsAvailable())
-                workAvailableCondition_.wait(lock, /*predicate=*/workIsAvailable);
+        {
+            std::lock_guard<std::mutex> lock(injectionMutex_);
+            if (!injectionQueue_.empty()) {
+                // move a fair share of the injected tasklets to the worker's own queue
+                // so that the other workers can steal them from there.
+                const std::size_t batchSize =
+                    std::max<std::size_t>(1, injectionQueue_.size()/workQueues_.size());
+                for (std::size_t i = 0; i < batchSize; ++i) {
+                    ownQueue.push(injectionQueue_.front());
+                    injectionQueue_.pop_front();
+                }
+            }
+        }
+        if (Node_* node = ownQueue.take())
+            return node;
 
-            // remove tasklet from queue
-            std::shared_ptr<TaskletInterface> tasklet = taskletQueue_.front();
+        const std::size_t numWorkers = workQueues_.size();
+        for (std::size_t i = 1; i < numWorkers; ++i)
+            if (Node_* node = workQueues_[(workerIdx + i) % numWorkers]->take())
+                return node;
 
-            // if tasklet is an end marker, terminate the thread and DO NOT remove the
-            // tasklet.
-            if (tasklet->isEndMarker()) {
-                if(taskletQueue_.size() > 1)
-                    throw std::logic_error("TaskletRunner: Not all queued tasklets were executed");
-                taskletQueueMutex_.unlock();
-                return;
-            }
+        return nullptr;
+    }
 
+    void makeNodes_(std::vector<Node_*>& nodes, std::shared_ptr<TaskletInterface> tasklet)
+    {
+        // tasklets are run as often as their reference count says. the reference
+        // count is consumed by the dispatching thread so that the workers do not need
+        // to synchronize on it.
+        while (tasklet->referenceCount() > 0) {
             tasklet->dereference();
-            if (tasklet->referenceCount() == 0)
-                // remove tasklets from the queue as soon as their reference count
-                // reaches zero, i.e. the tasklet has been run often enough.
-                taskletQueue_.pop();
-            lock.unlock();
-
-            // execute tasklet
-            try {
-                tasklet->run();
-            }
-            catch (const std::exception& e) {
-                std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ".\n";
-                failureFlag_.store(true, std::memory_order_relaxed); 
-            }
-            catch (...) {
-                std::cerr << "ERROR: Uncaught exception when running tasklet.\n";
-                failureFlag_.store(true, std::memory_order_relaxed);
-            }
+            nodes.push_back(new Node_{tasklet});
+        }
+    }
+
+    void enqueue_(Node_* const* nodesBegin, Node_* const* nodesEnd)
+    {
+        const auto numNodes = static_cast<std::int64_t>(nodesEnd - nodesBegin);
+        if (numNodes == 0)
+            return;
+
+        numPending_.fetch_add(numNodes);
+
+        const int workerIdx = workerThreadIndex();
+        if (workerIdx >= 0) {
+            // tasklets dispatched by a worker thread go to its own queue
+            for (auto nodeIt = nodesBegin; nodeIt != nodesEnd; ++nodeIt)
+                workQueues_[static_cast<std::size_t>(workerIdx)]->push(*nodeIt);
+        }
+        else {
+            std::lock_guard<std::mutex> lock(injectionMutex_);
+            injectionQueue_.insert(injectionQueue_.end(), nodesBegin, nodesEnd);
+        }
+
+        numQueued_.fetch_add(numNodes);
+        if (numSleeping_.load() > 0) {
+            { std::lock_guard<std::mutex> lock(idleMutex_); }
+            if (numNodes == 1)
+                idleCondition_.notify_one();
+            else
+                idleCondition_.notify_all();
         }
     }
 
+    void runTasklet_(TaskletInterface& tasklet, const char* trailer)
+    {
+        try {
+            tasklet.run();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << "." << trailer << "\n";
+            failureFlag_.store(true, std::memory_order_relaxed);
+        }
+        catch (...) {
+            std::cerr << "ERROR: Uncaught exception when running tasklet." << trailer << "\n";
+            failureFlag_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // the number of times an idle worker checks for new tasklets before it sleeps
+    static constexpr int numSpinIterations_ = 64;
+
     std::vector<std::unique_ptr<std::thread> > threads_;
-    std::queue<std::shared_ptr<TaskletInterface> > taskletQueue_;
-    std::mutex taskletQueueMutex_;
-    std::condition_variable workAvailableCondition_;
+    std::vector<std::unique_ptr<WorkQueue_> > workQueues_;
+
+    std::deque<Node_*> injectionQueue_;
+    std::mutex injectionMutex_;
+
+    // the number of tasklets which have been queued but not taken yet. this may
+    // temporarily become negative because the counter is incremented after the
+    // tasklets have been made available.
+    std::atomic<std::int64_t> numQueued_{0};
+    std::atomic<int> numSleeping_{0};
+    std::atomic<bool> terminate_{false};
+    std::mutex idleMutex_;
+    std::condition_variable idleCondition_;
+
+    // the number of tasklets which have been dispatched but not completed yet
+    std::atomic<std::int64_t> numPending_{0};
+    std::mutex doneMutex_;
+    std::condition_variable doneCondition_;
 };
 
 } // end namespace Opm
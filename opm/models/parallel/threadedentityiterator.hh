@@ -27,40 +27,166 @@
 #ifndef EWOMS_THREADED_ENTITY_ITERATOR_HH
 #define EWOMS_THREADED_ENTITY_ITERATOR_HH
 
-#include <thread>
-#include <mutex>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
 
 namespace Opm {
 
+/*!
+ * \brief Specifies how the entities of a ThreadedEntityIterator are handed out to the
+ *        threads.
+ *
+ * The entities are distributed in contiguous chunks of \c chunkSize entities. If the
+ * guided schedule is used, the threads grab larger blocks of chunks at the beginning of
+ * the loop and the block size is reduced as the loop advances, similar to OpenMP's
+ * 'guided' schedule.
+ */
+struct ThreadedEntityIteratorSchedule
+{
+    static void setDefaultChunkSize(unsigned chunkSize)
+    { defaultChunkSize_ = std::max(chunkSize, 1u); }
+
+    static unsigned defaultChunkSize()
+    { return defaultChunkSize_; }
+
+    static void setDefaultGuided(bool yesno)
+    { defaultGuided_ = yesno; }
+
+    static bool defaultGuided()
+    { return defaultGuided_; }
+
+private:
+    static inline unsigned defaultChunkSize_ = 16;
+    static inline bool defaultGuided_ = false;
+};
+
+/*!
+ * \brief The iterators pointing to the beginning of each chunk of the entities of a
+ *        GridView.
+ *
+ * Materializing them requires a sequential pass over the grid view. Objects of this
+ * class can thus be kept as long as the grid does not change and be passed to all
+ * ThreadedEntityIterator objects which iterate over the same grid view.
+ */
+template <class GridView, int codim>
+class ThreadedEntityChunks
+{
+public:
+    using EntityIterator = typename GridView::template Codim<codim>::Iterator;
+
+    explicit ThreadedEntityChunks(const GridView& gridView,
+                                  unsigned chunkSize = ThreadedEntityIteratorSchedule::defaultChunkSize())
+        : end_(gridView.template end<codim>())
+        , chunkSize_(std::max(chunkSize, 1u))
+    {
+        std::size_t numEntities = 0;
+        auto it = gridView.template begin<codim>();
+        for (; it != end_; ++it, ++numEntities) {
+            if (numEntities % chunkSize_ == 0)
+                chunkBegin_.push_back(it);
+        }
+        numEntities_ = numEntities;
+    }
+
+    //! The iterators pointing to the first entity of each chunk
+    const std::vector<EntityIterator>& chunkBegin() const
+    { return chunkBegin_; }
+
+    //! The iterator pointing after the last entity of the grid view
+    const EntityIterator& end() const
+    { return end_; }
+
+    //! The number of entities of the grid view
+    std::size_t numEntities() const
+    { return numEntities_; }
+
+    //! The number of entities of each chunk except the last one
+    std::size_t chunkSize() const
+    { return chunkSize_; }
+
+private:
+    std::vector<EntityIterator> chunkBegin_;
+    EntityIterator end_;
+    std::size_t numEntities_;
+    std::size_t chunkSize_;
+};
+
 /*!
  * \brief Provides an STL-iterator like interface to iterate over the enties of a
  *        GridView in OpenMP threaded applications
  *
+ * The iterators pointing to the beginning of each chunk of entities are either
+ * materialized when the object is constructed or taken from a ThreadedEntityChunks
+ * object, and the chunks are handed out to the threads using an atomic counter, i.e.,
+ * no locks are required while iterating.
+ *
  * ATTENTION: This class must be instantiated in a sequential context!
  */
 template <class GridView, int codim>
 class ThreadedEntityIterator
 {
     using Entity = typename GridView::template Codim<codim>::Entity;
-    using EntityIterator = typename GridView::template Codim<codim>::Iterator;
+    using Chunks = ThreadedEntityChunks<GridView, codim>;
+    using EntityIterator = typename Chunks::EntityIterator;
+
+    // the iteration state of a single thread. this is padded to a cache line in order
+    // to avoid false sharing.
+    struct alignas(64) ThreadState
+    {
+        EntityIterator it;
+        std::size_t remaining;
+    };
+
 public:
     ThreadedEntityIterator(const GridView& gridView)
-        : sequentialIt_(gridView.template begin<codim>())
-        , sequentialEnd_(gridView.template end<codim>())
+        : ThreadedEntityIterator(gridView,
+                                 ThreadedEntityIteratorSchedule::defaultChunkSize(),
+                                 ThreadedEntityIteratorSchedule::defaultGuided())
     { }
 
-    ThreadedEntityIterator(const ThreadedEntityIterator& other) = default;
+    ThreadedEntityIterator(const GridView& gridView, unsigned chunkSize, bool guided = false)
+        : ownedChunks_(std::make_shared<const Chunks>(gridView, chunkSize))
+        , chunks_(ownedChunks_.get())
+        , sequentialEnd_(chunks_->end())
+        , guided_(guided)
+    { initThreadState_(); }
+
+    /*!
+     * \brief Iterate over the chunks of entities which were determined beforehand.
+     *
+     * The chunks must stay alive and valid, i.e., the grid must not change, until the
+     * iteration is finished.
+     */
+    explicit ThreadedEntityIterator(const Chunks& chunks,
+                                    bool guided = ThreadedEntityIteratorSchedule::defaultGuided())
+        : chunks_(&chunks)
+        , sequentialEnd_(chunks_->end())
+        , guided_(guided)
+    { initThreadState_(); }
+
+    ThreadedEntityIterator(const ThreadedEntityIterator& other)
+        : ownedChunks_(other.ownedChunks_)
+        , chunks_(other.chunks_)
+        , sequentialEnd_(other.sequentialEnd_)
+        , guided_(other.guided_)
+        , threadState_(other.threadState_)
+        , nextChunk_(other.nextChunk_.load())
+        , finished_(other.finished_.load())
+    { }
 
     // begin iterating over the grid in parallel
     EntityIterator beginParallel()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_; // make the next thread look at the next element
-        mutex_.unlock();
-
-        return tmp;
+        auto& state = threadState_[threadId_()];
+        grabChunks_(state);
+        return state.it;
     }
 
     // returns true if the last element was reached
@@ -70,29 +196,85 @@ public:
     // make sure that the loop over the grid is finished
     void setFinished()
     {
-        mutex_.lock();
-        sequentialIt_ = sequentialEnd_;
-        mutex_.unlock();
+        finished_.store(true, std::memory_order_relaxed);
+        nextChunk_.store(chunks_->chunkBegin().size(), std::memory_order_relaxed);
     }
 
     // prefix increment: goes to the next element which is not yet worked on by any
     // thread
     EntityIterator increment()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_;
-        mutex_.unlock();
+        auto& state = threadState_[threadId_()];
+        if (state.remaining > 1 && !finished_.load(std::memory_order_relaxed)) {
+            ++state.it;
+            --state.remaining;
+        }
+        else
+            grabChunks_(state);
 
-        return tmp;
+        return state.it;
     }
 
 private:
-    EntityIterator sequentialIt_;
+    void initThreadState_()
+    {
+        int numThreads = 1;
+#ifdef _OPENMP
+        numThreads = omp_get_max_threads();
+#endif
+        threadState_.assign(numThreads, ThreadState{sequentialEnd_, 0});
+    }
+
+    static unsigned threadId_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    // assign the next block of chunks to a thread. If there is nothing left to do, the
+    // iterator of the thread is set to the end of the grid view.
+    void grabChunks_(ThreadState& state)
+    {
+        const auto& chunkBegin = chunks_->chunkBegin();
+        const std::size_t chunkSize = chunks_->chunkSize();
+        const std::size_t numChunks = chunkBegin.size();
+        std::size_t firstChunk;
+        std::size_t n = 1;
+        if (guided_) {
+            firstChunk = nextChunk_.load(std::memory_order_relaxed);
+            do {
+                if (firstChunk >= numChunks)
+                    break;
+                n = std::max<std::size_t>(1, (numChunks - firstChunk)/(2*threadState_.size()));
+            } while (!nextChunk_.compare_exchange_weak(firstChunk, firstChunk + n,
+                                                       std::memory_order_relaxed));
+        }
+        else
+            firstChunk = nextChunk_.fetch_add(1, std::memory_order_relaxed);
+
+        if (firstChunk >= numChunks || finished_.load(std::memory_order_relaxed)) {
+            state.it = sequentialEnd_;
+            state.remaining = 0;
+            return;
+        }
+
+        const std::size_t lastChunk = std::min(firstChunk + n, numChunks);
+        state.it = chunkBegin[firstChunk];
+        state.remaining = std::min(lastChunk*chunkSize, chunks_->numEntities()) - firstChunk*chunkSize;
+    }
+
+    // the chunks if they are determined by this object
+    std::shared_ptr<const Chunks> ownedChunks_;
+    const Chunks* chunks_;
     EntityIterator sequentialEnd_;
+    bool guided_;
 
-    std::mutex mutex_;
+    std::vector<ThreadState> threadState_;
+    std::atomic<std::size_t> nextChunk_{0};
+    std::atomic<bool> finished_{false};
 };
 } // namespace Opm
 
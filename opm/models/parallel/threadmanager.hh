@@ -32,6 +32,7 @@
 #endif
 
 #include <opm/models/discretization/common/fvbaseparameters.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/propertysystem.hh>
 
@@ -63,6 +64,11 @@ public:
         Parameters::registerParam<TypeTag, Parameters::ThreadsPerProcess>
             ("The maximum number of threads to be instantiated per process "
              "('-1' means 'automatic')");
+        Parameters::registerParam<TypeTag, Parameters::ThreadedIteratorChunkSize>
+            ("The number of consecutive grid entities handed out to a thread at once");
+        Parameters::registerParam<TypeTag, Parameters::ThreadedIteratorGuidedSchedule>
+            ("Reduce the number of grid entities handed out to a thread at once "
+             "as the loop over the grid advances");
     }
 
     /*!
@@ -104,6 +110,11 @@ public:
             if (numThreads_ > 0)
                 omp_set_num_threads(numThreads_);
 #endif
+
+            ThreadedEntityIteratorSchedule::setDefaultChunkSize(
+                Parameters::get<TypeTag, Parameters::ThreadedIteratorChunkSize>());
+            ThreadedEntityIteratorSchedule::setDefaultGuided(
+                Parameters::get<TypeTag, Parameters::ThreadedIteratorGuidedSchedule>());
         }
 
 #ifdef _OPENMP
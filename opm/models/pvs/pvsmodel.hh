@@ -48,6 +48,7 @@
 #include <opm/models/io/vtkcompositionmodule.hh>
 #include <opm/models/io/vtkenergymodule.hh>
 #include <opm/models/io/vtkdiffusionmodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
@@ -483,6 +484,27 @@ public:
         this->solution(/*timeIdx=*/1)[dofIdx].setPhasePresence(tmp);
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::numSerializedDofFlags
+     */
+    unsigned numSerializedDofFlags() const
+    { return 1; }
+
+    /*!
+     * \copydoc FvBaseDiscretization::serializeDofFlags
+     */
+    void serializeDofFlags(unsigned dofIdx, int* flags) const
+    { flags[0] = this->solution(/*timeIdx=*/0)[dofIdx].phasePresence(); }
+
+    /*!
+     * \copydoc FvBaseDiscretization::deserializeDofFlags
+     */
+    void deserializeDofFlags(unsigned dofIdx, const int* flags)
+    {
+        this->solution(/*timeIdx=*/0)[dofIdx].setPhasePresence(static_cast<short>(flags[0]));
+        this->solution(/*timeIdx=*/1)[dofIdx].setPhasePresence(static_cast<short>(flags[0]));
+    }
+
     /*!
      * \internal
      * \brief Do the primary variable switching after a Newton iteration.
@@ -492,57 +514,57 @@ public:
      */
     void switchPrimaryVars_()
     {
-        numSwitched_ = 0;
-
-        int succeeded;
-        try {
-            std::vector<bool> visited(this->numGridDof(), false);
+        // the degrees of freedom are distributed among the threads via the elements.
+        // since a degree of freedom may be shared by multiple elements, it is handled
+        // by the thread which claims it first.
+        std::vector<unsigned char> visited(this->numGridDof(), 0);
+        unsigned numSwitched = 0;
+        int succeeded = 1;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:numSwitched) reduction(min:succeeded)
+#endif
+        {
             ElementContext elemCtx(this->simulator_);
+            auto elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                if (elemIt->partitionType() != Dune::InteriorEntity)
+                    continue;
+
+                try {
+                    elemCtx.updatePrimaryStencil(*elemIt);
 
-            for (const auto& elem : elements(this->gridView_, Dune::Partitions::interior)) {
-                elemCtx.updateStencil(elem);
-
-                size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
-                for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
-                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-
-                    if (visited[globalIdx])
-                        continue;
-                    visited[globalIdx] = true;
-
-                    // compute the intensive quantities of the current degree of freedom
-                    auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
-                    elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-                    const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-
-                    // evaluate primary variable switch
-                    short oldPhasePresence = priVars.phasePresence();
-
-                    // set the primary variables and the new phase state
-                    // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
-
-                    if (oldPhasePresence != priVars.phasePresence()) {
-                        if (verbosity_ > 1)
-                            printSwitchedPhases_(elemCtx,
-                                                 dofIdx,
-                                                 intQuants.fluidState(),
-                                                 oldPhasePresence,
-                                                 priVars);
-                        ++numSwitched_;
+                    size_t numLocalDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+                        unsigned char wasVisited;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+                        {
+                            wasVisited = visited[globalIdx];
+                            visited[globalIdx] = 1;
+                        }
+                        if (wasVisited)
+                            continue;
+
+                        numSwitched += switchPrimaryVarsOfDof_(elemCtx, dofIdx, globalIdx);
                     }
                 }
+                catch (...) {
+                    succeeded = 0;
+                    break;
+                }
             }
-
-            succeeded = 1;
         }
-        catch (...)
-        {
+
+        if (!succeeded)
             std::cout << "rank " << this->simulator_.gridView().comm().rank()
                       << " caught an exception during primary variable switching"
                       << "\n"  << std::flush;
-            succeeded = 0;
-        }
+
         succeeded = this->simulator_.gridView().comm().min(succeeded);
 
         if (!succeeded)
@@ -551,13 +573,50 @@ public:
         // make sure that if there was a variable switch in an
         // other partition we will also set the switch flag
         // for our partition.
-        numSwitched_ = this->gridView_.comm().sum(numSwitched_);
+        numSwitched_ = this->gridView_.comm().sum(numSwitched);
 
         if (verbosity_ > 0)
             this->simulator_.model().newtonMethod().endIterMsg()
                 << ", num switched=" << numSwitched_;
     }
 
+    // evaluate the primary variable switch of a single degree of freedom and return
+    // whether its phase presence has changed. the cache of the intensive quantities
+    // has already been invalidated by the update of the solution, so the quantities
+    // are always computed here. they are stored in the cache for the next
+    // linearization if the switch leaves the primary variables unchanged.
+    unsigned switchPrimaryVarsOfDof_(ElementContext& elemCtx, unsigned dofIdx, unsigned globalIdx)
+    {
+        auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
+        const PrimaryVariables oldPriVars(priVars);
+
+        // compute the intensive quantities of the current degree of freedom
+        elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+        // set the primary variables and the new phase state
+        // from the current fluid state
+        priVars.assignNaive(intQuants.fluidState());
+
+        if (priVars.phasePresence() == oldPriVars.phasePresence() && priVars == oldPriVars)
+            this->updateCachedIntensiveQuantities(intQuants, globalIdx, /*timeIdx=*/0);
+
+        if (oldPriVars.phasePresence() == priVars.phasePresence())
+            return 0;
+
+        if (verbosity_ > 1) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            printSwitchedPhases_(elemCtx,
+                                 dofIdx,
+                                 intQuants.fluidState(),
+                                 oldPriVars.phasePresence(),
+                                 priVars);
+        }
+        return 1;
+    }
+
     template <class FluidState>
     void printSwitchedPhases_(const ElementContext& elemCtx,
                               unsigned dofIdx,
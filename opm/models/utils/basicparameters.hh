@@ -52,6 +52,15 @@ struct DomainSizeY { using type = Properties::UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct DomainSizeZ { using type = Properties::UndefinedProperty; };
 
+/*!
+ * \brief The ordering of the elements computed by the vanguard.
+ *
+ * Possible values are 'none' (keep the numbering of the grid), 'rcm' (reverse
+ * Cuthill-McKee) and 'hilbert' (Hilbert curve through the element centers).
+ */
+template<class TypeTag, class MyTypeTag>
+struct ElementOrdering { using type = Properties::UndefinedProperty; };
+
 //! The default value for the simulation's end time
 template<class TypeTag, class MyTypeTag>
 struct EndTime { using type = Properties::UndefinedProperty; };
@@ -100,6 +109,14 @@ struct PrintProperties { using type = Properties::UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct RestartTime { using type = Properties::UndefinedProperty; };
 
+//! Write restart files in a background thread while the simulation proceeds
+template<class TypeTag, class MyTypeTag>
+struct EnableAsyncRestartFiles { using type = Properties::UndefinedProperty; };
+
+//! The maximum number of restart files which are written concurrently in the background
+template<class TypeTag, class MyTypeTag>
+struct MaxPendingRestartFiles { using type = Properties::UndefinedProperty; };
+
 } // namespace Opm:Parameters
 
 #endif
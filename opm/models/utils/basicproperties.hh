@@ -177,6 +177,11 @@ struct Vanguard<TypeTag, TTag::NumericModel>
 
 namespace Opm::Parameters {
 
+//! By default, the elements are numbered as by the grid
+template<class TypeTag>
+struct ElementOrdering<TypeTag, Properties::TTag::NumericModel>
+{ static constexpr auto value = "none"; };
+
 //! The default value for the simulation's end time
 template<class TypeTag>
 struct EndTime<TypeTag, Properties::TTag::NumericModel>
@@ -232,6 +237,16 @@ struct RestartTime<TypeTag, Properties::TTag::NumericModel>
     static constexpr type value = -1e35;
 };
 
+//! By default, restart files are written synchronously
+template<class TypeTag>
+struct EnableAsyncRestartFiles<TypeTag, Properties::TTag::NumericModel>
+{ static constexpr bool value = false; };
+
+//! By default, at most two restart files are in flight at any time
+template<class TypeTag>
+struct MaxPendingRestartFiles<TypeTag, Properties::TTag::NumericModel>
+{ static constexpr unsigned value = 2; };
+
 } // namespace Opm::Parameters
 
 #endif
@@ -0,0 +1,615 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Instrumentation
+ */
+#ifndef EWOMS_INSTRUMENTATION_HH
+#define EWOMS_INSTRUMENTATION_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#define EWOMS_INSTRUMENTATION_HAVE_PERF_EVENT 1
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Collects the time spent in a set of named, nested code regions.
+ *
+ * Regions are registered using addRegion() before the object is used concurrently.
+ * Each region accumulates the wall clock time and the number of calls separately for
+ * every thread and, if requested and supported by the operating system, the values of
+ * a few hardware performance counters. These are read via the perf_event interface
+ * of Linux, i.e., each entry and exit of a region costs a system call while they are
+ * enabled. For this reason, they are only read for the regions which were registered
+ * with \c readCounters set to true; regions which are entered once per element or per
+ * degree of freedom should only measure the time.
+ *
+ * The accumulated values of a time step are turned into a record by finishTimeStep()
+ * which can be written in the JSON lines or in the CSV format.
+ *
+ * If the object is disabled, entering and leaving regions does nothing.
+ */
+class Instrumentation
+{
+public:
+    //! The hardware performance counters which are recorded.
+    enum Counter : unsigned {
+        cycles = 0,
+        instructions,
+        cacheMisses,
+        branchMisses,
+        numCounters
+    };
+
+    //! The parent index of top-level regions.
+    static constexpr unsigned noParent = std::numeric_limits<unsigned>::max();
+
+    /*!
+     * \brief Measures a region from its construction until its destruction or until
+     *        stop() is called.
+     */
+    class ScopedRegion
+    {
+    public:
+        ScopedRegion(Instrumentation& instrumentation, unsigned regionIdx)
+            : instrumentation_(instrumentation.enabled() ? &instrumentation : nullptr)
+            , regionIdx_(regionIdx)
+        {
+            if (instrumentation_)
+                instrumentation_->beginRegion(regionIdx_);
+        }
+
+        ScopedRegion(const ScopedRegion&) = delete;
+        ScopedRegion& operator=(const ScopedRegion&) = delete;
+
+        ~ScopedRegion()
+        { stop(); }
+
+        /*!
+         * \brief Leave the region before the object is destroyed.
+         */
+        void stop()
+        {
+            if (instrumentation_) {
+                instrumentation_->endRegion(regionIdx_);
+                instrumentation_ = nullptr;
+            }
+        }
+
+    private:
+        Instrumentation* instrumentation_;
+        unsigned regionIdx_;
+    };
+
+    //! The values of a region which were accumulated during a time step.
+    struct RegionRecord
+    {
+        std::uint64_t calls = 0;
+        double time = 0.0;
+        double maxThreadTime = 0.0;
+        std::vector<double> threadTimes;
+        std::array<std::uint64_t, numCounters> counters{};
+    };
+
+    //! The values of all regions which were accumulated during a time step.
+    struct StepRecord
+    {
+        int timeStepIdx = 0;
+        double time = 0.0;
+        double timeStepSize = 0.0;
+        int numIterations = 0;
+        bool converged = false;
+        std::vector<RegionRecord> regions;
+    };
+
+    explicit Instrumentation(unsigned numThreads = 1)
+        : enabled_(false)
+        , hardwareCountersEnabled_(false)
+    {
+        threadData_.resize(std::max(numThreads, 1u));
+        for (auto& data : threadData_)
+            data = std::make_unique<ThreadData>();
+    }
+
+    ~Instrumentation()
+    {
+        for (auto& data : threadData_)
+            closeCounters_(*data);
+    }
+
+    Instrumentation(const Instrumentation&) = delete;
+    Instrumentation& operator=(const Instrumentation&) = delete;
+
+    /*!
+     * \brief Register a new region and return its index.
+     *
+     * \param name The name of the region. It should not contain commas or slashes.
+     * \param parentIdx The index of the region which encloses the new one.
+     * \param readCounters Specifies whether the hardware performance counters are read
+     *                     when the region is entered and left.
+     */
+    unsigned addRegion(const std::string& name,
+                       unsigned parentIdx = noParent,
+                       bool readCounters = true)
+    {
+        if (parentIdx != noParent && parentIdx >= numRegions())
+            throw std::invalid_argument("Invalid parent for instrumentation region '" + name + "'");
+
+        names_.push_back(name);
+        parents_.push_back(parentIdx);
+        countedRegions_.push_back(readCounters);
+        for (auto& data : threadData_)
+            data->regions.resize(names_.size());
+
+        return static_cast<unsigned>(names_.size() - 1);
+    }
+
+    /*!
+     * \brief Returns the number of registered regions.
+     */
+    unsigned numRegions() const
+    { return static_cast<unsigned>(names_.size()); }
+
+    /*!
+     * \brief Returns the number of threads for which values are accumulated.
+     */
+    unsigned numThreads() const
+    { return static_cast<unsigned>(threadData_.size()); }
+
+    /*!
+     * \brief Returns the name of a region.
+     */
+    const std::string& regionName(unsigned regionIdx) const
+    { return names_[regionIdx]; }
+
+    /*!
+     * \brief Returns the name of a region prefixed by the ones of its enclosing regions.
+     *
+     * The names are separated by slashes, e.g. "linearize/flux".
+     */
+    std::string regionPath(unsigned regionIdx) const
+    {
+        std::string path = names_[regionIdx];
+        for (unsigned idx = parents_[regionIdx]; idx != noParent; idx = parents_[idx])
+            path = names_[idx] + "/" + path;
+        return path;
+    }
+
+    /*!
+     * \brief Returns the index of the region which encloses a region.
+     */
+    unsigned parentRegion(unsigned regionIdx) const
+    { return parents_[regionIdx]; }
+
+    /*!
+     * \brief Returns true if the hardware performance counters are read for a region.
+     */
+    bool readsCounters(unsigned regionIdx) const
+    { return countedRegions_[regionIdx]; }
+
+    /*!
+     * \brief Specify whether regions are measured.
+     */
+    void setEnabled(bool yesno)
+    { enabled_ = yesno; }
+
+    /*!
+     * \brief Returns true if regions are measured.
+     */
+    bool enabled() const
+    { return enabled_; }
+
+    /*!
+     * \brief Returns true if hardware performance counters can be recorded on this
+     *        platform.
+     */
+    static constexpr bool hardwareCountersSupported()
+    {
+#if EWOMS_INSTRUMENTATION_HAVE_PERF_EVENT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Specify whether hardware performance counters are recorded.
+     *
+     * The counters are opened by each thread when it enters its first region. If this
+     * fails, e.g. because the kernel does not permit it, the counters of the thread
+     * stay zero.
+     */
+    void setHardwareCountersEnabled(bool yesno)
+    {
+        if (yesno && !hardwareCountersSupported())
+            throw std::runtime_error("Hardware performance counters are not supported "
+                                     "on this platform");
+        hardwareCountersEnabled_ = yesno;
+    }
+
+    /*!
+     * \brief Returns true if hardware performance counters are recorded.
+     */
+    bool hardwareCountersEnabled() const
+    { return hardwareCountersEnabled_; }
+
+    /*!
+     * \brief Enter a region on the calling thread.
+     */
+    void beginRegion(unsigned regionIdx)
+    {
+        const unsigned threadId = threadId_();
+        if (!enabled_ || threadId >= threadData_.size())
+            return;
+
+        auto& data = *threadData_[threadId];
+        auto& region = data.regions[regionIdx];
+        if (hardwareCountersEnabled_ && countedRegions_[regionIdx])
+            readCounters_(data, region.counterStart);
+        region.startTime = Clock::now();
+    }
+
+    /*!
+     * \brief Leave a region on the calling thread.
+     */
+    void endRegion(unsigned regionIdx)
+    {
+        const auto endTime = Clock::now();
+        const unsigned threadId = threadId_();
+        if (!enabled_ || threadId >= threadData_.size())
+            return;
+
+        auto& data = *threadData_[threadId];
+        auto& region = data.regions[regionIdx];
+        region.time += std::chrono::duration<double>(endTime - region.startTime).count();
+        ++region.calls;
+        if (hardwareCountersEnabled_ && countedRegions_[regionIdx]) {
+            std::array<std::uint64_t, numCounters> counterEnd{};
+            readCounters_(data, counterEnd);
+            for (unsigned counterIdx = 0; counterIdx < numCounters; ++counterIdx)
+                region.counters[counterIdx] += counterEnd[counterIdx] - region.counterStart[counterIdx];
+        }
+    }
+
+    /*!
+     * \brief Returns the time spent in a region by all threads since the last call to
+     *        finishTimeStep().
+     */
+    double time(unsigned regionIdx) const
+    {
+        double result = 0.0;
+        for (const auto& data : threadData_)
+            result += data->regions[regionIdx].time;
+        return result;
+    }
+
+    /*!
+     * \brief Returns the number of times a region was entered since the last call to
+     *        finishTimeStep().
+     */
+    std::uint64_t calls(unsigned regionIdx) const
+    {
+        std::uint64_t result = 0;
+        for (const auto& data : threadData_)
+            result += data->regions[regionIdx].calls;
+        return result;
+    }
+
+    /*!
+     * \brief Turn the values accumulated since the last call into a record and reset
+     *        them.
+     *
+     * This must not be called while regions are measured.
+     */
+    const StepRecord& finishTimeStep(int timeStepIdx,
+                                     double time,
+                                     double timeStepSize,
+                                     int numIterations,
+                                     bool converged)
+    {
+        StepRecord record;
+        record.timeStepIdx = timeStepIdx;
+        record.time = time;
+        record.timeStepSize = timeStepSize;
+        record.numIterations = numIterations;
+        record.converged = converged;
+        record.regions.resize(numRegions());
+        for (unsigned regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+            auto& regionRecord = record.regions[regionIdx];
+            regionRecord.threadTimes.resize(numThreads());
+            for (unsigned threadId = 0; threadId < numThreads(); ++threadId) {
+                auto& region = threadData_[threadId]->regions[regionIdx];
+                regionRecord.calls += region.calls;
+                regionRecord.time += region.time;
+                regionRecord.maxThreadTime = std::max(regionRecord.maxThreadTime, region.time);
+                regionRecord.threadTimes[threadId] = region.time;
+                for (unsigned counterIdx = 0; counterIdx < numCounters; ++counterIdx)
+                    regionRecord.counters[counterIdx] += region.counters[counterIdx];
+
+                region.calls = 0;
+                region.time = 0.0;
+                region.counters.fill(0);
+            }
+        }
+
+        history_.push_back(std::move(record));
+        return history_.back();
+    }
+
+    /*!
+     * \brief Returns the records of the time steps which were finished since the last
+     *        call to clearHistory().
+     */
+    const std::vector<StepRecord>& history() const
+    { return history_; }
+
+    /*!
+     * \brief Discard all records of finished time steps.
+     */
+    void clearHistory()
+    { history_.clear(); }
+
+    /*!
+     * \brief Write a record as a single line JSON object.
+     */
+    void writeJsonRecord(std::ostream& os, const StepRecord& record) const
+    {
+        os << "{\"timeStep\":" << record.timeStepIdx
+           << ",\"time\":" << record.time
+           << ",\"timeStepSize\":" << record.timeStepSize
+           << ",\"iterations\":" << record.numIterations
+           << ",\"converged\":" << (record.converged ? "true" : "false")
+           << ",\"regions\":[";
+        for (unsigned regionIdx = 0; regionIdx < record.regions.size(); ++regionIdx) {
+            const auto& regionRecord = record.regions[regionIdx];
+            if (regionIdx > 0)
+                os << ",";
+            os << "{\"name\":";
+            writeJsonString_(os, regionPath(regionIdx));
+            os << ",\"calls\":" << regionRecord.calls
+               << ",\"time\":" << regionRecord.time
+               << ",\"maxThreadTime\":" << regionRecord.maxThreadTime
+               << ",\"threadTimes\":[";
+            for (unsigned threadId = 0; threadId < regionRecord.threadTimes.size(); ++threadId)
+                os << (threadId > 0 ? "," : "") << regionRecord.threadTimes[threadId];
+            os << "]";
+            if (hardwareCountersEnabled_ && countedRegions_[regionIdx]) {
+                for (unsigned counterIdx = 0; counterIdx < numCounters; ++counterIdx)
+                    os << ",\"" << counterName_(counterIdx) << "\":"
+                       << regionRecord.counters[counterIdx];
+            }
+            os << "}";
+        }
+        os << "]}\n";
+    }
+
+    /*!
+     * \brief Write the header line of the CSV format.
+     */
+    void writeCsvHeader(std::ostream& os) const
+    {
+        os << "timeStep,time,timeStepSize,iterations,converged,"
+           << "region,calls,regionTime,maxThreadTime,threadTimes";
+        for (unsigned counterIdx = 0; counterIdx < numCounters; ++counterIdx)
+            os << "," << counterName_(counterIdx);
+        os << "\n";
+    }
+
+    /*!
+     * \brief Write a record as CSV, i.e. one line per region.
+     *
+     * The times of the individual threads are separated by semicolons. The counters
+     * of regions for which they are not read are left empty.
+     */
+    void writeCsvRecord(std::ostream& os, const StepRecord& record) const
+    {
+        for (unsigned regionIdx = 0; regionIdx < record.regions.size(); ++regionIdx) {
+            const auto& regionRecord = record.regions[regionIdx];
+            os << record.timeStepIdx
+               << "," << record.time
+               << "," << record.timeStepSize
+               << "," << record.numIterations
+               << "," << (record.converged ? 1 : 0)
+               << "," << regionPath(regionIdx)
+               << "," << regionRecord.calls
+               << "," << regionRecord.time
+               << "," << regionRecord.maxThreadTime
+               << ",";
+            for (unsigned threadId = 0; threadId < regionRecord.threadTimes.size(); ++threadId)
+                os << (threadId > 0 ? ";" : "") << regionRecord.threadTimes[threadId];
+            for (unsigned counterIdx = 0; counterIdx < numCounters; ++counterIdx) {
+                os << ",";
+                if (hardwareCountersEnabled_ && countedRegions_[regionIdx])
+                    os << regionRecord.counters[counterIdx];
+            }
+            os << "\n";
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct RegionData
+    {
+        Clock::time_point startTime{};
+        double time = 0.0;
+        std::uint64_t calls = 0;
+        std::array<std::uint64_t, numCounters> counterStart{};
+        std::array<std::uint64_t, numCounters> counters{};
+    };
+
+    // the data of each thread is allocated separately to avoid false sharing
+    struct ThreadData
+    {
+        ThreadData()
+        { counterFds.fill(-1); }
+
+        std::vector<RegionData> regions;
+        // the first descriptor is the leader of the group of counters
+        std::array<int, numCounters> counterFds;
+        bool countersOpened = false;
+    };
+
+    static unsigned threadId_()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    static const char* counterName_(unsigned counterIdx)
+    {
+        static const char* names[numCounters] =
+            { "cycles", "instructions", "cacheMisses", "branchMisses" };
+        return names[counterIdx];
+    }
+
+    static void writeJsonString_(std::ostream& os, const std::string& str)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+
+        os << '"';
+        for (const char c : str) {
+            switch (c) {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    os << "\\u00"
+                       << hexDigits[static_cast<unsigned char>(c) >> 4]
+                       << hexDigits[static_cast<unsigned char>(c) & 0xf];
+                else
+                    os << c;
+            }
+        }
+        os << '"';
+    }
+
+    void readCounters_([[maybe_unused]] ThreadData& data,
+                       std::array<std::uint64_t, numCounters>& values) const
+    {
+        values.fill(0);
+#if EWOMS_INSTRUMENTATION_HAVE_PERF_EVENT
+        if (!data.countersOpened)
+            openCounters_(data);
+        if (data.counterFds[0] < 0)
+            return;
+
+        // with PERF_FORMAT_GROUP, the number of counters is followed by their values
+        std::array<std::uint64_t, numCounters + 1> buffer{};
+        if (::read(data.counterFds[0], buffer.data(), sizeof(buffer)) != sizeof(buffer))
+            return;
+        std::copy(buffer.begin() + 1, buffer.end(), values.begin());
+#endif
+    }
+
+    void openCounters_([[maybe_unused]] ThreadData& data) const
+    {
+        data.countersOpened = true;
+#if EWOMS_INSTRUMENTATION_HAVE_PERF_EVENT
+        static const std::uint64_t configs[numCounters] =
+            { PERF_COUNT_HW_CPU_CYCLES,
+              PERF_COUNT_HW_INSTRUCTIONS,
+              PERF_COUNT_HW_CACHE_MISSES,
+              PERF_COUNT_HW_BRANCH_MISSES };
+
+        auto& fds = data.counterFds;
+        for (unsigned counterIdx = 0; counterIdx < numCounters; ++counterIdx) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[counterIdx];
+            attr.disabled = (counterIdx == 0) ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            // measure the calling thread on any CPU
+            const long fd = ::syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                                      /*groupFd=*/fds[0], /*flags=*/0);
+            if (fd < 0) {
+                closeCounters_(data);
+                return;
+            }
+            fds[counterIdx] = static_cast<int>(fd);
+        }
+
+        ::ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void closeCounters_(ThreadData& data) const
+    {
+        for (int& fd : data.counterFds) {
+#if EWOMS_INSTRUMENTATION_HAVE_PERF_EVENT
+            if (fd >= 0)
+                ::close(fd);
+#endif
+            fd = -1;
+        }
+    }
+
+    bool enabled_;
+    bool hardwareCountersEnabled_;
+
+    std::vector<std::string> names_;
+    std::vector<unsigned> parents_;
+    std::vector<bool> countedRegions_;
+    std::vector<std::unique_ptr<ThreadData>> threadData_;
+    std::vector<StepRecord> history_;
+};
+
+} // namespace Opm
+
+#endif
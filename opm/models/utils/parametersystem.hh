@@ -41,10 +41,13 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -95,6 +98,50 @@ struct ParamInfo
 template <class TypeTag, template<class,class> class Property>
 auto get(bool errorIfNotRegistered = true);
 
+//! The C++ type of the value of a parameter
+template <class TypeTag, template<class,class> class Param>
+using ParamType_ = std::conditional_t<std::is_same_v<std::decay_t<decltype(getPropValue<TypeTag, Param>())>,
+                                                     const char*>, std::string,
+                                      std::decay_t<decltype(getPropValue<TypeTag, Param>())>>;
+
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Stores the value of a run-time parameter after it has been looked up once.
+ *
+ * The values of all registered parameters are resolved when the parameter
+ * registration is closed, and they are resolved again if the parameter system is
+ * reset. Thus, get() does not need to look up or parse anything in the common case.
+ *
+ * A resolved value is never modified: resolving the parameter again stores the new
+ * value separately. Thus, the references returned by get() can be used concurrently
+ * and stay valid until the end of the program.
+ */
+template <class TypeTag, template<class,class> class Param>
+class ResolvedParam
+{
+public:
+    using ValueType = ParamType_<TypeTag, Param>;
+
+    static const ValueType& get();
+
+    static void resolve()
+    { resolve_(); }
+
+private:
+    struct Entry
+    {
+        ValueType value;
+        unsigned generation;
+    };
+
+    static const Entry& resolve_();
+
+    static inline std::atomic<const Entry*> current_{nullptr};
+    static inline std::list<Entry> entries_;
+    static inline std::mutex mutex_;
+};
+
 class ParamRegFinalizerBase_
 {
 public:
@@ -110,8 +157,8 @@ public:
     void retrieve() override
     {
         // retrieve the parameter once to make sure that its value does
-        // not contain a syntax error.
-        std::ignore = get<TypeTag, Property>(/*errorIfNotRegistered=*/true);
+        // not contain a syntax error. this also caches its value.
+        ResolvedParam<TypeTag, Property>::resolve();
     }
 };
 } // namespace Parameters
@@ -153,12 +200,17 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    //! Incremented whenever the values of the parameters may have changed
+    static std::atomic<unsigned>& generation()
+    { return storage_().generation; }
+
     static void clear()
     {
         storage_().tree.reset(new Dune::ParameterTree());
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        ++storage_().generation;
     }
 
 private:
@@ -171,12 +223,14 @@ private:
         {
             tree.reset(new Dune::ParameterTree());
             registrationOpen = true;
+            generation = 0;
         }
 
         std::unique_ptr<Dune::ParameterTree> tree;
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
         bool registrationOpen;
+        std::atomic<unsigned> generation;
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -575,6 +629,9 @@ std::string parseCommandLineOptions(int argc,
 {
     Dune::ParameterTree& paramTree = GetProp<TypeTag, Properties::ParameterMetaData>::tree();
 
+    // the resolved parameter values must be looked up again
+    ++GetProp<TypeTag, Properties::ParameterMetaData>::generation();
+
     // handle the "--help" parameter
     if (!helpPreamble.empty()) {
         for (int i = 1; i < argc; ++i) {
@@ -680,6 +737,9 @@ void parseParameterFile(const std::string& fileName, bool overwrite = true)
 {
     Dune::ParameterTree& paramTree = GetProp<TypeTag, Properties::ParameterMetaData>::tree();
 
+    // the resolved parameter values must be looked up again
+    ++GetProp<TypeTag, Properties::ParameterMetaData>::generation();
+
     std::set<std::string> seenKeys;
     std::ifstream ifs(fileName);
     unsigned curLineNum = 0;
@@ -860,6 +920,51 @@ auto get(bool errorIfNotRegistered)
     return ParamsMeta::tree().template get<ParamType>(paramName, defaultValue);
 }
 
+template <class TypeTag, template<class,class> class Param>
+const typename ResolvedParam<TypeTag, Param>::ValueType&
+ResolvedParam<TypeTag, Param>::get()
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+    const Entry* entry = current_.load(std::memory_order_acquire);
+    if (!entry || entry->generation != ParamsMeta::generation().load(std::memory_order_acquire))
+        entry = &resolve_();
+
+    return entry->value;
+}
+
+template <class TypeTag, template<class,class> class Param>
+const typename ResolvedParam<TypeTag, Param>::Entry&
+ResolvedParam<TypeTag, Param>::resolve_()
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const unsigned generation = ParamsMeta::generation().load(std::memory_order_acquire);
+    const Entry* entry = current_.load(std::memory_order_relaxed);
+    if (entry && entry->generation == generation)
+        return *entry;
+
+    // the previous entries are kept because references to their values may still
+    // be in use
+    entries_.push_back(Entry{::Opm::Parameters::get<TypeTag, Param>(/*errorIfNotRegistered=*/true),
+                             generation});
+    current_.store(&entries_.back(), std::memory_order_release);
+    return entries_.back();
+}
+
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Retrieve a runtime parameter without looking it up in the parameter tree.
+ *
+ * In contrast to get(), this returns the value which was determined when the parameter
+ * registration was closed, i.e., it is cheap enough to be called in inner loops. The
+ * parameter must have been registered.
+ */
+template <class TypeTag, template<class,class> class Param>
+const auto& getResolved()
+{ return ResolvedParam<TypeTag, Param>::get(); }
+
 /*!
  * \brief Retrieves the lists of parameters specified at runtime and their values.
  *
@@ -1021,6 +1126,7 @@ void endParamRegistration()
                                "to close it once.");
 
     ParamsMeta::registrationOpen() = false;
+    ++ParamsMeta::generation();
 
     // loop over all parameters and retrieve their values to make sure
     // that there is no syntax error
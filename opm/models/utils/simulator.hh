@@ -36,12 +36,15 @@
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 #include <opm/models/parallel/mpiutil.hh>
+#include <opm/models/parallel/tasklets.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <vector>
 #include <string>
@@ -109,6 +112,38 @@ class Simulator
     using MPIComm = typename Dune::MPIHelper::MPICommunicator;
     using Communication = Dune::Communication<MPIComm>;
 
+    /*!
+     * \brief Writes a staged restart file to disk.
+     *
+     * The tasklet owns the restarter, so the simulation may proceed while the
+     * file is written. Errors are reported via the future of the tasklet.
+     */
+    class RestartWriterTasklet_ : public TaskletInterface
+    {
+    public:
+        explicit RestartWriterTasklet_(std::shared_ptr<Restart> restarter)
+            : restarter_(std::move(restarter))
+        {}
+
+        void run() override
+        {
+            try {
+                restarter_->commitStaged();
+                done_.set_value();
+            }
+            catch (...) {
+                done_.set_exception(std::current_exception());
+            }
+        }
+
+        std::future<void> future()
+        { return done_.get_future(); }
+
+    private:
+        std::shared_ptr<Restart> restarter_;
+        std::promise<void> done_;
+    };
+
 public:
     // do not allow to copy simulators around
     Simulator(const Simulator& ) = delete;
@@ -263,6 +298,15 @@ public:
         Parameters::registerParam<TypeTag, Parameters::PredeterminedTimeStepsFile>
             ("A file with a list of predetermined time step sizes (one "
              "time step per line)");
+        Parameters::registerParam<TypeTag, Parameters::EnableAsyncRestartFiles>
+            ("Write restart files in a background thread while the simulation proceeds");
+        Parameters::registerParam<TypeTag, Parameters::MaxPendingRestartFiles>
+            ("The maximum number of restart files which are written in the "
+             "background at the same time");
+        Parameters::registerParam<TypeTag, Parameters::ElementOrdering>
+            ("The ordering of the elements used by the discretization. Possible "
+             "values are 'none', 'rcm' (reverse Cuthill-McKee) and 'hilbert' "
+             "(Hilbert curve through the element centers)");
 
         Vanguard::registerParameters();
         Model::registerParameters();
@@ -810,6 +854,11 @@ public:
         }
         executionTimer_.stop();
 
+        // make sure that all restart files are on disk before we finish
+        writeTimer_.start();
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(waitForPendingRestartFiles());
+        writeTimer_.stop();
+
         EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->finalize());
     }
 
@@ -905,6 +954,11 @@ public:
      */
     void serialize()
     {
+        if (Parameters::get<TypeTag, Parameters::EnableAsyncRestartFiles>()) {
+            serializeAsync_();
+            return;
+        }
+
         using Restarter = Restart;
         Restarter res;
         res.serializeBegin(*this);
@@ -919,6 +973,19 @@ public:
         res.serializeEnd();
     }
 
+    /*!
+     * \brief Wait until all restart files which are written in the background
+     *        are on disk.
+     *
+     * If writing any of these files failed, the corresponding exception is
+     * rethrown.
+     */
+    void waitForPendingRestartFiles()
+    {
+        while (!pendingRestartFiles_.empty())
+            waitForOldestRestartFile_();
+    }
+
     /*!
      * \brief Write the time manager's state to a restart file.
      *
@@ -976,6 +1043,48 @@ public:
     }
 
 private:
+    /*!
+     * \brief Snapshot the state of the simulation into an in-memory buffer and
+     *        write it to disk in a background thread.
+     *
+     * At most MaxPendingRestartFiles files are in flight at any time; if this
+     * limit is reached, we wait until the oldest one has been written.
+     */
+    void serializeAsync_()
+    {
+        const unsigned maxPending =
+            std::max(1u, Parameters::get<TypeTag, Parameters::MaxPendingRestartFiles>());
+        while (pendingRestartFiles_.size() >= maxPending)
+            waitForOldestRestartFile_();
+
+        auto res = std::make_shared<Restart>();
+        res->setStaged(true);
+        res->serializeBegin(*this);
+        this->serialize(*res);
+        problem_->serialize(*res);
+        model_->serialize(*res);
+        res->serializeEnd();
+
+        if (gridView().comm().rank() == 0)
+            std::cout << "Serialize to file '" << res->fileName() << "' in the background"
+                      << ", next time step size: " << timeStepSize()
+                      << "\n" << std::flush;
+
+        if (!restartWriter_)
+            restartWriter_ = std::make_unique<TaskletRunner>(/*numWorkers=*/1);
+
+        auto tasklet = std::make_shared<RestartWriterTasklet_>(std::move(res));
+        pendingRestartFiles_.push_back(tasklet->future());
+        restartWriter_->dispatch(tasklet);
+    }
+
+    void waitForOldestRestartFile_()
+    {
+        auto done = std::move(pendingRestartFiles_.front());
+        pendingRestartFiles_.pop_front();
+        done.get();
+    }
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -1002,6 +1111,9 @@ private:
 
     bool finished_;
     bool verbose_;
+
+    std::unique_ptr<TaskletRunner> restartWriter_;
+    std::deque<std::future<void>> pendingRestartFiles_;
 };
 
 namespace Properties {
@@ -36,7 +36,13 @@
 
 #include <opm/common/Exceptions.hpp>
 
+#include <dune/istl/scalarproducts.hh>
+
+#include <array>
+#include <cstddef>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace Opm {
 namespace Linear {
@@ -48,17 +54,34 @@ namespace Linear {
  *
  * See https://en.wikipedia.org/wiki/Biconjugate_gradient_stabilized_method, (article
  * date: December 19, 2016)
+ *
+ * Optionally, the pipelined variant of the method can be used (see setPipelined()). It
+ * needs more memory and vector updates than the classic algorithm, but it only
+ * requires two fused global reductions per iteration, each of which is overlapped
+ * with an application of the preconditioner and of the linear operator. If the
+ * scalar product provides startDots() and finishDots() methods (like the
+ * OverlappingScalarProduct), these reductions are done in the background.
  */
-template <class LinearOperator, class Vector, class Preconditioner>
+template <class LinearOperator,
+          class Vector,
+          class Preconditioner,
+          class ScalarProduct = Dune::ScalarProduct<Vector> >
 class BiCGStabSolver
 {
     using ConvergenceCriterion = Opm::Linear::ConvergenceCriterion<Vector>;
     using Scalar = typename LinearOperator::field_type;
 
+    template <class SP, class = void>
+    struct HasNonBlockingDots_ : std::false_type {};
+
+    template <class SP>
+    struct HasNonBlockingDots_<SP, std::void_t<decltype(std::declval<const SP&>().finishDots())>>
+        : std::true_type {};
+
 public:
     BiCGStabSolver(Preconditioner& preconditioner,
                    ConvergenceCriterion& convergenceCriterion,
-                   Dune::ScalarProduct<Vector>& scalarProduct)
+                   ScalarProduct& scalarProduct)
         : preconditioner_(preconditioner)
         , convergenceCriterion_(convergenceCriterion)
         , scalarProduct_(scalarProduct)
@@ -67,6 +90,8 @@ public:
         b_ = nullptr;
 
         maxIterations_ = 1000;
+        verbosity_ = 0;
+        pipelined_ = false;
     }
 
     /*!
@@ -102,6 +127,25 @@ public:
     unsigned verbosity() const
     { return verbosity_; }
 
+    /*!
+     * \brief Specify whether the pipelined variant of the BiCGStab method should be
+     *        used.
+     *
+     * The pipelined method hides the latency of the global reductions, which makes
+     * it attractive if many processes are involved. It assumes that the
+     * preconditioner is a fixed linear operator and its recursively updated residual
+     * may deviate slightly more from the true residual than the one of the classic
+     * method.
+     */
+    void setPipelined(bool value)
+    { pipelined_ = value; }
+
+    /*!
+     * \brief Returns true if the pipelined variant of the BiCGStab method is used.
+     */
+    bool pipelined() const
+    { return pipelined_; }
+
     /*!
      * \brief Set the matrix "A" of the linear system.
      */
@@ -167,6 +211,9 @@ public:
             convergenceCriterion_.printInitial();
         }
 
+        if (pipelined_)
+            return applyPipelined_(x, r);
+
         // r0 = b - Ax (i.e., r -= A*x_0 = b, because x_0 == 0)
         //A_->applyscaleadd(/*alpha=*/-1.0, x, r);
 
@@ -338,16 +385,245 @@ public:
     { return report_; }
 
 private:
+    // pipelined preconditioned BiCGStab method, see
+    //
+    // S. Cools, W. Vanroose: "The communication-hiding pipelined BiCGstab method for the
+    // parallel solution of large unsymmetric linear systems", Parallel Computing 65,
+    // pp. 1-20, 2017
+    //
+    // the vectors with a "Bar" suffix are the preconditioned counterparts of the
+    // vectors without one, e.g., rBar = K^-1*r.
+    bool applyPipelined_(Vector& x, Vector& r)
+    {
+        // epsilon used for detecting breakdowns
+        const Scalar breakdownEps = std::numeric_limits<Scalar>::min() * Scalar(1e10);
+
+        // r0hat = r0
+        const Vector& r0hat = *b_;
+
+        // create all the temporary vectors which we need. since x is zero, they are
+        // all initialized to zero. q_i and y_i are stored in r and w, qBar_i in rBar.
+        Vector rBar(x);
+        Vector w(x);
+        Vector wBar(x);
+        Vector t(x);
+        Vector pBar(x);
+        Vector s(x);
+        Vector sBar(x);
+        Vector z(x);
+        Vector zBar(x);
+        Vector v(x);
+        const std::size_t n = x.size();
+
+        // the results of the non-blocking reductions. these arrays must outlive the
+        // guard below, which waits for a pending reduction if the preconditioner, the
+        // linear operator or the convergence criterion throw an exception while the
+        // reduction still writes to one of them.
+        std::array<Scalar, 2> initialDots;
+        std::array<Scalar, 2> omegaDots;
+        std::array<Scalar, 4> alphaDots;
+        const PendingDotsGuard_ pendingDotsGuard(*this);
+
+        // rBar_0 = K^-1*r_0, w_0 = A*rBar_0
+        applyPreconditioner_(rBar, r);
+        A_->apply(rBar, w);
+
+        // (r0hat,r_0) and (r0hat,w_0). the reduction is overlapped with computing
+        // wBar_0 = K^-1*w_0 and t_0 = A*wBar_0
+        startDots_(initialDots, {&r0hat, &r0hat}, {&r, &w});
+        applyPreconditioner_(wBar, w);
+        A_->apply(wBar, t);
+        finishDots_();
+
+        // rho_0 = (r0hat,r_0), alpha_0 = rho_0/(r0hat,w_0), beta_(-1) = 0
+        Scalar rho = initialDots[0];
+        if (std::abs(initialDots[1]) <= breakdownEps)
+            throw NumericalProblem("Breakdown of the BiCGStab solver (division by zero)");
+        Scalar alpha = rho/initialDots[1];
+        Scalar beta = 0.0;
+        Scalar omega = 0.0;
+
+        for (; report_.iterations() < maxIterations_; report_.increment()) {
+            // this loop conflates the following operations:
+            //
+            // pBar_i = rBar_i + beta_(i-1)*(pBar_(i-1) - omega_(i-1)*sBar_(i-1))
+            // s_i = w_i + beta_(i-1)*(s_(i-1) - omega_(i-1)*z_(i-1))
+            // sBar_i = wBar_i + beta_(i-1)*(sBar_(i-1) - omega_(i-1)*zBar_(i-1))
+            // z_i = t_i + beta_(i-1)*(z_(i-1) - omega_(i-1)*v_(i-1))
+            // q_i = r_i - alpha_i*s_i
+            // qBar_i = rBar_i - alpha_i*sBar_i
+            // y_i = w_i - alpha_i*z_i
+            for (std::size_t i = 0; i < n; ++i) {
+                updateDirection_(pBar[i], rBar[i], sBar[i], beta, omega);
+                updateDirection_(s[i], w[i], z[i], beta, omega);
+                updateDirection_(sBar[i], wBar[i], zBar[i], beta, omega);
+                updateDirection_(z[i], t[i], v[i], beta, omega);
+
+                r[i].axpy(-alpha, s[i]);
+                rBar[i].axpy(-alpha, sBar[i]);
+                w[i].axpy(-alpha, z[i]);
+            }
+
+            // (q_i,y_i) and (y_i,y_i). the reduction is overlapped with computing
+            // zBar_i = K^-1*z_i and v_i = A*zBar_i
+            startDots_(omegaDots, {&r, &w}, {&w, &w});
+            applyPreconditioner_(zBar, z);
+            A_->apply(zBar, v);
+            finishDots_();
+
+            // omega_i = (q_i,y_i)/(y_i,y_i)
+            if (std::abs(omegaDots[1]) <= breakdownEps)
+                throw NumericalProblem("Breakdown of the BiCGStab solver (division by zero)");
+            omega = omegaDots[0]/omegaDots[1];
+            if (std::abs(omega) <= breakdownEps)
+                throw NumericalProblem("Breakdown of the BiCGStab solver (stagnation detected)");
+
+            // this loop conflates the following operations:
+            //
+            // x_(i+1) = x_i + alpha_i*pBar_i + omega_i*qBar_i
+            // r_(i+1) = q_i - omega_i*y_i
+            // rBar_(i+1) = qBar_i - omega_i*(wBar_i - alpha_i*zBar_i)
+            // w_(i+1) = y_i - omega_i*(t_i - alpha_i*v_i)
+            //
+            // wBar_i is not needed anymore afterwards, so it is used to store the update
+            // of the solution for the convergence criterion.
+            for (std::size_t i = 0; i < n; ++i) {
+                auto delta = pBar[i];
+                delta *= alpha;
+                delta.axpy(omega, rBar[i]);
+                x[i] += delta;
+
+                r[i].axpy(-omega, w[i]);
+
+                auto tmp = zBar[i];
+                tmp *= -alpha;
+                tmp += wBar[i];
+                rBar[i].axpy(-omega, tmp);
+
+                tmp = v[i];
+                tmp *= -alpha;
+                tmp += t[i];
+                w[i].axpy(-omega, tmp);
+
+                wBar[i] = delta;
+            }
+
+            // (r0hat,r_(i+1)), (r0hat,w_(i+1)), (r0hat,s_i) and (r0hat,z_i). the
+            // reduction is overlapped with the convergence check and with computing
+            // wBar_(i+1) = K^-1*w_(i+1) and t_(i+1) = A*wBar_(i+1)
+            startDots_(alphaDots, {&r0hat, &r0hat, &r0hat, &r0hat}, {&r, &w, &s, &z});
+
+            // do convergence check and print terminal output
+            convergenceCriterion_.update(/*curSol=*/x, /*delta=*/wBar, r);
+            if (convergenceCriterion_.converged()) {
+                finishDots_();
+                if (verbosity_ > 0) {
+                    convergenceCriterion_.print(1.0 + report_.iterations());
+                    std::cout << "-------- /BiCGStabSolver --------" << std::endl;
+                }
+
+                preconditioner_.post(x);
+                report_.setConverged(true);
+                return report_.converged();
+            }
+            else if (convergenceCriterion_.failed()) {
+                finishDots_();
+                if (verbosity_ > 0) {
+                    convergenceCriterion_.print(1.0 + report_.iterations());
+                    std::cout << "-------- /BiCGStabSolver --------" << std::endl;
+                }
+
+                report_.setConverged(false);
+                return report_.converged();
+            }
+
+            if (verbosity_ > 1)
+                convergenceCriterion_.print(1.0 + report_.iterations());
+
+            applyPreconditioner_(wBar, w);
+            A_->apply(wBar, t);
+            finishDots_();
+
+            // beta_i = (alpha_i/omega_i)*(rho_(i+1)/rho_i)
+            if (std::abs(rho) <= breakdownEps)
+                throw NumericalProblem("Breakdown of the BiCGStab solver (division by zero)");
+            beta = (alpha/omega)*(alphaDots[0]/rho);
+            rho = alphaDots[0];
+
+            // alpha_(i+1) = rho_(i+1)/((r0hat,w_(i+1)) + beta_i*(r0hat,s_i) - beta_i*omega_i*(r0hat,z_i))
+            Scalar denom = alphaDots[1] + beta*alphaDots[2] - beta*omega*alphaDots[3];
+            if (std::abs(denom) <= breakdownEps)
+                throw NumericalProblem("Breakdown of the BiCGStab solver (division by zero)");
+            alpha = rho/denom;
+            if (std::abs(alpha) <= breakdownEps)
+                throw NumericalProblem("Breakdown of the BiCGStab solver (stagnation detected)");
+        }
+
+        report_.setConverged(false);
+        return report_.converged();
+    }
+
+    // a = b + beta*(a - omega*c)
+    template <class Block>
+    static void updateDirection_(Block& a, const Block& b, const Block& c, Scalar beta, Scalar omega)
+    {
+        a.axpy(-omega, c);
+        a *= beta;
+        a += b;
+    }
+
+    // the recurrences of the pipelined method assume that the preconditioner is a fixed
+    // linear operator, so the result must not depend on the previous contents of the
+    // destination vector (which some preconditioners use as initial guess).
+    void applyPreconditioner_(Vector& dest, const Vector& src)
+    {
+        dest = 0.0;
+        preconditioner_.apply(dest, src);
+    }
+
+    template <std::size_t numDots>
+    void startDots_(std::array<Scalar, numDots>& result,
+                    const std::array<const Vector*, numDots>& x,
+                    const std::array<const Vector*, numDots>& y)
+    {
+        if constexpr (HasNonBlockingDots_<ScalarProduct>::value)
+            scalarProduct_.startDots(result, x, y);
+        else {
+            for (std::size_t k = 0; k < numDots; ++k)
+                result[k] = scalarProduct_.dot(*x[k], *y[k]);
+        }
+    }
+
+    void finishDots_()
+    {
+        if constexpr (HasNonBlockingDots_<ScalarProduct>::value)
+            scalarProduct_.finishDots();
+    }
+
+    // waits for the pending reduction of the scalar products when it goes out of scope
+    struct PendingDotsGuard_
+    {
+        explicit PendingDotsGuard_(BiCGStabSolver& solver)
+            : solver_(solver)
+        {}
+
+        ~PendingDotsGuard_()
+        { solver_.finishDots_(); }
+
+        BiCGStabSolver& solver_;
+    };
+
     const LinearOperator* A_;
     const Vector* b_;
 
     Preconditioner& preconditioner_;
     ConvergenceCriterion& convergenceCriterion_;
-    Dune::ScalarProduct<Vector>& scalarProduct_;
+    ScalarProduct& scalarProduct_;
     SolverReport report_;
 
     unsigned maxIterations_;
     unsigned verbosity_;
+    bool pipelined_;
 };
 
 } // namespace Linear
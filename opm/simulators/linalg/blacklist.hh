@@ -38,6 +38,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
@@ -61,19 +62,22 @@ public:
     BlackList(const BlackList&) = default;
 
     bool hasIndex(Index nativeIdx) const
-    { return nativeBlackListedIndices_.count(nativeIdx) > 0; }
+    {
+        return nativeIdx >= 0
+            && static_cast<size_t>(nativeIdx) < isBlackListed_.size()
+            && isBlackListed_[static_cast<size_t>(nativeIdx)];
+    }
 
     void addIndex(Index nativeIdx)
-    { nativeBlackListedIndices_.insert(nativeIdx); }
-
-    Index nativeToDomestic(Index nativeIdx) const
     {
-        auto it = nativeToDomesticMap_.find(nativeIdx);
-        if (it == nativeToDomesticMap_.end())
-            return -1;
-        return it->second;
+        if (static_cast<size_t>(nativeIdx) >= isBlackListed_.size())
+            isBlackListed_.resize(static_cast<size_t>(nativeIdx) + 1, false);
+        isBlackListed_[static_cast<size_t>(nativeIdx)] = true;
     }
 
+    Index nativeToDomestic(Index nativeIdx) const
+    { return nativeToDomesticMap_.get(nativeIdx); }
+
     void setPeerList(ProcessRank peerRank, const PeerBlackList& peerBlackList)
     { peerBlackLists_[peerRank] = peerBlackList; }
 
@@ -105,11 +109,12 @@ public:
     void print() const
     {
         std::cout << "my own blacklisted indices:\n";
-        auto idxIt = nativeBlackListedIndices_.begin();
-        const auto& idxEndIt = nativeBlackListedIndices_.end();
-        for (; idxIt != idxEndIt; ++idxIt)
-            std::cout << " (native index: " << *idxIt
-                      << ", domestic index: " << nativeToDomestic(*idxIt) << ")\n";
+        for (size_t nativeIdx = 0; nativeIdx < isBlackListed_.size(); ++nativeIdx) {
+            if (!isBlackListed_[nativeIdx])
+                continue;
+            std::cout << " (native index: " << nativeIdx
+                      << ", domestic index: " << nativeToDomestic(static_cast<Index>(nativeIdx)) << ")\n";
+        }
         std::cout << "blacklisted indices of the peers in my own domain:\n";
         auto peerListIt = peerBlackLists_.begin();
         const auto& peerListEndIt = peerBlackLists_.end();
@@ -165,13 +170,14 @@ private:
             Index globalIdx = globalIdxBuf[2*i + 0];
             Index nativeIdx = globalIdxBuf[2*i + 1];
 
-            nativeToDomesticMap_[nativeIdx] = domesticOverlap.globalToDomestic(globalIdx);
+            nativeToDomesticMap_.set(nativeIdx, domesticOverlap.globalToDomestic(globalIdx));
         }
     }
 #endif // HAVE_MPI
 
-    std::set<Index> nativeBlackListedIndices_;
-    std::map<Index, Index> nativeToDomesticMap_;
+    // flags for all native indices up to the largest black-listed one
+    std::vector<bool> isBlackListed_;
+    IndexHashMap nativeToDomesticMap_;
 #if HAVE_MPI
     std::map<ProcessRank, MpiBuffer<unsigned>> numGlobalIdxSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index>> globalIdxSendBuff_;
@@ -40,6 +40,7 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <tuple>
 #include <vector>
 
 #if HAVE_MPI
@@ -90,6 +91,7 @@ public:
 
         // calculate the set of local indices on the border (beware:
         // _not_ the native ones)
+        isLocalBorderIndex_.resize(numLocal(), false);
         auto it = borderList.begin();
         const auto& endIt = borderList.end();
         for (; it != endIt; ++it) {
@@ -97,7 +99,7 @@ public:
             if (localIdx < 0)
                 continue;
 
-            localBorderIndices_.insert(localIdx);
+            isLocalBorderIndex_[static_cast<unsigned>(localIdx)] = true;
         }
 
         // compute the set of processes which are neighbors of the
@@ -147,7 +149,11 @@ public:
      * \brief Returns true iff a local index is a border index.
      */
     bool isBorder(Index localIdx) const
-    { return localBorderIndices_.count(localIdx) > 0; }
+    {
+        return localIdx >= 0
+            && static_cast<size_t>(localIdx) < isLocalBorderIndex_.size()
+            && isLocalBorderIndex_[static_cast<unsigned>(localIdx)];
+    }
 
     /*!
      * \brief Returns true iff a local index is a border index shared with a
@@ -204,7 +210,7 @@ public:
      * \brief Return the map of (peer rank, border distance) for a given local
      * index.
      */
-    const std::map<ProcessRank, BorderDistance> &
+    const OverlapByIndex::value_type&
     foreignOverlapByLocalIndex(Index localIdx) const
     {
         assert(isLocal(localIdx));
@@ -400,21 +406,8 @@ protected:
                 else if (foreignOverlapByLocalIndex_[static_cast<unsigned>(localColIdx)].count(peerRank) > 0)
                     continue;
 
-                // check whether the new index is already in the overlap
-                bool hasIndex = false;
-                typename SeedList::iterator sIt = nextSeedList.begin();
-                typename SeedList::iterator sEndIt = nextSeedList.end();
-                for (; sIt != sEndIt; ++sIt) {
-                    if (sIt->index == nativeColIdx && sIt->peerRank == peerRank) {
-                        hasIndex = true;
-                        break;
-                    }
-                }
-                if (hasIndex)
-                    continue; // we already have this index
-
                 // add the current processes to the seed list for the
-                // next overlap level
+                // next overlap level. duplicates are removed below.
                 IndexRankDist newTuple;
                 newTuple.index = nativeColIdx;
                 newTuple.peerRank = peerRank;
@@ -423,6 +416,14 @@ protected:
             }
         }
 
+        // remove the duplicate (index, peer rank) pairs from the new seed list. this
+        // keeps the first occurrence of each pair because sorting std::list objects is
+        // stable.
+        nextSeedList.sort([](const IndexRankDist& a, const IndexRankDist& b)
+                          { return std::tie(a.index, a.peerRank) < std::tie(b.index, b.peerRank); });
+        nextSeedList.unique([](const IndexRankDist& a, const IndexRankDist& b)
+                            { return a.index == b.index && a.peerRank == b.peerRank; });
+
         // clear the old seed list to save some memory
         seedList.clear();
 
@@ -679,9 +680,9 @@ protected:
     // index
     std::vector<ProcessRank> masterRank_;
 
-    // set of all local indices which are on the border of some remote
+    // specifies for each local index whether it is on the border of some remote
     // process
-    std::set<Index> localBorderIndices_;
+    std::vector<bool> isLocalBorderIndex_;
 
     // stores the set of process ranks which are in the overlap for a
     // given row index "owned" by the current rank. The second value
@@ -33,10 +33,10 @@
 #include <dune/istl/operators.hh>
 
 #include <algorithm>
-#include <set>
-#include <map>
+#include <cassert>
 #include <iostream>
 #include <tuple>
+#include <vector>
 
 #if HAVE_MPI
 #include <mpi.h>
@@ -56,8 +56,11 @@ class GlobalIndices
 {
     GlobalIndices(const GlobalIndices& ) = delete;
 
-    using GlobalToDomesticMap = std::map<Index, Index>;
-    using DomesticToGlobalMap = std::map<Index, Index>;
+    // the global indices are scattered over the whole index space, so they are hashed.
+    // the domestic indices are dense, so a plain array with -1 for unused entries is
+    // sufficient.
+    using GlobalToDomesticMap = IndexHashMap;
+    using DomesticToGlobalMap = std::vector<Index>;
 
 public:
     GlobalIndices(const ForeignOverlap& foreignOverlap)
@@ -87,23 +90,17 @@ public:
      */
     Index domesticToGlobal(Index domesticIdx) const
     {
-        assert(domesticToGlobal_.find(domesticIdx) != domesticToGlobal_.end());
+        assert(0 <= domesticIdx && static_cast<size_t>(domesticIdx) < domesticToGlobal_.size());
+        assert(domesticToGlobal_[static_cast<size_t>(domesticIdx)] >= 0);
 
-        return domesticToGlobal_.find(domesticIdx)->second;
+        return domesticToGlobal_[static_cast<size_t>(domesticIdx)];
     }
 
     /*!
      * \brief Converts a global index to a domestic one.
      */
     Index globalToDomestic(Index globalIdx) const
-    {
-        const auto& tmp = globalToDomestic_.find(globalIdx);
-
-        if (tmp == globalToDomestic_.end())
-            return -1;
-
-        return tmp->second;
-    }
+    { return globalToDomestic_.get(globalIdx); }
 
     /*!
      * \brief Returns the number of indices which are in the interior or
@@ -126,11 +123,19 @@ public:
      */
     void addIndex(Index domesticIdx, Index globalIdx)
     {
-        domesticToGlobal_[domesticIdx] = globalIdx;
-        globalToDomestic_[globalIdx] = domesticIdx;
-        numDomestic_ = domesticToGlobal_.size();
+        assert(domesticIdx >= 0 && globalIdx >= 0);
+
+        size_t domIdx = static_cast<size_t>(domesticIdx);
+        if (domIdx >= domesticToGlobal_.size())
+            domesticToGlobal_.resize(domIdx + 1, -1);
+        if (domesticToGlobal_[domIdx] < 0)
+            ++numIndices_;
 
-        assert(domesticToGlobal_.size() == globalToDomestic_.size());
+        domesticToGlobal_[domIdx] = globalIdx;
+        globalToDomestic_.set(globalIdx, domesticIdx);
+        numDomestic_ = numIndices_;
+
+        assert(numIndices_ == globalToDomestic_.size());
     }
 
     /*!
@@ -181,7 +186,7 @@ public:
      * \brief Return true iff a given global index already exists
      */
     bool hasGlobalIndex(Index globalIdx) const
-    { return globalToDomestic_.find(globalIdx) != globalToDomestic_.end(); }
+    { return globalToDomestic_.contains(globalIdx); }
 
     /*!
      * \brief Prints the global indices of all domestic indices
@@ -192,9 +197,12 @@ public:
         std::cout << "(domestic index, global index, domestic->global->domestic)"
                   << " list for rank " << myRank_ << "\n";
 
-        for (size_t domIdx = 0; domIdx < domesticToGlobal_.size(); ++domIdx)
+        for (size_t domIdx = 0; domIdx < domesticToGlobal_.size(); ++domIdx) {
+            if (domesticToGlobal_[domIdx] < 0)
+                continue;
             std::cout << "(" << domIdx << ", " << domesticToGlobal(domIdx)
                       << ", " << globalToDomestic(domesticToGlobal(domIdx)) << ") ";
+        }
         std::cout << "\n" << std::flush;
     }
 
@@ -203,8 +211,13 @@ protected:
     // global index list
     void buildGlobalIndices_()
     {
+        numIndices_ = 0;
 #if HAVE_MPI
         numDomestic_ = 0;
+
+        // all local indices end up in the translation tables
+        domesticToGlobal_.reserve(foreignOverlap_.numLocal());
+        globalToDomestic_.reserve(foreignOverlap_.numLocal());
 #else
         numDomestic_ = foreignOverlap_.numLocal();
 #endif
@@ -337,6 +350,7 @@ protected:
 
     int domesticOffset_;
     size_t numDomestic_;
+    size_t numIndices_;
     const ForeignOverlap& foreignOverlap_;
 
     GlobalToDomesticMap globalToDomestic_;
@@ -59,14 +59,13 @@ namespace Linear {
     class PreconditionerWrapper##PREC_NAME                                      \
     {                                                                           \
         using Scalar = GetPropType<TypeTag, Properties::Scalar>;                 \
-        using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>; \
-        using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;            \
-        using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>; \
+        using PreconditionerMatrix = GetPropType<TypeTag, Properties::PreconditionerMatrix>; \
+        using PreconditionerVector = GetPropType<TypeTag, Properties::PreconditionerVector>; \
                                                                                 \
     public:                                                                     \
-        using SequentialPreconditioner = ISTL_PREC_TYPE<IstlMatrix,             \
-                                                        OverlappingVector,      \
-                                                        OverlappingVector>;     \
+        using SequentialPreconditioner = ISTL_PREC_TYPE<PreconditionerMatrix,   \
+                                                        PreconditionerVector,   \
+                                                        PreconditionerVector>;  \
         PreconditionerWrapper##PREC_NAME()                                      \
         {}                                                                      \
                                                                                 \
@@ -78,7 +77,7 @@ namespace Linear {
                 ("The relaxation factor of the preconditioner");                \
         }                                                                       \
                                                                                 \
-        void prepare(IstlMatrix& matrix)                                        \
+        void prepare(PreconditionerMatrix& matrix)                              \
         {                                                                       \
             int order = Parameters::get<TypeTag, Properties::PreconditionerOrder>(); \
             Scalar relaxationFactor = Parameters::get<TypeTag, Properties::PreconditionerRelaxation>(); \
@@ -103,13 +102,13 @@ namespace Linear {
     class PreconditionerWrapper##PREC_NAME                                      \
     {                                                                           \
         using Scalar = GetPropType<TypeTag, Properties::Scalar>;                 \
-        using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>; \
-        using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>; \
+        using PreconditionerMatrix = GetPropType<TypeTag, Properties::PreconditionerMatrix>; \
+        using PreconditionerVector = GetPropType<TypeTag, Properties::PreconditionerVector>; \
                                                                                 \
     public:                                                                     \
-        using SequentialPreconditioner = ISTL_PREC_TYPE<OverlappingMatrix,      \
-                                                        OverlappingVector,      \
-                                                        OverlappingVector>;     \
+        using SequentialPreconditioner = ISTL_PREC_TYPE<PreconditionerMatrix,   \
+                                                        PreconditionerVector,   \
+                                                        PreconditionerVector>;  \
         PreconditionerWrapper##PREC_NAME()                                      \
         {}                                                                      \
                                                                                 \
@@ -119,7 +118,7 @@ namespace Linear {
                 ("The relaxation factor of the preconditioner");                \
         }                                                                       \
                                                                                 \
-        void prepare(OverlappingMatrix& matrix)                                 \
+        void prepare(PreconditionerMatrix& matrix)                              \
         {                                                                       \
             Scalar relaxationFactor =                                           \
             Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();   \
@@ -149,13 +148,13 @@ template <class TypeTag>
 class PreconditionerWrapperILU
 {
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
-    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
-    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+    using PreconditionerMatrix = GetPropType<TypeTag, Properties::PreconditionerMatrix>;
+    using PreconditionerVector = GetPropType<TypeTag, Properties::PreconditionerVector>;
 
     static constexpr int order = getPropValue<TypeTag, Properties::PreconditionerOrder>();
 
 public:
-    using SequentialPreconditioner = Dune::SeqILU<OverlappingMatrix, OverlappingVector, OverlappingVector, order>;
+    using SequentialPreconditioner = Dune::SeqILU<PreconditionerMatrix, PreconditionerVector, PreconditionerVector, order>;
 
     PreconditionerWrapperILU()
     {}
@@ -166,7 +165,7 @@ public:
             ("The relaxation factor of the preconditioner");
     }
 
-    void prepare(OverlappingMatrix& matrix)
+    void prepare(PreconditionerMatrix& matrix)
     {
         Scalar relaxationFactor = Parameters::get<TypeTag, Properties::PreconditionerRelaxation>();
 
@@ -27,10 +27,15 @@
 #ifndef EWOMS_ISTL_SPARSE_MATRIX_ADAPTER_HH
 #define EWOMS_ISTL_SPARSE_MATRIX_ADAPTER_HH
 
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
 
+#include <atomic>
+#include <cstdint>
+
 namespace Opm {
 namespace Linear {
 
@@ -60,6 +65,7 @@ public:
         : rows_(rows)
         , columns_(columns)
         , istlMatrix_()
+        , sparsityVersion_(0)
     {}
 
     /*!
@@ -78,6 +84,7 @@ public:
     {
         // allocate raw matrix
         istlMatrix_.reset(new IstlMatrix(rows_, columns_, IstlMatrix::random));
+        sparsityVersion_ = nextSparsityVersion_();
 
         // make sure sparsityPattern is consistent with number of rows
         assert(rows_ == sparsityPattern.size());
@@ -100,6 +107,43 @@ public:
         istlMatrix_->endindices();
     }
 
+    /*!
+     * \brief Allocate matrix structure given a finalized sparsity pattern in CSR
+     *        format.
+     *
+     * Since the rows of the pattern are already sorted and free of duplicates, they are
+     * copied into the matrix as a whole.
+     */
+    void reserve(const SparsityPattern& sparsityPattern)
+    {
+        // allocate raw matrix
+        istlMatrix_.reset(new IstlMatrix(rows_, columns_, IstlMatrix::random));
+        sparsityVersion_ = nextSparsityVersion_();
+
+        // make sure sparsityPattern is consistent with number of rows
+        assert(rows_ == sparsityPattern.numRows());
+
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
+            istlMatrix_->setrowsize(dofIdx, sparsityPattern.rowSize(dofIdx));
+        istlMatrix_->endrowsizes();
+
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
+            istlMatrix_->setIndices(dofIdx,
+                                    sparsityPattern.rowBegin(dofIdx),
+                                    sparsityPattern.rowEnd(dofIdx));
+        istlMatrix_->endindices();
+    }
+
+    /*!
+     * \brief Returns a number which identifies the sparsity pattern of the matrix.
+     *
+     * It is different for each call to reserve() of any adapter object, so data
+     * structures which depend on the sparsity pattern can detect whether they are
+     * outdated. Before the structure is allocated, it is 0.
+     */
+    std::uint64_t sparsityVersion() const
+    { return sparsityVersion_; }
+
     /*!
      * \brief Return constant reference to matrix implementation.
      */
@@ -190,10 +234,17 @@ public:
     { }
 
 protected:
+    static std::uint64_t nextSparsityVersion_()
+    {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
     size_t rows_;
     size_t columns_;
 
     std::unique_ptr<IstlMatrix> istlMatrix_;
+    std::uint64_t sparsityVersion_;
 };
 
 }} // namespace Linear, Opm
@@ -46,6 +46,24 @@ struct PreconditionerWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverScalar { using type = UndefinedProperty; };
 
+/*!
+ * \brief The floating point type used to store the matrix of the preconditioner.
+ *
+ * If this differs from the LinearSolverScalar, the preconditioner is set up on a copy
+ * of the overlapping matrix which uses this type, while the Krylov iteration and the
+ * residual are computed using the LinearSolverScalar.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerScalar { using type = UndefinedProperty; };
+
+//! The type of the matrix on which the preconditioner is set up
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerMatrix { using type = UndefinedProperty; };
+
+//! The type of the vectors to which the preconditioner is applied
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerVector { using type = UndefinedProperty; };
+
 /*!
  * \brief The size of the algebraic overlap of the linear solver.
  *
@@ -90,6 +108,27 @@ struct PreconditionerOrder { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct PreconditionerRelaxation { using type = UndefinedProperty; };
 
+/*!
+ * \brief The number of subsequent linear solves for which a preconditioner is reused.
+ *
+ * If this is 0, the preconditioner is set up from scratch for each linear solve.
+ * Otherwise, it is reused without modification for the given number of solves, and
+ * then its numerical values are updated, which is cheaper than setting it up from
+ * scratch for some preconditioners (e.g., AMG).
+ */
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerReuseCount { using type = UndefinedProperty; };
+
+/*!
+ * \brief The factor by which the number of linear iterations may grow before a reused
+ *        preconditioner is set up from scratch.
+ *
+ * The reference is the number of iterations of the first solve after the
+ * preconditioner was set up or updated.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerReuseMaxIterationGrowth { using type = UndefinedProperty; };
+
 //! number of iterations between solver restarts for the GMRES solver
 template<class TypeTag, class MyTypeTag>
 struct GMResRestart { using type = UndefinedProperty; };
@@ -106,6 +145,16 @@ template<class TypeTag, class MyTypeTag>
 struct AmgCoarsenTarget { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverMaxError { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the pipelined variant of the BiCGStab solver should be used.
+ *
+ * The pipelined variant fuses the scalar products of each iteration into two global
+ * reductions which are overlapped with the preconditioner and the matrix-vector
+ * products.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverPipelined { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
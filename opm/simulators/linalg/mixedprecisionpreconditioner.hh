@@ -0,0 +1,126 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::MixedPrecisionPreconditioner
+ */
+#ifndef EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+#define EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+
+#include <dune/istl/preconditioner.hh>
+
+#include <cstddef>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief Adapts a preconditioner which operates on vectors of a different (usually
+ *        lower) floating point precision to the vectors of the linear solver.
+ *
+ * The input vectors are converted to the precision of the wrapped preconditioner, and
+ * the results of apply() are converted back to the precision of the linear solver.
+ * pre() and post() operate on copies and never modify the vectors of the solver. This allows
+ * to store the matrix of the preconditioner in single precision while the Krylov
+ * iteration is carried out in double precision.
+ */
+template <class SeqPreCond, class Vector>
+class MixedPrecisionPreconditioner
+    : public Dune::Preconditioner<Vector, Vector>
+{
+    using PreconditionerVector = typename SeqPreCond::domain_type;
+
+public:
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = typename Vector::field_type;
+
+    explicit MixedPrecisionPreconditioner(SeqPreCond& seqPreCond)
+        : seqPreCond_(seqPreCond)
+    {}
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return seqPreCond_.category(); }
+
+    /*!
+     * \brief Prepare the wrapped preconditioner.
+     *
+     * The preconditioner only sees converted copies of the vectors: Rounding the
+     * residual or the solution of the linear solver to the precision of the
+     * preconditioner would spoil the accuracy of the Krylov iteration.
+     */
+    void pre(domain_type& x, range_type& b) override
+    {
+        copy_(x_, x);
+        copy_(d_, b);
+        seqPreCond_.pre(x_, d_);
+    }
+
+    void apply(domain_type& v, const range_type& d) override
+    {
+        // some preconditioners use the update vector as their initial guess
+        copy_(x_, v);
+        copy_(d_, d);
+        seqPreCond_.apply(x_, d_);
+        copy_(v, x_);
+    }
+
+    /*!
+     * \brief Clean up the wrapped preconditioner.
+     *
+     * Like for pre(), the solution of the linear solver is left untouched.
+     */
+    void post(domain_type& x) override
+    {
+        copy_(x_, x);
+        seqPreCond_.post(x_);
+    }
+
+private:
+    template <class DestVector, class SrcVector>
+    static void copy_(DestVector& dest, const SrcVector& src)
+    {
+        using DestField = typename DestVector::field_type;
+
+        if (dest.size() != src.size())
+            dest.resize(src.size());
+
+        const std::size_t n = src.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto& srcBlock = src[i];
+            auto& destBlock = dest[i];
+            for (std::size_t j = 0; j < srcBlock.size(); ++j)
+                destBlock[j] = static_cast<DestField>(srcBlock[j]);
+        }
+    }
+
+    SeqPreCond& seqPreCond_;
+    PreconditionerVector x_;
+    PreconditionerVector d_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -37,11 +37,13 @@
 #include <dune/istl/scalarproducts.hh>
 #include <dune/istl/io.hh>
 #include <algorithm>
-#include <set>
+#include <cassert>
+#include <cstddef>
 #include <map>
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <utility>
 
 namespace Opm {
 namespace Linear {
@@ -58,7 +60,8 @@ public:
     using Overlap = Opm::Linear::DomesticOverlapFromBCRSMatrix;
 
 private:
-    using Entries = std::vector<std::set<Index> >;
+    // the (row, column) pairs of the domestic matrix entries
+    using Entries = std::vector<std::pair<Index, Index> >;
 
 public:
     using ColIterator = typename ParentType::ColIterator;
@@ -216,44 +219,53 @@ public:
                                 "row");
     }
 
+    /*!
+     * \brief Copy the entries of a non-overlapping matrix to the overlapping one.
+     *
+     * The blocks of the overlapping matrix which do not correspond to any entry of
+     * the native matrix are set to zero. The destination of each native entry is
+     * determined when the overlapping matrix is constructed, so this method is a plain
+     * parallel copy of the matrix blocks. The native matrix thus must exhibit the same
+     * sparsity pattern as the one the overlapping matrix was constructed from; if it
+     * changes, a new overlapping matrix must be created.
+     */
     template <class NativeBCRSMatrix>
     void assignFromNative(const NativeBCRSMatrix& nativeMatrix)
     {
-        // first, set everything to 0,
-        BCRSMatrix::operator=(0.0);
+        assert(nativeRowOffsets_.size() == nativeMatrix.N() + 1);
+        assert(scatterBlocks_.size() == nativeMatrix.nonzeroes());
 
-        // then copy the domestic entries of the native matrix to the overlapping matrix
-        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
-            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
-            if (domesticRowIdx < 0) {
-                continue; // row corresponds to a black-listed entry
-            }
-
-            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
-            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
-            for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
-                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
-
-                // make sure to include all off-diagonal entries, even those which belong
-                // to DOFs which are managed by a peer process. For this, we have to
-                // re-map the column index of the black-listed index to a native one.
-                if (domesticColIdx < 0)
-                    domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
-
-                if (domesticColIdx < 0)
-                    // there is no domestic index which corresponds to a black-listed
-                    // one. this can happen if the grid overlap is larger than the
-                    // algebraic one...
+        // first, set the entries which are not covered by the native matrix to 0,
+        const std::size_t numZeroBlocks = zeroBlocks_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t blockIdx = 0; blockIdx < numZeroBlocks; ++blockIdx)
+            *zeroBlocks_[blockIdx] = 0.0;
+
+        // then copy the domestic entries of the native matrix to the overlapping
+        // matrix. since the native rows are mapped to distinct domestic rows, the rows
+        // can be processed concurrently.
+        const std::size_t numNativeRows = nativeMatrix.N();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx) {
+            std::size_t entryIdx = nativeRowOffsets_[nativeRowIdx];
+            const auto& nativeRow = nativeMatrix[nativeRowIdx];
+            const auto& nativeColEndIt = nativeRow.end();
+            for (auto nativeColIt = nativeRow.begin(); nativeColIt != nativeColEndIt; ++nativeColIt, ++entryIdx) {
+                block_type* dest = scatterBlocks_[entryIdx];
+                if (!dest)
                     continue;
 
                 // we need to copy the block matrices manually since it seems that (at
                 // least some versions of) Dune have an endless recursion bug when
                 // assigning dense matrices of different field type
                 const auto& src = *nativeColIt;
-                auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
                 for (unsigned i = 0; i < src.rows; ++i) {
                     for (unsigned j = 0; j < src.cols; ++j) {
-                        dest[i][j] = static_cast<field_type>(src[i][j]);
+                        (*dest)[i][j] = static_cast<field_type>(src[i][j]);
                     }
                 }
             }
@@ -333,6 +345,66 @@ private:
 
         // communicate the entries
         buildIndices_(nativeMatrix);
+
+        // determine where the entries of the native matrix end up
+        buildScatterMap_(nativeMatrix);
+    }
+
+    // determine the block of the overlapping matrix for each entry of the native
+    // matrix and the blocks which are not assigned any native entry
+    template <class NativeBCRSMatrix>
+    void buildScatterMap_(const NativeBCRSMatrix& nativeMatrix)
+    {
+        nativeRowOffsets_.assign(nativeMatrix.N() + 1, 0);
+        scatterBlocks_.assign(nativeMatrix.nonzeroes(), nullptr);
+
+        // mark the blocks of the overlapping matrix which receive a native entry
+        std::vector<std::vector<bool> > isCovered(this->N());
+        for (unsigned rowIdx = 0; rowIdx < this->N(); ++rowIdx)
+            isCovered[rowIdx].resize((*this)[rowIdx].size(), false);
+
+        std::size_t entryIdx = 0;
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            nativeRowOffsets_[nativeRowIdx] = entryIdx;
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+
+            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++entryIdx) {
+                if (domesticRowIdx < 0)
+                    continue; // row corresponds to a black-listed entry
+
+                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+                // make sure to include all off-diagonal entries, even those which belong
+                // to DOFs which are managed by a peer process. For this, we have to
+                // re-map the column index of the black-listed index to a native one.
+                if (domesticColIdx < 0)
+                    domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+                if (domesticColIdx < 0)
+                    // there is no domestic index which corresponds to a black-listed
+                    // one. this can happen if the grid overlap is larger than the
+                    // algebraic one...
+                    continue;
+
+                auto& row = (*this)[static_cast<unsigned>(domesticRowIdx)];
+                auto destIt = row.find(static_cast<unsigned>(domesticColIdx));
+                scatterBlocks_[entryIdx] = &(*destIt);
+                isCovered[static_cast<unsigned>(domesticRowIdx)][destIt.offset()] = true;
+            }
+        }
+        nativeRowOffsets_[nativeMatrix.N()] = entryIdx;
+
+        // collect the blocks which need to be zeroed explicitly
+        zeroBlocks_.clear();
+        for (unsigned rowIdx = 0; rowIdx < this->N(); ++rowIdx) {
+            auto& row = (*this)[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt)
+                if (!isCovered[rowIdx][colIt.offset()])
+                    zeroBlocks_.push_back(&(*colIt));
+        }
     }
 
     template <class NativeBCRSMatrix>
@@ -341,7 +413,8 @@ private:
         /////////
         // first, add all local matrix entries
         /////////
-        entries_.resize(overlap_->numDomestic());
+        entries_.clear();
+        entries_.reserve(nativeMatrix.nonzeroes());
         for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
             int domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
             if (domesticRowIdx < 0)
@@ -362,7 +435,7 @@ private:
                 if (domesticColIdx < 0)
                     continue;
 
-                entries_[static_cast<unsigned>(domesticRowIdx)].insert(domesticColIdx);
+                entries_.emplace_back(domesticRowIdx, domesticColIdx);
             }
         }
 
@@ -406,43 +479,29 @@ private:
         // actually initialize the BCRS matrix structure
         /////////
 
+        // sort the entries by row and column and remove the duplicates. this yields the
+        // sparsity pattern in compressed row format.
+        std::sort(entries_.begin(), entries_.end());
+        entries_.erase(std::unique(entries_.begin(), entries_.end()), entries_.end());
+
         // set the row sizes
         size_t numDomestic = overlap_->numDomestic();
-        for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx) {
-            unsigned numCols = 0;
-            const auto& colIndices = entries_[rowIdx];
-            auto colIdxIt = colIndices.begin();
-            const auto& colIdxEndIt = colIndices.end();
-            for (; colIdxIt != colIdxEndIt; ++colIdxIt) {
-                if (*colIdxIt < 0)
-                    // the matrix for the local process does not know about this DOF
-                    continue;
-
-                ++numCols;
-            }
-
-            this->setrowsize(rowIdx, numCols);
-        }
+        std::vector<unsigned> rowSizes(numDomestic, 0);
+        for (const auto& entry : entries_)
+            ++rowSizes[static_cast<unsigned>(entry.first)];
+        for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx)
+            this->setrowsize(rowIdx, rowSizes[rowIdx]);
         this->endrowsizes();
 
         // set the indices
-        for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx) {
-            const auto& colIndices = entries_[rowIdx];
-
-            auto colIdxIt = colIndices.begin();
-            const auto& colIdxEndIt = colIndices.end();
-            for (; colIdxIt != colIdxEndIt; ++colIdxIt) {
-                if (*colIdxIt < 0)
-                    // the matrix for the local process does not know about this DOF
-                    continue;
-
-                this->addindex(rowIdx, static_cast<unsigned>(*colIdxIt));
-            }
-        }
+        for (const auto& entry : entries_)
+            this->addindex(static_cast<unsigned>(entry.first),
+                           static_cast<unsigned>(entry.second));
         this->endindices();
 
         // free the memory occupied by the array of the matrix entries
         entries_.clear();
+        entries_.shrink_to_fit();
     }
 
     // send the overlap indices to a peer
@@ -462,18 +521,15 @@ private:
         rowIndicesSendBuff_[peerRank] = new MpiBuffer<Index>(numOverlapRows);
         rowSizesSendBuff_[peerRank] = new MpiBuffer<unsigned>(numOverlapRows);
 
-        // compute the sets of the indices of the entries which need to be send to the peer
-        using ColumnIndexSet = std::set<int>;
-        using EntryTuples = std::map<int, ColumnIndexSet>;
-
-        EntryTuples entryIndices;
-        unsigned numEntries = 0; // <- total number of matrix entries to be send to the peer
+        // compute the sorted global column indices of the entries which need to be send
+        // to the peer in compressed row format, i.e., the column indices of the row with
+        // a given overlap offset are stored at [rowOffsets[offset], rowOffsets[offset + 1])
+        std::vector<unsigned> rowOffsets(numOverlapRows + 1, 0);
+        std::vector<Index> colIndices;
         for (unsigned overlapOffset = 0; overlapOffset < numOverlapRows; ++overlapOffset) {
             Index domesticRowIdx = overlap_->foreignOverlapOffsetToDomesticIdx(peerRank, overlapOffset);
             Index nativeRowIdx = overlap_->domesticToNative(domesticRowIdx);
-            Index globalRowIdx = overlap_->domesticToGlobal(domesticRowIdx);
-
-            ColumnIndexSet& colIndices = entryIndices[globalRowIdx];
+            const auto rowBegin = colIndices.size();
 
             auto nativeColIt = nativeMatrix[static_cast<unsigned>(nativeRowIdx)].begin();
             const auto& nativeColEndIt = nativeMatrix[static_cast<unsigned>(nativeRowIdx)].end();
@@ -492,31 +548,27 @@ private:
                     // entry.
                     continue;
 
-                Index globalColIdx = overlap_->domesticToGlobal(domesticColIdx);
-                colIndices.insert(globalColIdx);
-                ++numEntries;
+                colIndices.push_back(overlap_->domesticToGlobal(domesticColIdx));
             }
-        };
+
+            // sort the column indices of the row and remove the duplicates
+            const auto rowBeginIt = colIndices.begin() + static_cast<std::ptrdiff_t>(rowBegin);
+            std::sort(rowBeginIt, colIndices.end());
+            colIndices.erase(std::unique(rowBeginIt, colIndices.end()), colIndices.end());
+            rowOffsets[overlapOffset + 1] = static_cast<unsigned>(colIndices.size());
+        }
 
         // fill the send buffers
+        const size_t numEntries = colIndices.size(); // <- total number of matrix entries to be send to the peer
         entryColIndicesSendBuff_[peerRank] = new MpiBuffer<Index>(numEntries);
-        Index overlapEntryIdx = 0;
         for (unsigned overlapOffset = 0; overlapOffset < numOverlapRows; ++overlapOffset) {
             Index domesticRowIdx = overlap_->foreignOverlapOffsetToDomesticIdx(peerRank, overlapOffset);
-            Index globalRowIdx = overlap_->domesticToGlobal(domesticRowIdx);
-
-            (*rowIndicesSendBuff_[peerRank])[overlapOffset] = globalRowIdx;
-
-            const ColumnIndexSet& colIndexSet = entryIndices[globalRowIdx];
-            auto* rssb = rowSizesSendBuff_[peerRank];
-            (*rssb)[overlapOffset] = static_cast<unsigned>(colIndexSet.size());
-            for (auto it = colIndexSet.begin(); it != colIndexSet.end(); ++it) {
-                int globalColIdx = *it;
-
-                (*entryColIndicesSendBuff_[peerRank])[static_cast<unsigned>(overlapEntryIdx)] = globalColIdx;
-                ++ overlapEntryIdx;
-            }
+            (*rowIndicesSendBuff_[peerRank])[overlapOffset] = overlap_->domesticToGlobal(domesticRowIdx);
+            (*rowSizesSendBuff_[peerRank])[overlapOffset] =
+                rowOffsets[overlapOffset + 1] - rowOffsets[overlapOffset];
         }
+        for (size_t entryIdx = 0; entryIdx < numEntries; ++entryIdx)
+            (*entryColIndicesSendBuff_[peerRank])[entryIdx] = colIndices[entryIdx];
 
         // actually communicate with the peer
         rowSizesSendBuff_[peerRank]->send(peerRank);
@@ -571,8 +623,13 @@ private:
             Index domRowIdx = (*rowIndicesRecvBuff_[peerRank])[i];
             for (unsigned j = 0; j < (*rowSizesRecvBuff_[peerRank])[i]; ++j) {
                 Index domColIdx = (*entryColIndicesRecvBuff_[peerRank])[k];
-                entries_[static_cast<unsigned>(domRowIdx)].insert(domColIdx);
                 ++k;
+
+                if (domColIdx < 0)
+                    // the matrix for the local process does not know about this DOF
+                    continue;
+
+                entries_.emplace_back(domRowIdx, domColIdx);
             }
         }
 #endif // HAVE_MPI
@@ -671,6 +728,14 @@ private:
 
     int myRank_;
     Entries entries_;
+
+    // the offsets of the rows of the native matrix within scatterBlocks_
+    std::vector<std::size_t> nativeRowOffsets_;
+    // the destination block of each entry of the native matrix (nullptr if the
+    // entry is not part of the overlapping matrix)
+    std::vector<block_type*> scatterBlocks_;
+    // the blocks of the overlapping matrix which are not covered by native entries
+    std::vector<block_type*> zeroBlocks_;
     std::shared_ptr<Overlap> overlap_;
 
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
@@ -173,14 +173,43 @@ public:
      *        master process.
      */
     void sync()
+    {
+        startSync();
+        finishSync();
+    }
+
+    /*!
+     * \brief Start syncronizing the values of the block vector from their master
+     *        process.
+     *
+     * This method sends the values of all rows which are in the foreign overlap of
+     * any peer and posts the receive operations for the values of the rows which are
+     * mastered by a peer. Only these rows may be modified until finishSync() has been
+     * called, so the remaining rows can be computed while the messages are in
+     * flight.
+     */
+    void startSync()
     {
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
             sendEntries_(peerRank);
 
-        // recieve all entries to the peers
+        // post the receive operations for the entries of all peers
         for (const auto peerRank: overlap_->peerSet())
-            receiveFromMaster_(peerRank);
+            valuesRecvBuff_[peerRank]->startReceive(peerRank);
+    }
+
+    /*!
+     * \brief Finish syncronizing the values of the block vector which was started by
+     *        startSync().
+     */
+    void finishSync()
+    {
+        // recieve all entries from the peers
+        for (const auto peerRank: overlap_->peerSet()) {
+            valuesRecvBuff_[peerRank]->wait();
+            copyFromMaster_(peerRank);
+        }
 
         // wait until we have send everything
         waitSendFinished_();
@@ -315,15 +344,12 @@ private:
         }
     }
 
-    void receiveFromMaster_(ProcessRank peerRank)
+    void copyFromMaster_(ProcessRank peerRank)
     {
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // copy them into the block vector
+        // copy the values received from the peer into the block vector
         for (unsigned j = 0; j < indices.size(); ++j) {
             Index domRowIdx = indices[j];
             if (overlap_->masterRank(domRowIdx) == peerRank) {
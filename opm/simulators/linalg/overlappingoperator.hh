@@ -30,11 +30,19 @@
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware linear operator usable by ISTL.
+ *
+ * The matrix-vector products are split into two phases: First, the rows which need
+ * to be send to peer processes ("border rows") are computed and their exchange is
+ * started. Then the remaining ("interior") rows are computed while the messages are
+ * in flight, and finally the values of the rows mastered by the peers are received.
  */
 template <class OverlappingMatrix, class DomainVector, class RangeVector>
 class OverlappingOperator
@@ -48,7 +56,7 @@ public:
     using field_type = typename domain_type::field_type;
 
     OverlappingOperator(const OverlappingMatrix& A) : A_(A)
-    {}
+    { partitionRows_(); }
 
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
     Dune::SolverCategory::Category category() const override
@@ -57,16 +65,43 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        const auto rowMv = [&](std::size_t rowIdx) {
+            auto& yRow = y[rowIdx];
+            yRow = 0.0;
+            const auto& row = A_[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt)
+                colIt->umv(x[colIt.index()], yRow);
+        };
+
+        for (const auto rowIdx : borderRows_)
+            rowMv(rowIdx);
+        y.startSync();
+
+        for (const auto rowIdx : interiorRows_)
+            rowMv(rowIdx);
+        y.finishSync();
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        const auto rowUsmv = [&](std::size_t rowIdx) {
+            auto& yRow = y[rowIdx];
+            const auto& row = A_[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt)
+                colIt->usmv(alpha, x[colIt.index()], yRow);
+        };
+
+        for (const auto rowIdx : borderRows_)
+            rowUsmv(rowIdx);
+        y.startSync();
+
+        for (const auto rowIdx : interiorRows_)
+            rowUsmv(rowIdx);
+        y.finishSync();
     }
 
     //! returns the matrix
@@ -77,7 +112,29 @@ public:
     { return A_.overlap(); }
 
 private:
+    // determine which rows need to be send to peers and which rows only matter
+    // for the local process
+    void partitionRows_()
+    {
+        const auto& overlap = A_.overlap();
+        std::vector<bool> isBorderRow(A_.N(), false);
+        for (const auto peerRank : overlap.peerSet()) {
+            const std::size_t numForeign = overlap.foreignOverlapSize(peerRank);
+            for (unsigned offset = 0; offset < numForeign; ++offset)
+                isBorderRow[static_cast<std::size_t>(overlap.foreignOverlapOffsetToDomesticIdx(peerRank, offset))] = true;
+        }
+
+        for (std::size_t rowIdx = 0; rowIdx < A_.N(); ++rowIdx) {
+            if (isBorderRow[rowIdx])
+                borderRows_.push_back(rowIdx);
+            else
+                interiorRows_.push_back(rowIdx);
+        }
+    }
+
     const OverlappingMatrix& A_;
+    std::vector<std::size_t> borderRows_;
+    std::vector<std::size_t> interiorRows_;
 };
 
 } // namespace Linear
@@ -28,13 +28,25 @@
 #define EWOMS_OVERLAPPING_SCALAR_PRODUCT_HH
 
 #include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/parallel/mpitraits.hh>
 #include <dune/istl/scalarproducts.hh>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware ISTL scalar product.
+ *
+ * Besides the usual dot() method, this scalar product can compute several scalar
+ * products with a single global reduction which, if MPI supports non-blocking
+ * collectives, proceeds in the background until finishDots() is called. This allows
+ * pipelined Krylov solvers to overlap the reduction with other work.
  */
 template <class OverlappingBlockVector, class Overlap>
 class OverlappingScalarProduct
@@ -55,6 +67,9 @@ public:
           comm_( Dune::MPIHelper::getCommunication() )
     {}
 
+    ~OverlappingScalarProduct() override
+    { finishDots(); }
+
     field_type dot(const OverlappingBlockVector& x,
                    const OverlappingBlockVector& y) const override
     {
@@ -72,9 +87,83 @@ public:
     real_type norm(const OverlappingBlockVector& x) const override
     { return std::sqrt(dot(x, x)); }
 
+    /*!
+     * \brief Start computing the scalar products (x[k], y[k]) of several pairs of
+     *        vectors using a single global reduction.
+     *
+     * The local contributions are computed in a single sweep over the vectors before
+     * this method returns. The global sum is written to the 'result' argument, which
+     * must stay alive and must not be accessed until finishDots() has been called.
+     * This also applies if an exception is thrown while the reduction is pending, so
+     * callers must call finishDots() before 'result' is destroyed during stack
+     * unwinding, e.g., from the destructor of a scope guard. Only one such reduction
+     * may be pending at any time.
+     */
+    template <std::size_t numDots>
+    void startDots(std::array<field_type, numDots>& result,
+                   const std::array<const OverlappingBlockVector*, numDots>& x,
+                   const std::array<const OverlappingBlockVector*, numDots>& y) const
+    {
+        finishDots();
+
+        std::fill(result.begin(), result.end(), field_type(0.0));
+        size_t numLocal = overlap_.numLocal();
+        for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
+            if (!overlap_.iAmMasterOf(static_cast<int>(localIdx)))
+                continue;
+
+            for (std::size_t k = 0; k < numDots; ++k)
+                result[k] += (*x[k])[localIdx] * (*y[k])[localIdx];
+        }
+
+        startSum_(result.data(), static_cast<int>(numDots));
+    }
+
+    /*!
+     * \brief Wait until the reduction started by the last call to startDots() has
+     *        completed.
+     *
+     * If no reduction is pending, this method does nothing.
+     */
+    void finishDots() const
+    {
+#if HAVE_MPI
+        if (reductionPending_) {
+            MPI_Wait(&reductionRequest_, MPI_STATUS_IGNORE);
+            reductionPending_ = false;
+        }
+#endif
+    }
+
 private:
+    void startSum_(field_type* values, int numValues) const
+    {
+#if HAVE_MPI
+        if constexpr (std::is_same_v<typename Dune::MPIHelper::MPICommunicator, MPI_Comm>) {
+            if (comm_.size() > 1) {
+                MPI_Iallreduce(MPI_IN_PLACE,
+                               values,
+                               numValues,
+                               Dune::MPITraits<field_type>::getType(),
+                               MPI_SUM,
+                               static_cast<MPI_Comm>(comm_),
+                               &reductionRequest_);
+                reductionPending_ = true;
+                return;
+            }
+        }
+#endif
+
+        comm_.sum(values, numValues);
+    }
+
     const Overlap& overlap_;
     const CollectiveCommunication comm_;
+
+#if HAVE_MPI
+    mutable MPI_Request reductionRequest_{MPI_REQUEST_NULL};
+    mutable bool reductionPending_{false};
+#endif
 };
 
 } // namespace Linear
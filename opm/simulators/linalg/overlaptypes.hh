@@ -29,10 +29,15 @@
 #ifndef EWOMS_OVERLAP_TYPES_HH
 #define EWOMS_OVERLAP_TYPES_HH
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <set>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace Opm {
@@ -53,6 +58,210 @@ using ProcessRank = unsigned;
  */
 using BorderDistance = unsigned;
 
+/*!
+ * \brief A map which stores its entries as an array of key-value pairs which is sorted
+ *        by the keys.
+ *
+ * Compared to std::map, this avoids a heap allocation per entry and the pointer
+ * chasing of lookups, which pays off for the small maps used by the overlap (e.g., the
+ * peer ranks which see a given index). Inserting an entry invalidates all iterators
+ * and references to the entries of the map.
+ */
+template <class Key, class Value>
+class FlatMap
+{
+    using Storage = std::vector<std::pair<Key, Value> >;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using iterator = typename Storage::iterator;
+    using const_iterator = typename Storage::const_iterator;
+
+    iterator begin()
+    { return entries_.begin(); }
+
+    const_iterator begin() const
+    { return entries_.begin(); }
+
+    iterator end()
+    { return entries_.end(); }
+
+    const_iterator end() const
+    { return entries_.end(); }
+
+    std::size_t size() const
+    { return entries_.size(); }
+
+    bool empty() const
+    { return entries_.empty(); }
+
+    void clear()
+    { entries_.clear(); }
+
+    iterator find(const Key& key)
+    {
+        auto it = lowerBound_(key);
+        return (it != entries_.end() && it->first == key) ? it : entries_.end();
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        auto it = lowerBound_(key);
+        return (it != entries_.end() && it->first == key) ? it : entries_.end();
+    }
+
+    std::size_t count(const Key& key) const
+    { return find(key) != end() ? 1 : 0; }
+
+    Value& operator[](const Key& key)
+    {
+        auto it = lowerBound_(key);
+        if (it == entries_.end() || it->first != key)
+            it = entries_.emplace(it, key, Value());
+        return it->second;
+    }
+
+    Value& at(const Key& key)
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not contained by the FlatMap");
+        return it->second;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not contained by the FlatMap");
+        return it->second;
+    }
+
+private:
+    iterator lowerBound_(const Key& key)
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), key,
+                                [](const value_type& entry, const Key& k)
+                                { return entry.first < k; });
+    }
+
+    const_iterator lowerBound_(const Key& key) const
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), key,
+                                [](const value_type& entry, const Key& k)
+                                { return entry.first < k; });
+    }
+
+    Storage entries_;
+};
+
+/*!
+ * \brief Maps non-negative indices to indices using a hash table with open addressing.
+ *
+ * All entries are stored in a single array, so a lookup usually touches only a single
+ * cache line. This is used instead of std::map for the translation tables between
+ * index spaces which may contain an entry for each degree of freedom.
+ */
+class IndexHashMap
+{
+    struct Entry
+    {
+        Index key;
+        Index value;
+    };
+
+public:
+    IndexHashMap()
+        : size_(0)
+    {}
+
+    /*!
+     * \brief Returns the number of entries of the map.
+     */
+    std::size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Make sure that a given number of entries can be inserted without
+     *        rehashing.
+     */
+    void reserve(std::size_t numEntries)
+    {
+        std::size_t capacity = 16;
+        while (capacity < 2*numEntries)
+            capacity *= 2;
+        if (capacity > slots_.size())
+            rehash_(capacity);
+    }
+
+    /*!
+     * \brief Set the value for a key. If the key is already contained by the map, its
+     *        value is overwritten.
+     *
+     * Negative keys mark the empty slots of the table, so they cannot be stored.
+     */
+    void set(Index key, Index value)
+    {
+        assert(key >= 0);
+
+        if (2*(size_ + 1) > slots_.size())
+            rehash_(std::max<std::size_t>(16, 2*slots_.size()));
+
+        Entry& entry = slots_[findSlot_(key)];
+        if (entry.key < 0) {
+            entry.key = key;
+            ++size_;
+        }
+        entry.value = value;
+    }
+
+    /*!
+     * \brief Returns the value for a key or -1 if the key is not contained by the map.
+     */
+    Index get(Index key) const
+    {
+        if (slots_.empty())
+            return -1;
+
+        const Entry& entry = slots_[findSlot_(key)];
+        return entry.key < 0 ? -1 : entry.value;
+    }
+
+    /*!
+     * \brief Returns true iff a key is contained by the map.
+     */
+    bool contains(Index key) const
+    { return !slots_.empty() && slots_[findSlot_(key)].key >= 0; }
+
+private:
+    // returns the slot which contains the key or the empty slot where it would be
+    // inserted. the load factor of the table is at most 1/2, so there is always an
+    // empty slot.
+    std::size_t findSlot_(Index key) const
+    {
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t slotIdx = (static_cast<std::uint32_t>(key)*2654435761u) & mask;
+        while (slots_[slotIdx].key >= 0 && slots_[slotIdx].key != key)
+            slotIdx = (slotIdx + 1) & mask;
+        return slotIdx;
+    }
+
+    void rehash_(std::size_t capacity)
+    {
+        std::vector<Entry> oldSlots(capacity, Entry{-1, -1});
+        oldSlots.swap(slots_);
+        for (const auto& entry : oldSlots) {
+            if (entry.key >= 0)
+                slots_[findSlot_(entry.key)] = entry;
+        }
+    }
+
+    std::vector<Entry> slots_;
+    std::size_t size_;
+};
+
 /*!
  * \brief This structure stores an index and a process rank
  */
@@ -168,12 +377,12 @@ using OverlapWithPeer = std::vector<IndexDistanceNpeers>;
  * \brief A type mapping the process rank to the list of indices
  *        shared with this peer.
  */
-using OverlapByRank = std::map<ProcessRank, OverlapWithPeer>;
+using OverlapByRank = FlatMap<ProcessRank, OverlapWithPeer>;
 
 /*!
  * \brief Maps each index to a list of processes .
  */
-using OverlapByIndex = std::vector<std::map<ProcessRank, BorderDistance> >;
+using OverlapByIndex = std::vector<FlatMap<ProcessRank, BorderDistance> >;
 
 /*!
  * \brief The list of domestic indices are owned by peer rank.
@@ -184,7 +393,7 @@ using DomesticOverlapWithPeer = std::vector<Index>;
  * \brief A type mapping the process rank to the list of domestic indices
  *        which are owned by the peer.
  */
-using DomesticOverlapByRank = std::map<ProcessRank, DomesticOverlapWithPeer>;
+using DomesticOverlapByRank = FlatMap<ProcessRank, DomesticOverlapWithPeer>;
 
 } // namespace Linear
 } // namespace Opm
@@ -32,6 +32,7 @@
 #include "bicgstabsolver.hh"
 #include "combinedcriterion.hh"
 #include "istlsparsematrixadapter.hh"
+#include "mixedprecisionpreconditioner.hh"
 
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/istl/paamg/amg.hh>
@@ -40,6 +41,7 @@
 
 #include <memory>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace Opm::Linear {
@@ -66,6 +68,10 @@ struct LinearSolverMaxError<TypeTag, TTag::ParallelAmgLinearSolver>
     static constexpr type value = 1e7;
 };
 
+template<class TypeTag>
+struct LinearSolverPipelined<TypeTag, TTag::ParallelAmgLinearSolver>
+{ static constexpr bool value = false; };
+
 template<class TypeTag>
 struct LinearSolverBackend<TypeTag, TTag::ParallelAmgLinearSolver>
 { using type = Opm::Linear::ParallelAmgBackend<TypeTag>; };
@@ -87,6 +93,7 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
 
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using LinearSolverScalar = GetPropType<TypeTag, Properties::LinearSolverScalar>;
+    using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Overlap = GetPropType<TypeTag, Properties::Overlap>;
@@ -98,9 +105,11 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
     using ParallelScalarProduct = typename ParentType::ParallelScalarProduct;
 
     static constexpr int numEq = getPropValue<TypeTag, Properties::NumEq>();
-    using VectorBlock = Dune::FieldVector<LinearSolverScalar, numEq>;
     using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
-    using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
+
+    // the AMG hierarchy is built using the floating point type of the preconditioner
+    using VectorBlock = Dune::FieldVector<PreconditionerScalar, numEq>;
+    using IstlMatrix = Dune::BCRSMatrix<Opm::MatrixBlock<PreconditionerScalar, numEq, numEq>>;
 
     using Vector = Dune::BlockVector<VectorBlock>;
 
@@ -134,9 +143,17 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
     using AMG = Dune::Amg::AMG<FineOperator, Vector, ParallelSmoother>;
 #endif
 
+    // if the AMG uses a different floating point type than the linear solver, the
+    // vectors need to be converted
+    using AmgPreconditioner =
+        std::conditional_t<ParentType::mixedPrecision,
+                           MixedPrecisionPreconditioner<AMG, OverlappingVector>,
+                           AMG>;
+
     using RawLinearSolver = BiCGStabSolver<ParallelOperator,
                                            OverlappingVector,
-                                           AMG> ;
+                                           AmgPreconditioner,
+                                           ParallelScalarProduct>;
 
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelAmgBackend linear solver backend requires the IstlSparseMatrixAdapter");
@@ -146,6 +163,12 @@ public:
         : ParentType(simulator)
     { }
 
+    ~ParallelAmgBackend()
+    {
+        // a reused AMG hierarchy must be destroyed before the objects it refers to
+        this->releasePreconditioner_();
+    }
+
     static void registerParameters()
     {
         ParentType::registerParameters();
@@ -153,6 +176,9 @@ public:
         Parameters::registerParam<TypeTag, Properties::LinearSolverMaxError>
             ("The maximum residual error which the linear solver tolerates "
              "without giving up");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverPipelined>
+            ("Use the pipelined variant of the BiCGStab solver which hides the "
+             "latency of the global reductions");
         Parameters::registerParam<TypeTag, Properties::AmgCoarsenTarget>
             ("The coarsening target for the agglomerations of "
              "the AMG preconditioner");
@@ -161,7 +187,7 @@ public:
 protected:
     friend ParentType;
 
-    std::shared_ptr<AMG> preparePreconditioner_()
+    std::shared_ptr<AmgPreconditioner> preparePreconditioner_()
     {
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
@@ -173,14 +199,28 @@ protected:
 
         // create the parallel scalar product and the parallel operator
 #if HAVE_MPI
-        fineOperator_ = std::make_shared<FineOperator>(*this->overlappingMatrix_, *istlComm_);
+        fineOperator_ = std::make_shared<FineOperator>(this->preconditionerMatrix_(), *istlComm_);
 #else
-        fineOperator_ = std::make_shared<FineOperator>(*this->overlappingMatrix_);
+        fineOperator_ = std::make_shared<FineOperator>(this->preconditionerMatrix_());
 #endif
 
         setupAmg_();
 
-        return amg_;
+        if constexpr (ParentType::mixedPrecision)
+            return std::make_shared<AmgPreconditioner>(*amg_);
+        else
+            return amg_;
+    }
+
+    // keep the AMG hierarchy, i.e., the aggregates and the sparsity patterns of the
+    // coarse level matrices, and only recompute the values of the coarse matrices.
+    bool updatePreconditioner_()
+    {
+        if (!amg_)
+            return false;
+
+        amg_->recalculateHierarchy();
+        return true;
     }
 
     void cleanupPreconditioner_()
@@ -188,7 +228,7 @@ protected:
 
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
-                                                    AMG& parPreCond)
+                                                    AmgPreconditioner& parPreCond)
     {
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
@@ -211,6 +251,7 @@ protected:
             verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
         bicgstabSolver->setVerbosity(verbosity);
         bicgstabSolver->setMaxIterations(Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>());
+        bicgstabSolver->setPipelined(Parameters::get<TypeTag, Properties::LinearSolverPipelined>());
         bicgstabSolver->setLinearOperator(&parOperator);
         bicgstabSolver->setRhs(this->overlappingb_);
 
@@ -30,6 +30,7 @@
 #include <opm/common/Exceptions.hpp>
 
 #include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/simulators/linalg/mixedprecisionpreconditioner.hh>
 #include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
 #include <opm/simulators/linalg/overlappingblockvector.hh>
 #include <opm/simulators/linalg/overlappingpreconditioner.hh>
@@ -39,6 +40,7 @@
 #include <opm/simulators/linalg/istlpreconditionerwrappers.hh>
 
 #include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/instrumentation.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
@@ -49,9 +51,12 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 #include <memory>
 #include <iostream>
+#include <type_traits>
 
 namespace Opm::Properties {
 
@@ -103,6 +108,12 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ *
+ * If the PreconditionerScalar property differs from the LinearSolverScalar, the
+ * preconditioner is set up on a copy of the overlapping matrix which uses the
+ * PreconditionerScalar (e.g., float), while the Krylov iteration and the residual are
+ * still computed using the LinearSolverScalar. This roughly halves the memory traffic
+ * caused by applying the preconditioner.
  */
 template <class TypeTag>
 class ParallelBaseBackend
@@ -122,8 +133,16 @@ protected:
     using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
     using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
 
+    using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>;
+    using PreconditionerMatrix = GetPropType<TypeTag, Properties::PreconditionerMatrix>;
+    static constexpr bool mixedPrecision = !std::is_same<PreconditionerScalar, LinearSolverScalar>::value;
+
     using PreconditionerWrapper = GetPropType<TypeTag, Properties::PreconditionerWrapper>;
-    using SequentialPreconditioner = typename PreconditionerWrapper::SequentialPreconditioner;
+    using WrappedPreconditioner = typename PreconditionerWrapper::SequentialPreconditioner;
+    using SequentialPreconditioner =
+        std::conditional_t<mixedPrecision,
+                           MixedPrecisionPreconditioner<WrappedPreconditioner, OverlappingVector>,
+                           WrappedPreconditioner>;
 
     using ParallelPreconditioner = Opm::Linear::OverlappingPreconditioner<SequentialPreconditioner, Overlap>;
     using ParallelScalarProduct = Opm::Linear::OverlappingScalarProduct<OverlappingVector, Overlap>;
@@ -137,7 +156,12 @@ public:
     ParallelBaseBackend(const Simulator& simulator)
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
+        , sparsityVersion_( 0 )
         , lastIterations_( -1 )
+        , lastSolveConverged_(false)
+        , preconditionerAge_(0)
+        , referenceIterations_(-1)
+        , precWrapperPrepared_(false)
     {
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
@@ -145,7 +169,15 @@ public:
     }
 
     ~ParallelBaseBackend()
-    { cleanup_(); }
+    {
+        // the derived class is already destroyed at this point, so only the
+        // preconditioner wrapper of this class can be cleaned up
+        preconditioner_.reset();
+        mixedPrecisionPreCond_.reset();
+        if (precWrapperPrepared_)
+            precWrapper_.cleanup();
+        cleanup_();
+    }
 
     /*!
      * \brief Register all run-time parameters for the linear solver.
@@ -162,6 +194,13 @@ public:
             ("The maximum number of iterations of the linear solver");
         Parameters::registerParam<TypeTag, Properties::LinearSolverVerbosity>
             ("The verbosity level of the linear solver");
+        Parameters::registerParam<TypeTag, Properties::PreconditionerReuseCount>
+            ("The number of subsequent linear solves for which the preconditioner is "
+             "reused before its numerical values are updated. 0 means that it is set "
+             "up from scratch for every linear solve");
+        Parameters::registerParam<TypeTag, Properties::PreconditionerReuseMaxIterationGrowth>
+            ("The factor by which the number of linear iterations may grow before a "
+             "reused preconditioner is set up from scratch");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -171,7 +210,10 @@ public:
      *        equations the next time it is called.
      */
     void eraseMatrix()
-    { cleanup_(); }
+    {
+        releasePreconditioner_();
+        cleanup_();
+    }
 
     /*!
      * \brief Set up the internal data structures required for the linear solver.
@@ -181,15 +223,24 @@ public:
      */
     void prepare(const SparseMatrixAdapter& M, const Vector& )
     {
-        // if grid has changed the sequence number has changed too
+        // if grid has changed the sequence number has changed too. the structure of
+        // the overlapping matrix and the destination of each native entry also depend
+        // on the sparsity pattern of the native matrix, which may change without
+        // modifying the grid, e.g. if the auxiliary equations change.
         int curSeqNum = simulator_.vanguard().gridSequenceNumber();
-        if (gridSequenceNumber_ == curSeqNum && overlappingMatrix_)
-            // the grid has not changed since the overlappingMatrix_has been created, so
-            // there's noting to do
+        const std::uint64_t curSparsityVersion = M.sparsityVersion();
+        if (gridSequenceNumber_ == curSeqNum
+            && sparsityVersion_ == curSparsityVersion
+            && overlappingMatrix_)
+            // neither the grid nor the sparsity pattern have changed since the
+            // overlappingMatrix_ has been created, so there's noting to do
             return;
 
+        // the preconditioner refers to the overlapping matrix
+        releasePreconditioner_();
         asImp_().cleanup_();
         gridSequenceNumber_ = curSeqNum;
+        sparsityVersion_ = curSparsityVersion;
 
         BorderListCreator borderListCreator(simulator_.gridView(),
                                             simulator_.model().dofMapper());
@@ -206,6 +257,16 @@ public:
         overlappingb_ = new OverlappingVector(overlappingMatrix_->overlap());
         overlappingx_ = new OverlappingVector(*overlappingb_);
 
+        // create the lower precision copy of the overlapping matrix used by the
+        // preconditioner
+        if constexpr (mixedPrecision)
+            createPreconditionerMatrix_();
+
+        // the parallel scalar product and the parallel operator only depend on the
+        // structure of the overlapping matrix
+        parScalarProduct_ = std::make_unique<ParallelScalarProduct>(overlappingMatrix_->overlap());
+        parOperator_ = std::make_unique<ParallelOperator>(*overlappingMatrix_);
+
         // writeOverlapToVTK_();
     }
 
@@ -242,6 +303,9 @@ public:
     {
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
+
+        if constexpr (mixedPrecision)
+            updatePreconditionerMatrix_();
     }
 
     /*!
@@ -253,28 +317,68 @@ public:
     {
         (*overlappingx_) = 0.0;
 
-        auto parPreCond = asImp_().preparePreconditioner_();
+        const auto& newtonMethod = simulator_.model().newtonMethod();
+        auto& instrumentation = newtonMethod.instrumentation();
+        Instrumentation::ScopedRegion setupRegion(instrumentation,
+                                                  newtonMethod.instrumentationRegions().preconditionerSetup);
+
+        // the type of the preconditioner depends on the implementation
+        using PreconditionerPtr = decltype(asImp_().preparePreconditioner_());
+        using Preconditioner = typename PreconditionerPtr::element_type;
+
+        // if something goes wrong, the preconditioner is released
         auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
+                                { this->releasePreconditioner_(); };
         auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
-        // create the parallel scalar product and the parallel operator
-        ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
-        ParallelOperator parOperator(*overlappingMatrix_);
+
+        switch (preconditionerSetupAction_()) {
+        case PreconditionerSetupAction::Reuse:
+            break;
+
+        case PreconditionerSetupAction::Update:
+            if (asImp_().updatePreconditioner_()) {
+                preconditionerAge_ = 0;
+                referenceIterations_ = -1;
+                break;
+            }
+            // the preconditioner cannot be updated, so set it up from scratch
+            [[fallthrough]];
+
+        case PreconditionerSetupAction::Rebuild:
+            releasePreconditioner_();
+            preconditioner_ = asImp_().preparePreconditioner_();
+            preconditionerAge_ = 0;
+            referenceIterations_ = -1;
+            break;
+        }
+        ++preconditionerAge_;
+        auto& parPreCond = *std::static_pointer_cast<Preconditioner>(preconditioner_);
 
         // retrieve the linear solver
-        auto solver = asImp_().prepareSolver_(parOperator,
-                                              parScalarProduct,
-                                              *parPreCond);
+        auto solver = asImp_().prepareSolver_(*parOperator_,
+                                              *parScalarProduct_,
+                                              parPreCond);
 
         auto cleanupSolverFn =
             [this]() -> void
             { this->asImp_().cleanupSolver_(); };
         GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
+        setupRegion.stop();
 
         // run the linear solver and have some fun
+        Instrumentation::ScopedRegion iterationsRegion(instrumentation,
+                                                       newtonMethod.instrumentationRegions().solverIterations);
         auto result = asImp_().runSolver_(solver);
+        iterationsRegion.stop();
         // store number of iterations used
         lastIterations_ = result.second;
+        lastSolveConverged_ = result.first;
+        if (referenceIterations_ < 0)
+            referenceIterations_ = result.second;
+
+        // keep the preconditioner for the next solve if it may be reused
+        if (Parameters::get<TypeTag, Properties::PreconditionerReuseCount>() > 0)
+            precondCleanupGuard.setEnabled(false);
 
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
@@ -306,6 +410,96 @@ protected:
         overlappingMatrix_ = 0;
         overlappingb_ = 0;
         overlappingx_ = 0;
+
+        parScalarProduct_.reset();
+        parOperator_.reset();
+        preconditionerMatrix_.reset();
+    }
+
+    // returns the matrix on which the preconditioner is set up. Without mixed precision,
+    // this is the overlapping matrix itself.
+    PreconditionerMatrix& preconditionerMatrix_()
+    {
+        if constexpr (mixedPrecision)
+            return *preconditionerMatrix_;
+        else
+            return *overlappingMatrix_;
+    }
+
+    // create a lower precision matrix which exhibits the same sparsity pattern as the
+    // overlapping matrix
+    void createPreconditionerMatrix_()
+    {
+        const auto& srcMatrix = overlappingMatrix_->asParent();
+        preconditionerMatrix_ =
+            std::make_unique<PreconditionerMatrix>(srcMatrix.N(),
+                                                   srcMatrix.M(),
+                                                   srcMatrix.nonzeroes(),
+                                                   PreconditionerMatrix::row_wise);
+
+        auto srcRowIt = srcMatrix.begin();
+        auto rowIt = preconditionerMatrix_->createbegin();
+        const auto& rowEndIt = preconditionerMatrix_->createend();
+        for (; rowIt != rowEndIt; ++rowIt, ++srcRowIt) {
+            for (auto colIt = srcRowIt->begin(); colIt != srcRowIt->end(); ++colIt)
+                rowIt.insert(colIt.index());
+        }
+    }
+
+    // copy the values of the overlapping matrix to the lower precision matrix
+    void updatePreconditionerMatrix_()
+    {
+        const auto& srcMatrix = overlappingMatrix_->asParent();
+        auto& destMatrix = *preconditionerMatrix_;
+        const std::size_t numRows = srcMatrix.N();
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            auto destColIt = destMatrix[rowIdx].begin();
+            const auto& srcRow = srcMatrix[rowIdx];
+            for (auto srcColIt = srcRow.begin(); srcColIt != srcRow.end(); ++srcColIt, ++destColIt) {
+                const auto& src = *srcColIt;
+                auto& dest = *destColIt;
+                for (unsigned i = 0; i < src.rows; ++i)
+                    for (unsigned j = 0; j < src.cols; ++j)
+                        dest[i][j] = static_cast<PreconditionerScalar>(src[i][j]);
+            }
+        }
+    }
+
+    enum class PreconditionerSetupAction { Reuse, Update, Rebuild };
+
+    // decide how the preconditioner is to be set up for the next linear solve. Since
+    // the decision only depends on collectively computed quantities, it is the same on
+    // all processes.
+    PreconditionerSetupAction preconditionerSetupAction_() const
+    {
+        const int reuseCount = Parameters::get<TypeTag, Properties::PreconditionerReuseCount>();
+        if (!preconditioner_ || reuseCount <= 0 || !lastSolveConverged_)
+            return PreconditionerSetupAction::Rebuild;
+
+        const Scalar maxGrowth =
+            Parameters::get<TypeTag, Properties::PreconditionerReuseMaxIterationGrowth>();
+        if (referenceIterations_ >= 0 &&
+            static_cast<Scalar>(lastIterations_) > maxGrowth*std::max(referenceIterations_, 1))
+            return PreconditionerSetupAction::Rebuild;
+
+        if (preconditionerAge_ > reuseCount)
+            return PreconditionerSetupAction::Update;
+
+        return PreconditionerSetupAction::Reuse;
+    }
+
+    // release the preconditioner object which is kept by this class
+    void releasePreconditioner_()
+    {
+        if (!preconditioner_)
+            return;
+
+        preconditioner_.reset();
+        asImp_().cleanupPreconditioner_();
     }
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
@@ -313,7 +507,8 @@ protected:
         int preconditionerIsReady = 1;
         try {
             // update sequential preconditioner
-            precWrapper_.prepare(*overlappingMatrix_);
+            precWrapper_.prepare(preconditionerMatrix_());
+            precWrapperPrepared_ = true;
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -329,12 +524,31 @@ protected:
             throw NumericalProblem("Creating the preconditioner failed");
 
         // create the parallel preconditioner
-        return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        if constexpr (mixedPrecision) {
+            mixedPrecisionPreCond_ = std::make_unique<SequentialPreconditioner>(precWrapper_.get());
+            return std::make_shared<ParallelPreconditioner>(*mixedPrecisionPreCond_,
+                                                            overlappingMatrix_->overlap());
+        }
+        else
+            return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
     }
 
+    /*!
+     * \brief Update the numerical values of the preconditioner for the current matrix
+     *        while keeping its structure.
+     *
+     * Returns false if this is not supported, in which case the preconditioner is set up
+     * from scratch.
+     */
+    bool updatePreconditioner_()
+    { return false; }
+
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        mixedPrecisionPreCond_.reset();
+        if (precWrapperPrepared_)
+            precWrapper_.cleanup();
+        precWrapperPrepared_ = false;
     }
 
     void writeOverlapToVTK_()
@@ -376,13 +590,33 @@ protected:
 
     const Simulator& simulator_;
     int gridSequenceNumber_;
+    std::uint64_t sparsityVersion_;
     size_t lastIterations_;
+    bool lastSolveConverged_;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
+    std::unique_ptr<ParallelScalarProduct> parScalarProduct_;
+    std::unique_ptr<ParallelOperator> parOperator_;
+
+    // the lower precision copy of the overlapping matrix (only used for mixed precision)
+    std::unique_ptr<PreconditionerMatrix> preconditionerMatrix_;
+
+    // the preconditioner used by the last linear solve. Its type depends on the
+    // implementation. It is kept if the preconditioner may be reused.
+    std::shared_ptr<void> preconditioner_;
+    // the number of linear solves since the preconditioner was set up or updated
+    int preconditionerAge_;
+    // the number of iterations of the first solve after the preconditioner was set up
+    // or updated
+    int referenceIterations_;
+
     PreconditionerWrapper precWrapper_;
+    bool precWrapperPrepared_;
+    // converts between the precisions of the linear solver and of the preconditioner
+    std::unique_ptr<SequentialPreconditioner> mixedPrecisionPreCond_;
 };
 }} // namespace Linear, Opm
 
@@ -392,6 +626,19 @@ namespace Opm::Properties {
 template<class TypeTag>
 struct LinearSolverVerbosity<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
 
+//! set up the preconditioner from scratch for each linear solve by default
+template<class TypeTag>
+struct PreconditionerReuseCount<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
+
+//! set up a reused preconditioner from scratch if the number of linear iterations
+//! grows by more than 50%
+template<class TypeTag>
+struct PreconditionerReuseMaxIterationGrowth<TypeTag, TTag::ParallelBaseLinearSolver>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1.5;
+};
+
 //! set the preconditioner relaxation parameter to 1.0 by default
 template<class TypeTag>
 struct PreconditionerRelaxation<TypeTag, TTag::ParallelBaseLinearSolver>
@@ -410,6 +657,11 @@ template<class TypeTag>
 struct LinearSolverScalar<TypeTag, TTag::ParallelBaseLinearSolver>
 { using type = GetPropType<TypeTag, Properties::Scalar>; };
 
+//! by default, the preconditioner uses the same floating point type as the linear solver
+template<class TypeTag>
+struct PreconditionerScalar<TypeTag, TTag::ParallelBaseLinearSolver>
+{ using type = GetPropType<TypeTag, Properties::LinearSolverScalar>; };
+
 template<class TypeTag>
 struct OverlappingMatrix<TypeTag, TTag::ParallelBaseLinearSolver>
 {
@@ -437,6 +689,38 @@ struct OverlappingVector<TypeTag, TTag::ParallelBaseLinearSolver>
     using type = Opm::Linear::OverlappingBlockVector<VectorBlock, Overlap>;
 };
 
+//! if the preconditioner uses the floating point type of the linear solver, it is set up
+//! directly on the overlapping matrix. Else, a plain BCRS matrix is used.
+template<class TypeTag>
+struct PreconditionerMatrix<TypeTag, TTag::ParallelBaseLinearSolver>
+{
+private:
+    static constexpr int numEq = getPropValue<TypeTag, Properties::NumEq>();
+    using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>;
+    using LinearSolverScalar = GetPropType<TypeTag, Properties::LinearSolverScalar>;
+    using MatrixBlock = Opm::MatrixBlock<PreconditionerScalar, numEq, numEq>;
+
+public:
+    using type = std::conditional_t<std::is_same<PreconditionerScalar, LinearSolverScalar>::value,
+                                    GetPropType<TypeTag, Properties::OverlappingMatrix>,
+                                    Dune::BCRSMatrix<MatrixBlock>>;
+};
+
+template<class TypeTag>
+struct PreconditionerVector<TypeTag, TTag::ParallelBaseLinearSolver>
+{
+private:
+    static constexpr int numEq = getPropValue<TypeTag, Properties::NumEq>();
+    using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>;
+    using LinearSolverScalar = GetPropType<TypeTag, Properties::LinearSolverScalar>;
+    using VectorBlock = Dune::FieldVector<PreconditionerScalar, numEq>;
+
+public:
+    using type = std::conditional_t<std::is_same<PreconditionerScalar, LinearSolverScalar>::value,
+                                    GetPropType<TypeTag, Properties::OverlappingVector>,
+                                    Dune::BlockVector<VectorBlock>>;
+};
+
 template<class TypeTag>
 struct OverlappingScalarProduct<TypeTag, TTag::ParallelBaseLinearSolver>
 {
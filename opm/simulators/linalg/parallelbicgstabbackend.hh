@@ -58,6 +58,10 @@ struct LinearSolverMaxError<TypeTag, TTag::ParallelBiCGStabLinearSolver>
     static constexpr type value = 1e7;
 };
 
+template<class TypeTag>
+struct LinearSolverPipelined<TypeTag, TTag::ParallelBiCGStabLinearSolver>
+{ static constexpr bool value = false; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -107,7 +111,8 @@ class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
 
     using RawLinearSolver = BiCGStabSolver<ParallelOperator,
                                            OverlappingVector,
-                                           ParallelPreconditioner>;
+                                           ParallelPreconditioner,
+                                           ParallelScalarProduct>;
 
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelIstlSolverBackend linear solver backend requires the IstlSparseMatrixAdapter");
@@ -124,6 +129,9 @@ public:
         Parameters::registerParam<TypeTag, Properties::LinearSolverMaxError>
             ("The maximum residual error which the linear solver tolerates"
              " without giving up");
+        Parameters::registerParam<TypeTag, Properties::LinearSolverPipelined>
+            ("Use the pipelined variant of the BiCGStab solver which hides the "
+             "latency of the global reductions");
     }
 
 protected:
@@ -154,6 +162,7 @@ protected:
             verbosity = Parameters::get<TypeTag, Properties::LinearSolverVerbosity>();
         bicgstabSolver->setVerbosity(verbosity);
         bicgstabSolver->setMaxIterations(Parameters::get<TypeTag, Properties::LinearSolverMaxIterations>());
+        bicgstabSolver->setPipelined(Parameters::get<TypeTag, Properties::LinearSolverPipelined>());
         bicgstabSolver->setLinearOperator(&parOperator);
         bicgstabSolver->setRhs(this->overlappingb_);
 
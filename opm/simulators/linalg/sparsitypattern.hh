@@ -0,0 +1,241 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::SparsityPattern
+ */
+#ifndef EWOMS_SPARSITY_PATTERN_HH
+#define EWOMS_SPARSITY_PATTERN_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ * \brief Builds the sparsity pattern of a matrix in compressed row storage (CSR)
+ *        format.
+ *
+ * The pattern is constructed in two passes: First, the number of entries which are
+ * going to be added to each row is announced using countEntries(). After calling
+ * allocate(), the entries are added using addEntry(). Both passes can be run
+ * concurrently by multiple OpenMP threads, and a row may contain duplicate entries.
+ * Entries which were not counted in advance can be added by appendEntry(), but this
+ * method must not be called concurrently. Finally, finalize() sorts the rows and
+ * removes the duplicates.
+ */
+class SparsityPattern
+{
+public:
+    using Index = unsigned;
+
+    SparsityPattern()
+    { reset(0); }
+
+    explicit SparsityPattern(std::size_t numRows)
+    { reset(numRows); }
+
+    /*!
+     * \brief Discard the pattern and start a new one for a given number of rows.
+     */
+    void reset(std::size_t numRows)
+    {
+        rowOffsets_.assign(numRows + 1, 0);
+        fillPos_.clear();
+        colIndices_.clear();
+        extraEntries_.clear();
+    }
+
+    /*!
+     * \brief Returns the number of rows of the pattern.
+     */
+    std::size_t numRows() const
+    { return rowOffsets_.size() - 1; }
+
+    /*!
+     * \brief Announce that a given number of entries will be added to a row.
+     *
+     * This method may be called concurrently.
+     */
+    void countEntries(std::size_t rowIdx, Index numEntries = 1)
+    {
+        assert(rowIdx < numRows());
+        auto& count = rowOffsets_[rowIdx + 1];
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        count += numEntries;
+    }
+
+    /*!
+     * \brief Allocate the memory for all entries which have been counted.
+     */
+    void allocate()
+    {
+        for (std::size_t rowIdx = 0; rowIdx < numRows(); ++rowIdx)
+            rowOffsets_[rowIdx + 1] += rowOffsets_[rowIdx];
+
+        colIndices_.resize(rowOffsets_.back());
+        fillPos_.assign(rowOffsets_.begin(), rowOffsets_.end() - 1);
+    }
+
+    /*!
+     * \brief Add an entry to a row whose size has been counted.
+     *
+     * This method may be called concurrently.
+     */
+    void addEntry(std::size_t rowIdx, Index colIdx)
+    {
+        assert(rowIdx < numRows());
+        std::size_t pos;
+        auto& nextPos = fillPos_[rowIdx];
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+        pos = nextPos++;
+        assert(pos < rowOffsets_[rowIdx + 1]);
+        colIndices_[pos] = colIdx;
+    }
+
+    /*!
+     * \brief Add an entry which has not been counted in advance.
+     *
+     * This method must not be called concurrently.
+     */
+    void appendEntry(std::size_t rowIdx, Index colIdx)
+    {
+        assert(rowIdx < numRows());
+        extraEntries_.emplace_back(static_cast<Index>(rowIdx), colIdx);
+    }
+
+    /*!
+     * \brief Sort the entries of each row and remove the duplicates.
+     */
+    void finalize()
+    {
+        const std::size_t n = numRows();
+
+        // the entries which have not been counted are merged with the counted ones
+        std::sort(extraEntries_.begin(), extraEntries_.end());
+        extraEntries_.erase(std::unique(extraEntries_.begin(), extraEntries_.end()),
+                            extraEntries_.end());
+        std::vector<std::size_t> extraOffsets(n + 1, 0);
+        for (const auto& entry : extraEntries_)
+            ++extraOffsets[entry.first + 1];
+        for (std::size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            extraOffsets[rowIdx + 1] += extraOffsets[rowIdx];
+
+        // assemble each row including the additional entries and determine the number
+        // of unique entries per row
+        std::vector<Index> tmpIndices(colIndices_.size() + extraEntries_.size());
+        std::vector<std::size_t> rowSizes(n);
+        const long numRowsSigned = static_cast<long>(n);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < numRowsSigned; ++i) {
+            const auto rowIdx = static_cast<std::size_t>(i);
+            const std::size_t tmpBegin = rowOffsets_[rowIdx] + extraOffsets[rowIdx];
+            auto destIt = tmpIndices.begin() + static_cast<std::ptrdiff_t>(tmpBegin);
+            const auto rowBegin = destIt;
+
+            destIt = std::copy(colIndices_.begin() + static_cast<std::ptrdiff_t>(rowOffsets_[rowIdx]),
+                               colIndices_.begin() + static_cast<std::ptrdiff_t>(fillPos_[rowIdx]),
+                               destIt);
+            for (std::size_t k = extraOffsets[rowIdx]; k < extraOffsets[rowIdx + 1]; ++k)
+                *destIt++ = extraEntries_[k].second;
+
+            std::sort(rowBegin, destIt);
+            rowSizes[rowIdx] = static_cast<std::size_t>(std::unique(rowBegin, destIt) - rowBegin);
+        }
+
+        // compact the rows
+        std::vector<std::size_t> newOffsets(n + 1, 0);
+        for (std::size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            newOffsets[rowIdx + 1] = newOffsets[rowIdx] + rowSizes[rowIdx];
+
+        colIndices_.resize(newOffsets.back());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < numRowsSigned; ++i) {
+            const auto rowIdx = static_cast<std::size_t>(i);
+            const auto srcIt =
+                tmpIndices.begin() + static_cast<std::ptrdiff_t>(rowOffsets_[rowIdx] + extraOffsets[rowIdx]);
+            std::copy(srcIt,
+                      srcIt + static_cast<std::ptrdiff_t>(rowSizes[rowIdx]),
+                      colIndices_.begin() + static_cast<std::ptrdiff_t>(newOffsets[rowIdx]));
+        }
+
+        rowOffsets_ = std::move(newOffsets);
+        colIndices_.shrink_to_fit();
+        fillPos_.clear();
+        fillPos_.shrink_to_fit();
+        extraEntries_.clear();
+        extraEntries_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief Returns the total number of entries.
+     *
+     * This is only the number of unique entries after finalize() has been called.
+     */
+    std::size_t numNonZeros() const
+    { return rowOffsets_.back(); }
+
+    /*!
+     * \brief Returns the number of entries of a row after finalize() was called.
+     */
+    std::size_t rowSize(std::size_t rowIdx) const
+    { return rowOffsets_[rowIdx + 1] - rowOffsets_[rowIdx]; }
+
+    /*!
+     * \brief Returns a pointer to the first column index of a row after finalize()
+     *        was called.
+     */
+    const Index* rowBegin(std::size_t rowIdx) const
+    { return colIndices_.data() + rowOffsets_[rowIdx]; }
+
+    /*!
+     * \brief Returns a pointer after the last column index of a row after finalize()
+     *        was called.
+     */
+    const Index* rowEnd(std::size_t rowIdx) const
+    { return colIndices_.data() + rowOffsets_[rowIdx + 1]; }
+
+private:
+    std::vector<std::size_t> rowOffsets_;
+    std::vector<std::size_t> fillPos_;
+    std::vector<Index> colIndices_;
+    std::vector<std::pair<Index, Index> > extraEntries_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
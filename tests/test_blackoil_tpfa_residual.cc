@@ -0,0 +1,434 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test which compares the cell-wise TPFA residual of the black-oil model with
+ *        the one computed using element contexts.
+ *
+ * The reservoir problem is simulated using the TPFA local residual of the black-oil
+ * model and the element centered finite volume discretization. At the end of each
+ * time step, the flux over each face and the source term of each cell are computed
+ * from the element context as well as from the neighbor information and the compact
+ * copy of the intensive quantities which are used by the TPFA linearizer. The test
+ * fails if the values or the derivatives of these terms differ.
+ */
+#include "config.h"
+
+#include <opm/models/io/dgfvanguard.hh>
+#include <opm/models/utils/start.hh>
+#include <opm/models/blackoil/blackoilmodel.hh>
+#include <opm/models/blackoil/blackoillocalresidualtpfa.hh>
+#include <opm/models/blackoil/blackoilintensivequantitymirror.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include "problems/reservoirproblem.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+template <class TypeTag>
+class TpfaResidualTestProblem;
+
+template <class TypeTag>
+class TpfaResidualTestExtensiveQuantities;
+}
+
+namespace Opm::Properties {
+
+// Create new type tags
+namespace TTag {
+
+struct ReservoirBlackOilTpfaResidualProblem
+{ using InheritsFrom = std::tuple<ReservoirBaseProblem, BlackOilModel>; };
+
+} // end namespace TTag
+
+// Set the problem property
+template<class TypeTag>
+struct Problem<TypeTag, TTag::ReservoirBlackOilTpfaResidualProblem>
+{ using type = Opm::TpfaResidualTestProblem<TypeTag>; };
+
+// Use the local residual which provides the cell-wise TPFA interface
+template<class TypeTag>
+struct LocalResidual<TypeTag, TTag::ReservoirBlackOilTpfaResidualProblem>
+{ using type = Opm::BlackOilLocalResidualTPFA<TypeTag>; };
+
+// The TPFA local residual needs the upwinding of the extensive quantities
+template<class TypeTag>
+struct ExtensiveQuantities<TypeTag, TTag::ReservoirBlackOilTpfaResidualProblem>
+{ using type = Opm::TpfaResidualTestExtensiveQuantities<TypeTag>; };
+
+// Select the element centered finite volume method as spatial discretization
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::ReservoirBlackOilTpfaResidualProblem>
+{ using type = TTag::EcfvDiscretization; };
+
+// Use automatic differentiation to linearize the system of PDEs
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::ReservoirBlackOilTpfaResidualProblem>
+{ using type = TTag::AutoDiffLocalLinearizer; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \brief The black-oil extensive quantities plus the pressure difference and upwinding
+ *        of a phase between two degrees of freedom which are expected by the TPFA local
+ *        residual.
+ *
+ * This uses the same rules as the variant of the local residual which reads the
+ * compact copy of the intensive quantities.
+ */
+template <class TypeTag>
+class TpfaResidualTestExtensiveQuantities : public BlackOilExtensiveQuantities<TypeTag>
+{
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using Toolbox = MathToolbox<Evaluation>;
+
+    static constexpr bool enableExtbo = getPropValue<TypeTag, Properties::EnableExtbo>();
+
+public:
+    static void calculatePhasePressureDiff_(short& upIdx,
+                                            short& dnIdx,
+                                            Evaluation& pressureDifference,
+                                            const IntensiveQuantities& intQuantsIn,
+                                            const IntensiveQuantities& intQuantsEx,
+                                            const unsigned phaseIdx,
+                                            const short interiorDofIdx,
+                                            const short exteriorDofIdx,
+                                            const Scalar Vin,
+                                            const Scalar Vex,
+                                            const unsigned globalIndexIn,
+                                            const unsigned globalIndexEx,
+                                            const Scalar distZg,
+                                            const Scalar thpres)
+    {
+        if (intQuantsIn.mobility(phaseIdx) <= 0.0 &&
+            intQuantsEx.mobility(phaseIdx) <= 0.0)
+        {
+            upIdx = interiorDofIdx;
+            dnIdx = exteriorDofIdx;
+            pressureDifference = 0.0;
+            return;
+        }
+
+        const Evaluation& rhoIn = intQuantsIn.fluidState().density(phaseIdx);
+        const Scalar rhoEx = Toolbox::value(intQuantsEx.fluidState().density(phaseIdx));
+        const Evaluation rhoAvg = (rhoIn + rhoEx)/2;
+
+        const Evaluation& pressureInterior = intQuantsIn.fluidState().pressure(phaseIdx);
+        Evaluation pressureExterior = Toolbox::value(intQuantsEx.fluidState().pressure(phaseIdx));
+        if constexpr (enableExtbo)
+            pressureExterior += Toolbox::value(rhoAvg)*distZg;
+        else
+            pressureExterior += rhoAvg*distZg;
+
+        pressureDifference = pressureExterior - pressureInterior;
+
+        bool interiorIsUpstream;
+        if (pressureDifference > 0.0)
+            interiorIsUpstream = false;
+        else if (pressureDifference < 0.0)
+            interiorIsUpstream = true;
+        else if (Vin != Vex)
+            interiorIsUpstream = Vin > Vex;
+        else
+            interiorIsUpstream = globalIndexIn < globalIndexEx;
+
+        upIdx = interiorIsUpstream ? interiorDofIdx : exteriorDofIdx;
+        dnIdx = interiorIsUpstream ? exteriorDofIdx : interiorDofIdx;
+
+        if (thpres > 0.0) {
+            if (std::abs(Toolbox::value(pressureDifference)) > thpres) {
+                if (pressureDifference < 0.0)
+                    pressureDifference += thpres;
+                else
+                    pressureDifference -= thpres;
+            }
+            else
+                pressureDifference = 0.0;
+        }
+    }
+};
+
+/*!
+ * \brief The reservoir problem plus the cell-wise quantities which are required by
+ *        the TPFA local residual and the comparison of the residuals at the end of
+ *        each time step.
+ */
+template <class TypeTag>
+class TpfaResidualTestProblem : public ReservoirProblem<TypeTag>
+{
+    using ParentType = ReservoirProblem<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using RateVector = GetPropType<TypeTag, Properties::RateVector>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
+    using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
+    using IntensiveQuantityMirror = BlackOilIntensiveQuantityMirror<TypeTag>;
+
+    enum { dimWorld = GridView::dimensionworld };
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    struct NeighborInfo
+    {
+        unsigned neighbor;
+        ResidualNBInfo res_nbinfo;
+    };
+
+public:
+    TpfaResidualTestProblem(Simulator& simulator)
+        : ParentType(simulator)
+    { }
+
+    /*!
+     * \copydoc FvBaseProblem::finishInit
+     */
+    void finishInit()
+    {
+        ParentType::finishInit();
+
+        // the transmissibility of a face is the harmonic average of the permeabilities
+        // of the adjacent cells times the area of the face over the distance of the
+        // cell centers
+        ElementContext elemCtx(this->simulator());
+        centerDepth_.resize(this->model().numGridDof());
+        for (const auto& elem : elements(this->gridView())) {
+            elemCtx.updateStencil(elem);
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+
+            const unsigned globI = elemCtx.globalSpaceIndex(/*dofIdx=*/0, /*timeIdx=*/0);
+            centerDepth_[globI] = elemCtx.pos(/*dofIdx=*/0, /*timeIdx=*/0)[dimWorld - 1];
+
+            for (unsigned scvfIdx = 0; scvfIdx < stencil.numInteriorFaces(); ++scvfIdx) {
+                const auto& scvf = stencil.interiorFace(scvfIdx);
+                const unsigned i = scvf.interiorIndex();
+                const unsigned j = scvf.exteriorIndex();
+
+                const Scalar Ki = this->intrinsicPermeability(elemCtx, i, /*timeIdx=*/0)[0][0];
+                const Scalar Kj = this->intrinsicPermeability(elemCtx, j, /*timeIdx=*/0)[0][0];
+                const Scalar dist = (elemCtx.pos(i, /*timeIdx=*/0) - elemCtx.pos(j, /*timeIdx=*/0)).two_norm();
+                const Scalar trans = 2*Ki*Kj/(Ki + Kj)*scvf.area()/dist;
+
+                trans_[faceKey_(elemCtx.globalSpaceIndex(i, /*timeIdx=*/0),
+                                elemCtx.globalSpaceIndex(j, /*timeIdx=*/0))] = trans;
+            }
+        }
+    }
+
+    /*!
+     * \copydoc FvBaseProblem::endTimeStep
+     */
+    void endTimeStep()
+    {
+        ParentType::endTimeStep();
+
+        if (!residualsAgree_())
+            throw std::logic_error("The cell-wise TPFA residual deviates from the one "
+                                   "which is computed using element contexts");
+    }
+
+    Scalar transmissibility(const ElementContext& elemCtx,
+                            unsigned interiorDofIdx,
+                            unsigned exteriorDofIdx) const
+    {
+        return transmissibility(elemCtx.globalSpaceIndex(interiorDofIdx, /*timeIdx=*/0),
+                                elemCtx.globalSpaceIndex(exteriorDofIdx, /*timeIdx=*/0));
+    }
+
+    Scalar transmissibility(unsigned globalIndexIn, unsigned globalIndexEx) const
+    { return trans_.at(faceKey_(globalIndexIn, globalIndexEx)); }
+
+    Scalar thresholdPressure(unsigned, unsigned) const
+    { return 0.0; }
+
+    // gravity acts against the direction of the last coordinate for this problem, so
+    // the coordinate itself multiplied by the gravity yields the hydrostatic pressure
+    // difference
+    Scalar dofCenterDepth(const ElementContext& elemCtx, unsigned dofIdx, unsigned timeIdx) const
+    { return dofCenterDepth(elemCtx.globalSpaceIndex(dofIdx, timeIdx)); }
+
+    Scalar dofCenterDepth(unsigned globalIdx) const
+    { return centerDepth_[globalIdx]; }
+
+    Scalar thermalHalfTransmissibility(unsigned, unsigned) const
+    { return 0.0; }
+
+    Scalar diffusivity(unsigned, unsigned) const
+    { return 0.0; }
+
+    Scalar dispersivity(unsigned, unsigned) const
+    { return 0.0; }
+
+    // the source term of all components is 0 everywhere, see ReservoirProblem
+    void source(RateVector& rate, unsigned, unsigned) const
+    { rate = Scalar(0.0); }
+
+    using ParentType::source;
+
+    void addToSourceDense(RateVector&, unsigned, unsigned) const
+    { }
+
+private:
+    bool residualsAgree_() const
+    {
+        const auto& gridView = this->gridView();
+        const auto& localResidual = this->model().localResidual(ThreadManager::threadId());
+        const Scalar g = this->gravity()[dimWorld - 1];
+
+        // the compact copy of the intensive quantities of all cells
+        IntensiveQuantityMirror mirror;
+        mirror.prepare(this->model().numGridDof());
+        ElementContext elemCtx(this->simulator());
+        for (const auto& elem : elements(gridView)) {
+            elemCtx.updatePrimaryStencil(elem);
+            elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            mirror.update(elemCtx.globalSpaceIndex(/*dofIdx=*/0, /*timeIdx=*/0),
+                          elemCtx.intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/0));
+        }
+
+        Scalar maxError = 0.0;
+        std::vector<NeighborInfo> nbInfos;
+        for (const auto& elem : elements(gridView)) {
+            if (elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            elemCtx.updateStencil(elem);
+            elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+            const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+            const unsigned globI = elemCtx.globalSpaceIndex(/*dofIdx=*/0, /*timeIdx=*/0);
+
+            nbInfos.clear();
+            for (unsigned scvfIdx = 0; scvfIdx < stencil.numInteriorFaces(); ++scvfIdx) {
+                const auto& scvf = stencil.interiorFace(scvfIdx);
+                const unsigned i = scvf.interiorIndex();
+                const unsigned j = scvf.exteriorIndex();
+                const unsigned globalIndexIn = elemCtx.globalSpaceIndex(i, /*timeIdx=*/0);
+                const unsigned globalIndexEx = elemCtx.globalSpaceIndex(j, /*timeIdx=*/0);
+
+                RateVector elemCtxFlux;
+                LocalResidual::computeFlux(elemCtxFlux, elemCtx, scvfIdx, /*timeIdx=*/0);
+
+                // the neighbor information is set up like by the TPFA linearizer
+                const int dirId = scvf.dirId();
+                const ResidualNBInfo nbInfo {
+                    transmissibility(globalIndexIn, globalIndexEx),
+                    scvf.area(),
+                    thresholdPressure(globalIndexIn, globalIndexEx),
+                    (dofCenterDepth(globalIndexIn) - dofCenterDepth(globalIndexEx))*g,
+                    dirId < 0 ? FaceDir::DirEnum::Unknown : FaceDir::FromIntersectionIndex(dirId),
+                    this->model().dofTotalVolume(globalIndexIn),
+                    this->model().dofTotalVolume(globalIndexEx),
+                    /*inAlpha=*/0.0,
+                    /*outAlpha=*/0.0,
+                    diffusivity(globalIndexIn, globalIndexEx),
+                    dispersivity(globalIndexIn, globalIndexEx),
+                    (elemCtx.pos(i, /*timeIdx=*/0) - elemCtx.pos(j, /*timeIdx=*/0)).two_norm()
+                };
+                if (i == 0)
+                    nbInfos.push_back(NeighborInfo{globalIndexEx, nbInfo});
+
+                RateVector tpfaFlux;
+                RateVector darcy;
+                LocalResidual::computeFlux(tpfaFlux, darcy, globalIndexIn, globalIndexEx,
+                                           elemCtx.intensiveQuantities(i, /*timeIdx=*/0),
+                                           elemCtx.intensiveQuantities(j, /*timeIdx=*/0),
+                                           nbInfo, &mirror);
+
+                maxError = std::max(maxError, relativeError_(elemCtxFlux, tpfaFlux));
+            }
+
+            RateVector elemCtxSource;
+            localResidual.computeSource(elemCtxSource, elemCtx, /*dofIdx=*/0, /*timeIdx=*/0);
+
+            RateVector tpfaSource;
+            LocalResidual::computeSource(tpfaSource, *this,
+                                         elemCtx.intensiveQuantities(/*dofIdx=*/0, /*timeIdx=*/0),
+                                         globI, nbInfos, /*timeIdx=*/0);
+
+            maxError = std::max(maxError, relativeError_(elemCtxSource, tpfaSource));
+        }
+
+        maxError = gridView.comm().max(maxError);
+        if (maxError > tolerance_) {
+            if (gridView.comm().rank() == 0)
+                std::cerr << "The maximum relative deviation of the cell-wise TPFA residual "
+                          << "is " << maxError << " (tolerance: " << tolerance_ << ")\n";
+            return false;
+        }
+
+        return true;
+    }
+
+    // the maximum relative deviation of the values and the derivatives of two rates
+    static Scalar relativeError_(const RateVector& a, const RateVector& b)
+    {
+        Scalar error = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            error = std::max(error, relativeError_(a[eqIdx].value(), b[eqIdx].value()));
+            for (int derivIdx = 0; derivIdx < a[eqIdx].size(); ++derivIdx)
+                error = std::max(error, relativeError_(a[eqIdx].derivative(derivIdx),
+                                                       b[eqIdx].derivative(derivIdx)));
+        }
+        return error;
+    }
+
+    static Scalar relativeError_(Scalar a, Scalar b)
+    {
+        const Scalar scale = std::max(std::abs(a), std::abs(b));
+        if (scale == 0.0)
+            return 0.0;
+        return std::abs(a - b)/std::max(scale, 1e-30);
+    }
+
+    static std::pair<unsigned, unsigned> faceKey_(unsigned globalIndexIn, unsigned globalIndexEx)
+    { return std::minmax(globalIndexIn, globalIndexEx); }
+
+    static constexpr Scalar tolerance_ = 1e-10;
+
+    std::vector<Scalar> centerDepth_;
+    std::map<std::pair<unsigned, unsigned>, Scalar> trans_;
+};
+
+} // namespace Opm
+
+int main(int argc, char **argv)
+{
+    using ProblemTypeTag = Opm::Properties::TTag::ReservoirBlackOilTpfaResidualProblem;
+    return Opm::start<ProblemTypeTag>(argc, argv);
+}
@@ -0,0 +1,190 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the orderings of the degrees of freedom.
+ *
+ * The cells of structured grids are numbered randomly. Then it is checked that the
+ * reverse Cuthill-McKee and the Hilbert curve orderings are permutations and that
+ * they bring neighboring cells closer together.
+ */
+#include "config.h"
+
+#include <opm/models/discretization/common/dofordering.hh>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using Opm::DofOrdering;
+
+// the connectivity and the cell centers of a structured grid whose cells are numbered
+// randomly
+template <std::size_t dim>
+struct Grid
+{
+    std::vector<std::size_t> rowOffsets;
+    std::vector<unsigned> neighbors;
+    std::vector<std::array<double, dim> > centers;
+};
+
+template <std::size_t dim>
+Grid<dim> makeGrid(const std::array<unsigned, dim>& cells, unsigned seed)
+{
+    unsigned numCells = 1;
+    for (unsigned n : cells)
+        numCells *= n;
+
+    std::vector<unsigned> cellIdx(numCells);
+    std::iota(cellIdx.begin(), cellIdx.end(), 0u);
+    std::shuffle(cellIdx.begin(), cellIdx.end(), std::mt19937(seed));
+
+    // the neighbors of each cell in the lexicographic numbering
+    std::vector<std::vector<unsigned> > adjacency(numCells);
+    Grid<dim> grid;
+    grid.centers.resize(numCells);
+    for (unsigned lexIdx = 0; lexIdx < numCells; ++lexIdx) {
+        std::array<unsigned, dim> ijk;
+        unsigned stride = 1;
+        for (std::size_t axisIdx = 0; axisIdx < dim; ++axisIdx) {
+            ijk[axisIdx] = (lexIdx/stride) % cells[axisIdx];
+            grid.centers[cellIdx[lexIdx]][axisIdx] = ijk[axisIdx] + 0.5;
+
+            if (ijk[axisIdx] + 1 < cells[axisIdx]) {
+                adjacency[cellIdx[lexIdx]].push_back(cellIdx[lexIdx + stride]);
+                adjacency[cellIdx[lexIdx + stride]].push_back(cellIdx[lexIdx]);
+            }
+            stride *= cells[axisIdx];
+        }
+    }
+
+    grid.rowOffsets.push_back(0);
+    for (const auto& row : adjacency) {
+        grid.neighbors.insert(grid.neighbors.end(), row.begin(), row.end());
+        grid.rowOffsets.push_back(grid.neighbors.size());
+    }
+
+    return grid;
+}
+
+bool isPermutation(const std::vector<unsigned>& ordering, std::size_t size, const std::string& name);
+bool isPermutation(const std::vector<unsigned>& ordering, std::size_t size, const std::string& name)
+{
+    std::vector<unsigned> sorted(ordering);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<unsigned> expected(size);
+    std::iota(expected.begin(), expected.end(), 0u);
+    if (sorted != expected) {
+        std::cerr << name << ": The ordering is not a permutation of 0 ... " << size << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <std::size_t dim>
+bool checkGrid(const std::array<unsigned, dim>& cells, const std::string& name)
+{
+    const auto grid = makeGrid<dim>(cells, /*seed=*/42);
+    const std::size_t numCells = grid.centers.size();
+
+    const std::size_t randomBandwidth = DofOrdering::bandwidth(grid.rowOffsets, grid.neighbors);
+    const double randomDistance = DofOrdering::averageNeighborDistance(grid.rowOffsets, grid.neighbors);
+
+    // the bandwidth of the reverse Cuthill-McKee ordering of a structured grid is
+    // bounded by the size of its largest cross section
+    const auto rcm = DofOrdering::reverseCuthillMcKee(grid.rowOffsets, grid.neighbors);
+    if (!isPermutation(rcm, numCells, name + " (RCM)"))
+        return false;
+
+    std::size_t maxCrossSection = 0;
+    for (std::size_t axisIdx = 0; axisIdx < dim; ++axisIdx)
+        maxCrossSection = std::max<std::size_t>(maxCrossSection, numCells/cells[axisIdx]);
+
+    const std::size_t rcmBandwidth = DofOrdering::bandwidth(grid.rowOffsets, grid.neighbors, rcm);
+    std::cout << name << ": bandwidth random " << randomBandwidth << ", RCM " << rcmBandwidth << std::endl;
+    if (rcmBandwidth >= randomBandwidth || rcmBandwidth > 2*maxCrossSection) {
+        std::cerr << name << ": The RCM ordering has a bandwidth of " << rcmBandwidth
+                  << " (random numbering: " << randomBandwidth << ")" << std::endl;
+        return false;
+    }
+
+    // the Hilbert curve connects the first and the last quadrant, so it does not
+    // bound the bandwidth, but most neighbors are close on the curve
+    const auto hilbert = DofOrdering::hilbertCurve<dim>(grid.centers);
+    if (!isPermutation(hilbert, numCells, name + " (Hilbert)"))
+        return false;
+
+    const double hilbertDistance =
+        DofOrdering::averageNeighborDistance(grid.rowOffsets, grid.neighbors, hilbert);
+    const std::size_t hilbertBandwidth =
+        DofOrdering::bandwidth(grid.rowOffsets, grid.neighbors, hilbert);
+    std::cout << name << ": average neighbor distance random " << randomDistance
+              << ", Hilbert " << hilbertDistance << ", bandwidth Hilbert " << hilbertBandwidth << std::endl;
+    if (hilbertDistance > 0.1*randomDistance || hilbertBandwidth > randomBandwidth) {
+        std::cerr << name << ": The Hilbert ordering has an average neighbor distance of "
+                  << hilbertDistance << " (random numbering: " << randomDistance << ")" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if (!checkGrid<2>({64, 64}, "64x64") ||
+        !checkGrid<2>({200, 7}, "200x7") ||
+        !checkGrid<3>({20, 15, 10}, "20x15x10"))
+        return EXIT_FAILURE;
+
+    // the RCM ordering of a graph with several connected components and isolated
+    // vertices: 0 - 2 - 4 and 1 - 3, 5 is isolated
+    const std::vector<std::size_t> rowOffsets = {0, 1, 2, 4, 5, 6, 6};
+    const std::vector<unsigned> neighbors = {2, 3, 0, 4, 1, 2};
+    const auto rcm = DofOrdering::reverseCuthillMcKee(rowOffsets, neighbors);
+    if (!isPermutation(rcm, 6, "components") ||
+        DofOrdering::bandwidth(rowOffsets, neighbors, rcm) != 1)
+    {
+        std::cerr << "components: The RCM ordering does not number the components contiguously" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // empty graphs and point sets as well as coincident points
+    if (!DofOrdering::reverseCuthillMcKee({0}, {}).empty() ||
+        !DofOrdering::hilbertCurve<2>({}).empty())
+    {
+        std::cerr << "The ordering of an empty set is not empty" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<std::array<double, 2> > points = {{1.0, 1.0}, {1.0, 1.0}, {1.0, 1.0}};
+    if (!isPermutation(DofOrdering::hilbertCurve<2>(points), points.size(), "coincident points"))
+        return EXIT_FAILURE;
+
+    return 0;
+}
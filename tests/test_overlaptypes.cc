@@ -0,0 +1,261 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the maps which are used to store the overlap of the parallel linear
+ *        solvers.
+ *
+ * FlatMap and IndexHashMap are compared with std::map for random insertions and
+ * lookups. Afterwards, the time required for building and querying the maps is
+ * measured for map sizes which are typical for the overlap.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/overlaptypes.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using Opm::Linear::FlatMap;
+using Opm::Linear::Index;
+using Opm::Linear::IndexHashMap;
+
+bool checkFlatMap();
+bool checkFlatMap()
+{
+    FlatMap<unsigned, int> flatMap;
+    std::map<unsigned, int> refMap;
+
+    if (!flatMap.empty() || flatMap.size() != 0 || flatMap.find(0) != flatMap.end()) {
+        std::cerr << "A default constructed FlatMap is not empty" << std::endl;
+        return false;
+    }
+
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<unsigned> keyDist(0, 200);
+    for (int i = 0; i < 1000; ++i) {
+        const unsigned key = keyDist(rng);
+        flatMap[key] += i;
+        refMap[key] += i;
+    }
+
+    if (flatMap.size() != refMap.size()) {
+        std::cerr << "The FlatMap contains " << flatMap.size() << " instead of "
+                  << refMap.size() << " entries" << std::endl;
+        return false;
+    }
+
+    // the entries must be sorted by their keys
+    auto refIt = refMap.begin();
+    for (const auto& entry : flatMap) {
+        if (entry.first != refIt->first || entry.second != refIt->second) {
+            std::cerr << "The FlatMap contains the entry (" << entry.first << ", " << entry.second
+                      << ") instead of (" << refIt->first << ", " << refIt->second << ")" << std::endl;
+            return false;
+        }
+        ++refIt;
+    }
+
+    for (unsigned key = 0; key <= 201; ++key) {
+        const bool contained = refMap.count(key) > 0;
+        if (flatMap.count(key) != refMap.count(key) || (flatMap.find(key) != flatMap.end()) != contained) {
+            std::cerr << "The FlatMap is wrong about whether key " << key << " is contained" << std::endl;
+            return false;
+        }
+        if (contained && flatMap.at(key) != refMap.at(key)) {
+            std::cerr << "The FlatMap maps key " << key << " to " << flatMap.at(key)
+                      << " instead of " << refMap.at(key) << std::endl;
+            return false;
+        }
+    }
+
+    bool thrown = false;
+    try {
+        const auto& constMap = flatMap;
+        constMap.at(201);
+    }
+    catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    if (!thrown) {
+        std::cerr << "FlatMap::at() does not throw for a missing key" << std::endl;
+        return false;
+    }
+
+    flatMap.clear();
+    if (!flatMap.empty()) {
+        std::cerr << "The FlatMap is not empty after clear()" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool checkIndexHashMap();
+bool checkIndexHashMap()
+{
+    IndexHashMap hashMap;
+    std::map<Index, Index> refMap;
+
+    // lookups in a map without any slots
+    if (hashMap.size() != 0 || hashMap.get(0) != -1 || hashMap.contains(0)) {
+        std::cerr << "A default constructed IndexHashMap is not empty" << std::endl;
+        return false;
+    }
+
+    // the table is rehashed several times while the entries are inserted. the keys
+    // are multiples of a power of two which collide if the hash function is poor
+    std::mt19937 rng(54321);
+    std::uniform_int_distribution<Index> keyDist(0, 5000);
+    for (int i = 0; i < 20000; ++i) {
+        const Index key = (i % 2 == 0) ? keyDist(rng) : (i % 4096)*1024;
+        hashMap.set(key, i);
+        refMap[key] = i;
+    }
+
+    if (hashMap.size() != refMap.size()) {
+        std::cerr << "The IndexHashMap contains " << hashMap.size() << " instead of "
+                  << refMap.size() << " entries" << std::endl;
+        return false;
+    }
+
+    // all contained keys and the keys in between them
+    for (Index key = 0; key <= 4096*1024; key += (key < 6000 ? 1 : 512)) {
+        const auto refIt = refMap.find(key);
+        const Index expected = (refIt == refMap.end()) ? -1 : refIt->second;
+        if (hashMap.get(key) != expected || hashMap.contains(key) != (refIt != refMap.end())) {
+            std::cerr << "The IndexHashMap maps key " << key << " to " << hashMap.get(key)
+                      << " instead of " << expected << std::endl;
+            return false;
+        }
+    }
+
+    // reserving space must not lose any entries
+    hashMap.reserve(10*refMap.size());
+    for (const auto& [key, value] : refMap) {
+        if (hashMap.get(key) != value) {
+            std::cerr << "The IndexHashMap lost key " << key << " after reserve()" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the time in seconds which is needed to call a function a number of times
+template <class Fn>
+double measureTime(int numRepetitions, Fn fn)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < numRepetitions; ++i)
+        fn();
+    const auto endTime = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+// compare the maps with std::map for the access patterns of the overlap: few peer
+// ranks per index and many indices for the translation between index spaces
+void benchmark();
+void benchmark()
+{
+    std::mt19937 rng(1);
+    long checksum = 0;
+
+    {
+        const int numPeerMaps = 100000;
+        std::uniform_int_distribution<unsigned> rankDist(0, 63);
+        std::vector<unsigned> ranks(4*numPeerMaps);
+        for (auto& rank : ranks)
+            rank = rankDist(rng);
+
+        const double flatTime = measureTime(numPeerMaps, [&, i = 0]() mutable {
+            FlatMap<unsigned, unsigned> peers;
+            for (int j = 0; j < 4; ++j)
+                peers[ranks[4*i + j]] = j;
+            checksum += peers.size() + peers.count(ranks[4*i]);
+            ++i;
+        });
+        const double stdTime = measureTime(numPeerMaps, [&, i = 0]() mutable {
+            std::map<unsigned, unsigned> peers;
+            for (int j = 0; j < 4; ++j)
+                peers[ranks[4*i + j]] = j;
+            checksum += peers.size() + peers.count(ranks[4*i]);
+            ++i;
+        });
+        std::cout << numPeerMaps << " peer sets of 4 ranks: FlatMap " << flatTime
+                  << " s, std::map " << stdTime << " s" << std::endl;
+    }
+
+    {
+        const int numIndices = 1000000;
+        std::vector<Index> keys(numIndices);
+        for (int i = 0; i < numIndices; ++i)
+            keys[i] = 3*i;
+        std::shuffle(keys.begin(), keys.end(), rng);
+
+        IndexHashMap hashMap;
+        std::map<Index, Index> stdMap;
+        const double hashInsertTime = measureTime(1, [&]() {
+            for (int i = 0; i < numIndices; ++i)
+                hashMap.set(keys[i], i);
+        });
+        const double stdInsertTime = measureTime(1, [&]() {
+            for (int i = 0; i < numIndices; ++i)
+                stdMap[keys[i]] = i;
+        });
+
+        std::shuffle(keys.begin(), keys.end(), rng);
+        const double hashLookupTime = measureTime(1, [&]() {
+            for (int i = 0; i < numIndices; ++i)
+                checksum += hashMap.get(keys[i]);
+        });
+        const double stdLookupTime = measureTime(1, [&]() {
+            for (int i = 0; i < numIndices; ++i)
+                checksum += stdMap.find(keys[i])->second;
+        });
+        std::cout << numIndices << " index translations: IndexHashMap " << hashInsertTime
+                  << " s (insert), " << hashLookupTime << " s (lookup), std::map "
+                  << stdInsertTime << " s (insert), " << stdLookupTime << " s (lookup)"
+                  << std::endl;
+    }
+
+    // make sure that the results are used
+    std::cout << "checksum: " << checksum << std::endl;
+}
+
+int main()
+{
+    if (!checkFlatMap() || !checkIndexHashMap())
+        return EXIT_FAILURE;
+
+    benchmark();
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the construction of sparsity patterns.
+ *
+ * The pattern of a matrix is built with duplicate entries, by multiple threads and
+ * with entries which were not counted in advance. The result is compared with the
+ * pattern which is obtained using std::set.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using Opm::Linear::SparsityPattern;
+using Reference = std::vector<std::set<SparsityPattern::Index> >;
+
+bool comparePattern(const SparsityPattern& pattern, const Reference& reference, const std::string& name);
+bool comparePattern(const SparsityPattern& pattern, const Reference& reference, const std::string& name)
+{
+    if (pattern.numRows() != reference.size()) {
+        std::cerr << name << ": The pattern has " << pattern.numRows() << " instead of "
+                  << reference.size() << " rows" << std::endl;
+        return false;
+    }
+
+    std::size_t numNonZeros = 0;
+    for (std::size_t rowIdx = 0; rowIdx < reference.size(); ++rowIdx) {
+        const auto& refRow = reference[rowIdx];
+        numNonZeros += refRow.size();
+
+        // the rows must be sorted and must not contain duplicates
+        const std::vector<SparsityPattern::Index> row(pattern.rowBegin(rowIdx), pattern.rowEnd(rowIdx));
+        const std::vector<SparsityPattern::Index> refRowVec(refRow.begin(), refRow.end());
+        if (pattern.rowSize(rowIdx) != refRow.size() || row != refRowVec) {
+            std::cerr << name << ": Row " << rowIdx << " has " << row.size() << " instead of "
+                      << refRow.size() << " entries or its entries differ" << std::endl;
+            return false;
+        }
+    }
+
+    if (pattern.numNonZeros() != numNonZeros) {
+        std::cerr << name << ": The pattern has " << pattern.numNonZeros() << " instead of "
+                  << numNonZeros << " entries" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// the columns of the entries of a row of a banded matrix. each of them is added twice
+std::vector<SparsityPattern::Index> bandColumns(long rowIdx, long numRows);
+std::vector<SparsityPattern::Index> bandColumns(long rowIdx, long numRows)
+{
+    std::vector<SparsityPattern::Index> columns;
+    for (long colIdx = rowIdx - 3; colIdx <= rowIdx + 3; ++colIdx) {
+        if (colIdx < 0 || colIdx >= numRows)
+            continue;
+        columns.push_back(static_cast<SparsityPattern::Index>(colIdx));
+        columns.push_back(static_cast<SparsityPattern::Index>((colIdx*7) % numRows));
+    }
+    return columns;
+}
+
+// counts and adds the entries concurrently. if extraEntries is true, some entries
+// are added by appendEntry(), both ones which are also added by addEntry() and new
+// ones
+bool checkPattern(long numRows, bool extraEntries, bool overCount, const std::string& name);
+bool checkPattern(long numRows, bool extraEntries, bool overCount, const std::string& name)
+{
+    SparsityPattern pattern(static_cast<std::size_t>(numRows));
+    Reference reference(static_cast<std::size_t>(numRows));
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (long rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        // the entries are counted one by one to exercise the concurrent counting of
+        // other rows. rows may also be counted by more threads than their own
+        const auto numColumns = bandColumns(rowIdx, numRows).size();
+        for (std::size_t k = 0; k < numColumns; ++k)
+            pattern.countEntries(static_cast<std::size_t>(rowIdx));
+        if (overCount)
+            pattern.countEntries(static_cast<std::size_t>((rowIdx*13) % numRows), 2);
+    }
+
+    pattern.allocate();
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (long rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        for (auto colIdx : bandColumns(rowIdx, numRows))
+            pattern.addEntry(static_cast<std::size_t>(rowIdx), colIdx);
+
+    for (long rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        for (auto colIdx : bandColumns(rowIdx, numRows))
+            reference[static_cast<std::size_t>(rowIdx)].insert(colIdx);
+
+    if (extraEntries) {
+        for (long rowIdx = numRows - 1; rowIdx >= 0; rowIdx -= 5) {
+            const auto row = static_cast<std::size_t>(rowIdx);
+            const auto newColIdx = static_cast<SparsityPattern::Index>(numRows - 1 - rowIdx);
+            const auto oldColIdx = static_cast<SparsityPattern::Index>(rowIdx);
+
+            pattern.appendEntry(row, newColIdx);
+            pattern.appendEntry(row, newColIdx);
+            pattern.appendEntry(row, oldColIdx);
+            reference[row].insert(newColIdx);
+            reference[row].insert(oldColIdx);
+        }
+    }
+
+    pattern.finalize();
+
+    return comparePattern(pattern, reference, name);
+}
+
+int main()
+{
+    // an empty pattern
+    SparsityPattern emptyPattern;
+    emptyPattern.allocate();
+    emptyPattern.finalize();
+    if (!comparePattern(emptyPattern, Reference(), "empty"))
+        return EXIT_FAILURE;
+
+    // rows without any entries
+    SparsityPattern sparsePattern(10);
+    sparsePattern.countEntries(3, 2);
+    sparsePattern.allocate();
+    sparsePattern.addEntry(3, 5);
+    sparsePattern.addEntry(3, 5);
+    sparsePattern.appendEntry(7, 1);
+    sparsePattern.finalize();
+    Reference sparseReference(10);
+    sparseReference[3].insert(5);
+    sparseReference[7].insert(1);
+    if (!comparePattern(sparsePattern, sparseReference, "sparse"))
+        return EXIT_FAILURE;
+
+    if (!checkPattern(10000, /*extraEntries=*/false, /*overCount=*/false, "banded") ||
+        !checkPattern(10000, /*extraEntries=*/true, /*overCount=*/false, "banded with appended entries") ||
+        !checkPattern(10000, /*extraEntries=*/true, /*overCount=*/true, "banded with unused entries"))
+        return EXIT_FAILURE;
+
+    // a pattern can be reused after a reset
+    SparsityPattern pattern(4);
+    pattern.countEntries(0);
+    pattern.allocate();
+    pattern.addEntry(0, 3);
+    pattern.finalize();
+    pattern.reset(2);
+    pattern.countEntries(1);
+    pattern.allocate();
+    pattern.addEntry(1, 0);
+    pattern.finalize();
+    Reference resetReference(2);
+    resetReference[1].insert(0);
+    if (!comparePattern(pattern, resetReference, "reset"))
+        return EXIT_FAILURE;
+
+    return 0;
+}
@@ -25,13 +25,21 @@
  *
  * \brief This file serves as an example of how to use the tasklet mechanism for
  *        asynchronous work.
+ *
+ * It also measures the throughput of the tasklet runner for small tasklets.
  */
 #include "config.h"
 
 #include <opm/models/parallel/tasklets.hh>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <chrono>
+#include <cstdlib>
+#include <future>
 #include <iostream>
+#include <vector>
 
 std::mutex outputMutex;
 
@@ -73,6 +81,51 @@ void sleepAndPrintFunction()
 
 int SleepTasklet::numInstantiated_ = 0;
 
+std::atomic<long> counter{0};
+
+class IncrementTasklet : public Opm::TaskletInterface
+{
+public:
+    void run() override
+    { counter.fetch_add(1, std::memory_order_relaxed); }
+};
+
+// dispatches a number of tiny tasklets and returns the number of tasklets which are
+// processed per second
+double measureThroughput(unsigned numWorkers, int numTasklets, bool batched);
+double measureThroughput(unsigned numWorkers, int numTasklets, bool batched)
+{
+    Opm::TaskletRunner throughputRunner(numWorkers);
+    counter = 0;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    if (batched) {
+        const int batchSize = 1000;
+        std::vector<std::shared_ptr<Opm::TaskletInterface> > batch;
+        for (int i = 0; i < numTasklets; i += batchSize) {
+            batch.clear();
+            for (int j = i; j < std::min(numTasklets, i + batchSize); ++j)
+                batch.push_back(std::make_shared<IncrementTasklet>());
+            throughputRunner.dispatch(batch);
+        }
+    }
+    else {
+        for (int i = 0; i < numTasklets; ++i)
+            throughputRunner.dispatch(std::make_shared<IncrementTasklet>());
+    }
+    throughputRunner.barrier();
+    const auto endTime = std::chrono::steady_clock::now();
+
+    if (counter != numTasklets || throughputRunner.failure()) {
+        std::cerr << "Only " << counter << " of " << numTasklets << " tasklets were run by "
+                  << numWorkers << " worker thread(s)" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+    return numTasklets/std::max(seconds, 1e-9);
+}
+
 int main()
 {
     int numWorkers = 2;
@@ -94,6 +147,45 @@ int main()
 
     runner->dispatchFunction(sleepAndPrintFunction);
     runner->dispatchFunction(sleepAndPrintFunction, /*numInvokations=*/6);
+    runner->barrier();
+
+    // results can be retrieved using futures
+    std::vector<std::future<int> > futures;
+    for (int i = 0; i < 100; ++i)
+        futures.push_back(runner->dispatchTask([i]() { return i*i; }));
+    int sum = 0;
+    for (auto& future : futures)
+        sum += future.get();
+    if (sum != 328350) {
+        std::cerr << "The results of the tasks add up to " << sum << " instead of 328350" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // tasklets may dispatch further tasklets from the worker threads
+    counter = 0;
+    auto nested = runner->dispatchTask([]() {
+        for (int i = 0; i < 1000; ++i)
+            runner->dispatch(std::make_shared<IncrementTasklet>());
+    });
+    nested.get();
+    runner->barrier();
+    if (counter != 1000 || runner->failure()) {
+        std::cerr << "Only " << counter << " of 1000 nested tasklets were run" << std::endl;
+        return EXIT_FAILURE;
+    }
+    runner.reset();
+
+    // measure the throughput for tiny tasklets
+    const int numTasklets = 100000;
+    const unsigned maxWorkers = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+    for (unsigned numThroughputWorkers : {0u, 1u, maxWorkers}) {
+        for (bool batched : {false, true}) {
+            const double rate = measureThroughput(numThroughputWorkers, numTasklets, batched);
+            std::cout << numThroughputWorkers << " worker thread(s), "
+                      << (batched ? "batched" : "individual") << " dispatch: "
+                      << rate << " tasklets per second" << std::endl;
+        }
+    }
 
     return 0;
 }